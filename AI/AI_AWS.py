@@ -11,7 +11,8 @@ import gymnasium
 import numpy as np
 from gymnasium import spaces
 
-BUFFER_SIZE = 2048
+from protocol import open_link
+
 TARGET_DISTANCE = 7.5
 
 
@@ -43,7 +44,9 @@ class EnemyEnv(gymnasium.Env):
 
         self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
         config = configparser.ConfigParser()
-        config.add_section("Socket")
+        config.read(config_file)
+        if not config.has_section("Socket"):
+            config.add_section("Socket")
         config.set("Socket", "port", str(random.randint(16000, 63000)))
         config.write(open(config_file, "w"), False)
 
@@ -64,21 +67,20 @@ class EnemyEnv(gymnasium.Env):
             print(f"Connection from {addr}")
 
         self.conn.setblocking(True)
+        self.link = open_link(self.conn, config)
 
     def set_mode(self, mode):
         self.mode = mode
 
     def send(self, msg):
-        self.conn.send(msg.encode().ljust(BUFFER_SIZE, b"\0"))
+        self.link.send(msg)
 
     def recv(self):
-        msg = self.conn.recv(
-            BUFFER_SIZE, socket.MSG_WAITALL).strip(b"\0").decode()
-        return msg
+        return self.link.recv()
 
     def reset(self, *_, **__):
         self.send("reset")
-        state = self.recv().split(",")
+        state = self.recv()
         self.update_states(state)
         return self._get_obs(), {}
 
@@ -119,7 +121,7 @@ class EnemyEnv(gymnasium.Env):
         reward = 0.0
 
         self.send(f"action,{action}")
-        state = self.recv().split(",")
+        state = self.recv()
         self.update_states(state)
 
         print(
@@ -139,7 +141,7 @@ class EnemyEnv(gymnasium.Env):
         return self._get_obs(), reward, done, {}, {}
 
     def close(self):
-        self.conn.close()
+        self.link.close()
 
 
 def send_to_sagemaker(
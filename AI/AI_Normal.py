@@ -7,7 +7,7 @@ import time
 
 from enum import Enum
 
-BUFFER_SIZE = 2048
+from protocol import open_link
 
 
 def calculate_angle(pos1, pos2):
@@ -47,7 +47,9 @@ class EnemyEnv:
 
         self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
         config = configparser.ConfigParser()
-        config.add_section("Socket")
+        config.read(config_file)
+        if not config.has_section("Socket"):
+            config.add_section("Socket")
         config.set("Socket", "port", str(random.randint(16000, 63000)))
         config.write(open(config_file, "w"), False)
 
@@ -68,17 +70,17 @@ class EnemyEnv:
             print(f"Connection from {addr}")
 
         self.conn.setblocking(True)
+        self.link = open_link(self.conn, config)
 
     def send(self, msg):
-        self.conn.send(msg.encode().ljust(BUFFER_SIZE, b"\0"))
+        self.link.send(msg)
 
     def recv(self):
-        msg = self.conn.recv(BUFFER_SIZE, socket.MSG_WAITALL).strip(b"\0").decode()
-        return msg
+        return self.link.recv()
 
     def reset(self, *_, **__):
         self.send("reset")
-        state = self.recv().split(",")
+        state = self.recv()
 
         self.update_states(state)
 
@@ -171,7 +173,7 @@ class EnemyEnv:
         print(self.distance_to_player, actions)
         for action in actions:
             self.send(f"action,{action.value}")
-        state = self.recv().split(",")
+        state = self.recv()
 
         self.update_states(state)
 
@@ -180,7 +182,7 @@ class EnemyEnv:
         return self._get_obs(), 0.0, done, {}
 
     def close(self):
-        self.conn.close()
+        self.link.close()
 
 
 if __name__ == "__main__":
@@ -10,20 +10,26 @@ from enum import Enum
 from gymnasium import spaces
 from stable_baselines3 import PPO
 
-BUFFER_SIZE = 2048
+from protocol import OBSERVATION_SIZE, REWARD_MODES, open_link
+
 TARGET_DISTANCE = 7.5
 
 
 def calculate_angle(pos1, pos2):
+    """Bearing from pos1 to pos2, from +x"""
     return np.arctan2(pos2[1] - pos1[1], pos2[0] - pos1[0])
 
 
 def quaternion_to_yaw(quaternion):
+    """Heading of the entity's forward, local -y, from +x
+
+    Entities move, aim and shoot along -y rotated by their orientation, the
+    same facing the engine's ObservationBuilder measures yaw error from.
+    """
     w, x, y, z = quaternion
-    siny_cosp = 2 * (w * z + x * y)
-    cosy_cosp = 1 - 2 * (y * y + z * z)
-    yaw = np.arctan2(siny_cosp, cosy_cosp)
-    return yaw
+    forward_x = -2 * (x * y - w * z)
+    forward_y = -(1 - 2 * (x * x + z * z))
+    return np.arctan2(forward_y, forward_x)
 
 
 class Action(Enum):
@@ -44,9 +50,6 @@ class EnemyEnv(gymnasium.Env):
 
         self.steps = 0
         self.action_space = spaces.Discrete(5)
-        self.observation_space = spaces.Box(
-            low=-np.inf, high=np.inf, shape=(9,), dtype=np.float32
-        )
 
         self.enemy_pos = np.array([0.0, 0.0, 0.0])
         self.player_pos = np.array([0.0, 0.0, 0.0])
@@ -59,10 +62,36 @@ class EnemyEnv(gymnasium.Env):
 
         self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
         config = configparser.ConfigParser()
-        config.add_section("Socket")
+        config.read(config_file)
+        if not config.has_section("Socket"):
+            config.add_section("Socket")
         config.set("Socket", "port", str(random.randint(16000, 63000)))
         config.write(open(config_file, "w"), False)
 
+        # With [Agent] features=1 the engine computes observation and reward
+        self.features = config.getboolean("Agent", "features", fallback=False)
+        rays = config.getint("Sensor", "rays", fallback=0)
+        self.observation_space = spaces.Box(
+            low=-np.inf,
+            high=np.inf,
+            shape=(OBSERVATION_SIZE + 2 * rays if self.features else 9,),
+            dtype=np.float32,
+        )
+        # With [Vision] enabled=1 every step also carries the enemy's view
+        self.vision = config.getboolean("Vision", "enabled", fallback=False)
+        if self.vision:
+            shape = (
+                config.getint("Vision", "height", fallback=84),
+                config.getint("Vision", "width", fallback=84),
+                config.getint("Vision", "channels", fallback=3),
+            )
+            self.observation_space = spaces.Dict(
+                {
+                    "features": self.observation_space,
+                    "pixels": spaces.Box(0, 255, shape, dtype=np.uint8),
+                }
+            )
+
         self.port = int(config["Socket"]["port"])
         self.sock.bind(("localhost", self.port))
         self.sock.listen(1)
@@ -71,7 +100,9 @@ class EnemyEnv(gymnasium.Env):
         pid = os.fork()
         if pid == 0:
             time.sleep(4)
-            os.execv("./build/GameEngine", (r"./build/GameEngine",))
+            os.execv(
+                "./build/GameEngine", (r"./build/GameEngine", "--headless")
+            )
 
         self.conn = None
 
@@ -80,20 +111,35 @@ class EnemyEnv(gymnasium.Env):
             print(f"Connection from {addr}")
 
         self.conn.setblocking(True)
+        self.link = open_link(self.conn, config)
 
     def set_mode(self, mode):
         self.mode = mode
 
     def send(self, msg):
-        self.conn.send(msg.encode().ljust(BUFFER_SIZE, b"\0"))
+        self.link.send(msg)
 
     def recv(self):
-        msg = self.conn.recv(BUFFER_SIZE, socket.MSG_WAITALL).strip(b"\0").decode()
-        return msg
+        return self.link.recv()
+
+    def observe(self, step):
+        observation = np.array(step.observation, dtype=np.float32)
+        if not self.vision:
+            return observation
+        frame = self.recv()
+        pixels = np.frombuffer(frame.pixels, dtype=np.uint8).reshape(
+            frame.height, frame.width, frame.channels
+        )
+        return {"features": observation, "pixels": pixels}
 
     def reset(self, *_, **__):
+        if self.features:
+            self.send(f"reset,{REWARD_MODES[self.mode]}")
+            step = self.recv()
+            return self.observe(step), {}
+
         self.send("reset")
-        state = self.recv().split(",")
+        state = self.recv()
         self.update_states(state)
         return self._get_obs(), {}
 
@@ -118,7 +164,7 @@ class EnemyEnv(gymnasium.Env):
             )
 
             enemy_yaw = quaternion_to_yaw(self.enemy_rot_quaternion)
-            player_angle = calculate_angle(self.player_pos, self.enemy_pos)
+            player_angle = calculate_angle(self.enemy_pos, self.player_pos)
             self.angle_diff = abs(player_angle - enemy_yaw)
             self.angle_diff = min(self.angle_diff, 2 * np.pi - self.angle_diff)
         except (ValueError, IndexError) as e:
@@ -144,7 +190,17 @@ class EnemyEnv(gymnasium.Env):
         reward = 0.0
 
         self.send(f"action,{action}")
-        state = self.recv().split(",")
+        if self.features:
+            step = self.recv()
+            return (
+                self.observe(step),
+                step.reward,
+                step.terminated,
+                step.truncated,
+                {},
+            )
+
+        state = self.recv()
         self.update_states(state)
 
         if self.enemy_hp <= 0 or self.player_hp <= 0:
@@ -182,13 +238,14 @@ class EnemyEnv(gymnasium.Env):
         return self._get_obs(), reward, done, {}, {}
 
     def close(self):
-        self.conn.close()
+        self.link.close()
 
 
 def train_behavior(env, mode, timesteps, model=None):
     env.set_mode(mode)
     if model is None:
-        model = PPO("MlpPolicy", env, verbose=1, learning_rate=0.001)
+        policy = "MultiInputPolicy" if env.vision else "MlpPolicy"
+        model = PPO(policy, env, verbose=1, learning_rate=0.001)
     model.learn(total_timesteps=timesteps)
     model.save(f"enemy_rl_{mode}_model_{time.time()}")
     print(f"\nTraining for {mode} behavior complete\n")
@@ -203,7 +260,16 @@ if __name__ == "__main__":
     except:
         pass
     os.system("clear")
-    env = EnemyEnv("config.conf")
+    config = configparser.ConfigParser()
+    config.read("config.conf")
+    # With [Agent] in_process=1 the worlds run in this process through
+    # libGameEngineEnv.so instead of a forked engine on a socket
+    if config.getboolean("Agent", "in_process", fallback=False):
+        from engine_env import EngineEnv
+
+        env = EngineEnv("config.conf")
+    else:
+        env = EnemyEnv("config.conf")
     env.action_space = spaces.Discrete(8)
 
     # face_model = train_behavior(env, "face", 25000)
@@ -0,0 +1,144 @@
+"""In-process environment over build/libGameEngineEnv.so
+
+The engine's headless worlds are stepped through the C interface in
+include/env/GameEngineEnv.h instead of a forked GameEngine on a socket. The
+observations are written straight into a numpy buffer, no copies and no
+messages. Run from the repository root, the engine loads ./assets.
+"""
+
+import ctypes
+
+import gymnasium
+import numpy as np
+
+from gymnasium import spaces
+
+from protocol import REWARD_MODES
+
+LIBRARY = "./build/libGameEngineEnv.so"
+
+# As an action, resets the world of that agent instead
+RESET = -1
+
+_float_p = ctypes.POINTER(ctypes.c_float)
+_int32_p = ctypes.POINTER(ctypes.c_int32)
+
+
+def load_library(path=LIBRARY):
+    lib = ctypes.CDLL(path)
+    lib.env_create.argtypes = [
+        ctypes.c_char_p, ctypes.c_int32, ctypes.POINTER(ctypes.c_char_p),
+    ]
+    lib.env_create.restype = ctypes.c_void_p
+    lib.env_destroy.argtypes = [ctypes.c_void_p]
+    lib.env_destroy.restype = None
+    lib.env_agent_count.argtypes = [ctypes.c_void_p]
+    lib.env_agent_count.restype = ctypes.c_int32
+    lib.env_step_size.argtypes = [ctypes.c_void_p]
+    lib.env_step_size.restype = ctypes.c_int32
+    lib.env_reset.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+    lib.env_reset.restype = ctypes.c_int32
+    lib.env_step.argtypes = [ctypes.c_void_p, _int32_p, ctypes.c_int32]
+    lib.env_step.restype = ctypes.c_int32
+    lib.env_observe.argtypes = [ctypes.c_void_p, _float_p]
+    lib.env_observe.restype = ctypes.c_int32
+    lib.env_last_error.argtypes = []
+    lib.env_last_error.restype = ctypes.c_char_p
+    return lib
+
+
+class EngineWorlds:
+    """Every agent of one engine, stepped in lockstep
+
+    There are [Engine] worlds times [Agent] enemies agents, numbered world by
+    world. rewards, terminated, truncated and observations are views of the
+    buffer the engine writes into, valid until the next reset or step.
+    """
+
+    def __init__(self, config_file="config.conf", overrides=(), library=LIBRARY):
+        self.lib = load_library(library)
+        argv = [b"GameEngineEnv"] + [arg.encode() for arg in overrides]
+        self.env = self.lib.env_create(
+            config_file.encode(), len(argv), (ctypes.c_char_p * len(argv))(*argv)
+        )
+        if not self.env:
+            raise RuntimeError(self.lib.env_last_error().decode())
+
+        self.agents = self.lib.env_agent_count(self.env)
+        size = self.lib.env_step_size(self.env)
+        self.buffer = np.zeros((self.agents, size), dtype=np.float32)
+        self.actions = np.zeros(self.agents, dtype=np.int32)
+        self.rewards = self.buffer[:, 0]
+        self.terminated = self.buffer[:, 1]
+        self.truncated = self.buffer[:, 2]
+        self.observations = self.buffer[:, 3:]
+
+    def check(self, status):
+        if status != 0:
+            raise RuntimeError(self.lib.env_last_error().decode())
+
+    def observe(self):
+        self.check(
+            self.lib.env_observe(self.env, self.buffer.ctypes.data_as(_float_p))
+        )
+
+    def reset(self, mode=None):
+        """Resets every world, optionally switching the reward mode"""
+        self.check(self.lib.env_reset(self.env, REWARD_MODES.get(mode, -1)))
+        self.observe()
+        return self.observations
+
+    def step(self, actions):
+        """One action per agent, RESET restarts that agent's world"""
+        self.actions[:] = actions
+        self.check(
+            self.lib.env_step(
+                self.env, self.actions.ctypes.data_as(_int32_p), self.agents
+            )
+        )
+        self.observe()
+        return self.observations, self.rewards, self.terminated, self.truncated
+
+    def close(self):
+        if self.env:
+            self.lib.env_destroy(self.env)
+            self.env = None
+
+
+class EngineEnv(gymnasium.Env):
+    """Drop-in for AI_RL.EnemyEnv with [Agent] features=1, in process"""
+
+    def __init__(self, config_file="config.conf", mode="range", overrides=()):
+        super().__init__()
+        self.mode = mode
+        self.vision = False
+        self.worlds = EngineWorlds(
+            config_file, ["--Engine.worlds=1", "--Agent.enemies=1", *overrides]
+        )
+        self.action_space = spaces.Discrete(8)
+        self.observation_space = spaces.Box(
+            low=-np.inf,
+            high=np.inf,
+            shape=self.worlds.observations.shape[1:],
+            dtype=np.float32,
+        )
+
+    def set_mode(self, mode):
+        self.mode = mode
+
+    def reset(self, *_, **__):
+        observations = self.worlds.reset(self.mode)
+        return observations[0].copy(), {}
+
+    def step(self, action):
+        observations, rewards, terminated, truncated = self.worlds.step([action])
+        return (
+            observations[0].copy(),
+            float(rewards[0]),
+            bool(terminated[0]),
+            bool(truncated[0]),
+            {},
+        )
+
+    def close(self):
+        self.worlds.close()
@@ -0,0 +1,134 @@
+"""Exports the actor of a saved SB3 PPO model for the engine's MLP runtime
+
+    python3 AI/export_policy.py enemy_rl_final_model assets/policies/enemy_rl_final.mlp
+
+Only the policy network and action head are kept, the value head is not
+needed to act. Reads the checkpoint with the standard library alone, so
+neither torch nor stable-baselines3 have to be installed.
+
+File layout, all little-endian, see include/ai/MLP.h:
+
+    uint32 magic "GEML", uint32 version, uint32 layer count
+    per layer: uint32 inputs, uint32 outputs, uint32 activation,
+               float32 weights[outputs][inputs], float32 bias[outputs]
+"""
+
+import array
+import io
+import json
+import pickle
+import re
+import struct
+import sys
+import zipfile
+
+MAGIC = b"GEML"
+VERSION = 1
+
+NONE = 0
+TANH = 1
+RELU = 2
+
+ACTIVATIONS = {"Tanh": TANH, "ReLU": RELU}
+
+
+class Tensor:
+    def __init__(self, storage, offset, size):
+        self.storage = storage
+        self.offset = offset
+        self.size = size
+
+
+def rebuild_tensor(storage, offset, size, stride, *_):
+    return Tensor(storage, offset, size)
+
+
+class StateDict(dict):
+    """Stands in for OrderedDict, which carries a _metadata attribute"""
+
+
+class CheckpointUnpickler(pickle.Unpickler):
+    """Resolves tensors to their storage key without importing torch"""
+
+    def find_class(self, module, name):
+        if name in ("_rebuild_tensor_v2", "_rebuild_tensor"):
+            return rebuild_tensor
+        if module == "collections" and name == "OrderedDict":
+            return StateDict
+        return lambda *args: args
+
+    def persistent_load(self, pid):
+        # ("storage", storage type, key, location, numel)
+        return pid[2]
+
+
+def load_state_dict(model):
+    with zipfile.ZipFile(model) as outer:
+        policy = zipfile.ZipFile(io.BytesIO(outer.read("policy.pth")))
+        data = json.loads(outer.read("data"))
+
+    pickled = next(n for n in policy.namelist() if n.endswith("data.pkl"))
+    root = pickled[: -len("data.pkl")]
+    state = CheckpointUnpickler(io.BytesIO(policy.read(pickled))).load()
+
+    tensors = {}
+    for name, tensor in state.items():
+        values = array.array("f")
+        values.frombytes(policy.read(f"{root}data/{tensor.storage}"))
+        if sys.byteorder != "little":
+            values.byteswap()
+        count = 1
+        for dim in tensor.size:
+            count *= dim
+        tensors[name] = (
+            tensor.size,
+            values[tensor.offset : tensor.offset + count],
+        )
+    return tensors, data
+
+
+def activation_of(data):
+    """SB3 defaults to Tanh, policy_kwargs may name another one"""
+    kwargs = json.dumps(data.get("policy_kwargs", {}))
+    for name, activation in ACTIVATIONS.items():
+        if re.search(rf"\b{name}\b", kwargs):
+            return activation
+    return TANH
+
+
+def export(model, output):
+    tensors, data = load_state_dict(model)
+    activation = activation_of(data)
+
+    hidden = sorted(
+        int(name.split(".")[2])
+        for name in tensors
+        if name.startswith("mlp_extractor.policy_net.")
+        and name.endswith(".weight")
+    )
+    layers = [
+        (f"mlp_extractor.policy_net.{index}", activation) for index in hidden
+    ]
+    layers.append(("action_net", NONE))
+
+    with open(output, "wb") as file:
+        file.write(struct.pack("<4sII", MAGIC, VERSION, len(layers)))
+        for name, layer_activation in layers:
+            (outputs, inputs), weights = tensors[f"{name}.weight"]
+            _, bias = tensors[f"{name}.bias"]
+            file.write(struct.pack("<III", inputs, outputs, layer_activation))
+            file.write(struct.pack(f"<{len(weights)}f", *weights))
+            file.write(struct.pack(f"<{len(bias)}f", *bias))
+
+    shape = " -> ".join(
+        [str(tensors[f"{layers[0][0]}.weight"][0][1])]
+        + [str(tensors[f"{name}.weight"][0][0]) for name, _ in layers]
+    )
+    print(f"Exported {model} ({shape}) to {output}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    export(sys.argv[1], sys.argv[2])
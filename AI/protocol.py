@@ -0,0 +1,369 @@
+"""Socket bridge messages shared with the engine, see include/core/RLProtocol.h
+
+Binary messages are a 12 byte little-endian header (magic, version, type,
+payload length) followed by the payload. Text mode keeps the original comma
+separated strings padded to BUFFER_SIZE for older engine builds.
+
+Commands name the agent they are for, and every STATE and STEP names the agent
+it answers, agents being numbered world by world. A command without an agent
+goes to the next agent in turn.
+
+With [Agent] features=1 the engine answers with STEP messages, the observation
+and reward it computed, instead of the raw STATE. With [Vision] enabled=1 the
+STEPs are followed by a FRAME each, the pixels of the enemy's view.
+
+With [Socket] transport=shm the binary messages go through a shared memory
+segment instead of the socket, see include/core/SharedMemoryChannel.h for the
+layout. Like the engine, the Python side stores the head and tail counters
+and the waiting flags sequentially consistent, through libatomic, so that
+neither side can miss the other going to sleep. Without libatomic every push
+and pop wakes the other side instead, a futex call per message.
+"""
+
+import ctypes
+import ctypes.util
+import os
+import platform
+import socket
+import struct
+
+from collections import namedtuple
+from multiprocessing import shared_memory
+
+BUFFER_SIZE = 2048
+
+MAGIC = b"GERL"
+VERSION = 2
+
+STATE = 1
+ACTION = 2
+RESET = 3
+STEP = 4
+FRAME = 5
+
+HEADER = struct.Struct("<4sHHI")
+STATE_PAYLOAD = struct.Struct("<17fI")
+STEP_AGENT = struct.Struct("<I")
+ACTION_PAYLOAD = struct.Struct("<i")
+AGENT_PAYLOAD = struct.Struct("<I")
+FRAME_HEADER = struct.Struct("<4H")
+# Without sensors, each ray adds a distance and a hit type, see
+# include/ai/ObservationBuilder.h and include/components/RaySensor.h
+OBSERVATION_SIZE = 12
+
+# Sent with a reset as "reset,<mode>", see include/ai/RewardEvaluator.h
+REWARD_MODES = {"range": 0, "face": 1, "shoot": 2, "final": 3}
+
+Step = namedtuple("Step", "observation reward terminated truncated agent")
+# Rows top to bottom, latency is the readbacks the pixels trail the step by
+Frame = namedtuple("Frame", "pixels height width channels latency")
+
+SHM_MAGIC = 0x4D484547
+SHM_VERSION = 3
+SHM_CAPACITY = 16
+SHM_SLOT_SIZE = 32768
+SHM_TO_AGENT = 64
+SHM_TO_ENGINE = 524480
+SHM_SIZE = SHM_TO_ENGINE + 128 + SHM_CAPACITY * SHM_SLOT_SIZE
+SHM_SPIN_COUNT = 2000 if (os.cpu_count() or 1) > 1 else 0
+SHM_SLEEP_TIMEOUT = 0.1
+
+SYS_FUTEX = {"x86_64": 202, "aarch64": 98}.get(platform.machine())
+FUTEX_WAIT = 0
+FUTEX_WAKE = 1
+ATOMIC_SEQ_CST = 5  # __ATOMIC_SEQ_CST
+
+
+def recv_exact(conn, size):
+    data = bytearray()
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("Engine closed the connection")
+        data += chunk
+    return bytes(data)
+
+
+def with_agent(msg, agent):
+    """msg for agent, "reset" taking -1 to keep the reward mode"""
+    if msg == "reset":
+        msg = "reset,-1"
+    return f"{msg},{agent}"
+
+
+def encode_command(msg):
+    """Binary message for "reset", "reset,<mode>", "action,<n>", each
+    optionally followed by ",<agent>" """
+    kind = RESET if msg.startswith("reset") else ACTION
+    fields = msg.split(",")[1:]
+    payload = b""
+    if fields:
+        payload += ACTION_PAYLOAD.pack(int(fields[0]))
+    if len(fields) > 1:
+        payload += AGENT_PAYLOAD.pack(int(fields[1]))
+    return HEADER.pack(MAGIC, VERSION, kind, len(payload)) + payload
+
+
+def make_step(agent, values):
+    reward, terminated, truncated = values[:3]
+    return Step(
+        list(values[3:]), reward, terminated != 0.0, truncated != 0.0, agent
+    )
+
+
+def get_agent(state):
+    """Agent a STATE's fields or a Step answer"""
+    if isinstance(state, Step):
+        return state.agent
+    return int(float(state[17]))
+
+
+def decode_state(header, payload):
+    """State fields in the order of the text format, a Step or a Frame"""
+    magic, version, kind, _ = HEADER.unpack(header)
+    if magic != MAGIC or version != VERSION or kind not in (STATE, STEP, FRAME):
+        raise ValueError(f"Unexpected engine message {magic} {version} {kind}")
+
+    if kind == FRAME:
+        width, height, channels, latency = FRAME_HEADER.unpack_from(payload)
+        return Frame(
+            payload[FRAME_HEADER.size :], height, width, channels, latency
+        )
+    if kind == STEP:
+        (agent,) = STEP_AGENT.unpack_from(payload)
+        values = payload[STEP_AGENT.size :]
+        return make_step(agent, struct.unpack(f"<{len(values) // 4}f", values))
+
+    state = list(STATE_PAYLOAD.unpack(payload))
+    state[8] = "True" if state[8] != 0.0 else "False"
+    return state
+
+
+class EngineLink:
+    def __init__(self, conn, protocol="binary"):
+        self.conn = conn
+        self.binary = protocol != "text"
+        if self.binary:
+            conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def send(self, msg):
+        """Sends "reset" or "action,<n>" in the configured format"""
+        if not self.binary:
+            self.conn.sendall(msg.encode().ljust(BUFFER_SIZE, b"\0"))
+            return
+        self.conn.sendall(encode_command(msg))
+
+    def recv(self):
+        """Returns the state fields in the order of the text format, or a
+        Step with [Agent] features=1"""
+        if not self.binary:
+            msg = recv_exact(self.conn, BUFFER_SIZE).strip(b"\0").decode()
+            fields = msg.split(",")
+            if fields[0] == "step":
+                return make_step(
+                    int(fields[1]), [float(value) for value in fields[2:]]
+                )
+            return fields
+
+        header = recv_exact(self.conn, HEADER.size)
+        length = HEADER.unpack(header)[3]
+        return decode_state(header, recv_exact(self.conn, length))
+
+    def exchange(self, msgs):
+        """One message per agent, [Engine] worlds times [Agent] enemies
+        numbered world by world, returns their states in the same order"""
+        msgs = [with_agent(msg, agent) for agent, msg in enumerate(msgs)]
+        if self.binary:
+            self.conn.sendall(b"".join(encode_command(msg) for msg in msgs))
+        else:
+            for msg in msgs:
+                self.send(msg)
+        return collect(self, len(msgs))
+
+    def close(self):
+        self.conn.close()
+
+
+def collect(link, count):
+    """The states of count agents, put in agent order by the agent each
+    names, as the engine sends them in the order their steps end"""
+    states = [None] * count
+    for _ in range(count):
+        state = link.recv()
+        states[get_agent(state)] = state
+    return states
+
+
+def load_exchange_u32():
+    """__atomic_exchange_4 of libatomic, None when it is not installed"""
+    path = ctypes.util.find_library("atomic")
+    if path is None:
+        return None
+    exchange = getattr(ctypes.CDLL(path), "__atomic_exchange_4")
+    exchange.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_int]
+    exchange.restype = ctypes.c_uint32
+    return exchange
+
+
+class Timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+class SharedRing:
+    """One direction of the segment, head and tail count messages"""
+
+    def __init__(self, link, offset):
+        buf = link.shm.buf
+        self.link = link
+        self.buf = buf
+        self.head = ctypes.c_uint32.from_buffer(buf, offset)
+        self.consumer_waiting = ctypes.c_uint32.from_buffer(buf, offset + 4)
+        self.tail = ctypes.c_uint32.from_buffer(buf, offset + 64)
+        self.producer_waiting = ctypes.c_uint32.from_buffer(buf, offset + 68)
+        self.slots = offset + 128
+
+    def slot(self, index):
+        start = self.slots + (index % SHM_CAPACITY) * SHM_SLOT_SIZE
+        return start, start + SHM_SLOT_SIZE
+
+    def push(self, message):
+        head = self.head.value
+        while (head - self.tail.value) & 0xFFFFFFFF == SHM_CAPACITY:
+            self.link.wait(
+                self.tail,
+                self.producer_waiting,
+                (head - SHM_CAPACITY) & 0xFFFFFFFF,
+            )
+
+        start, _ = self.slot(head)
+        self.buf[start : start + len(message)] = message
+        self.link.publish(self.head, (head + 1) & 0xFFFFFFFF, self.consumer_waiting)
+
+    def pop(self):
+        tail = self.tail.value
+        while self.head.value == tail:
+            self.link.wait(self.head, self.consumer_waiting, tail)
+
+        # Only the bytes the header covers, slots are much larger than most
+        # messages
+        start, end = self.slot(tail)
+        length = HEADER.unpack_from(self.buf, start)[3]
+        message = bytes(self.buf[start : min(end, start + HEADER.size + length)])
+        self.link.publish(self.tail, (tail + 1) & 0xFFFFFFFF, self.producer_waiting)
+        return message
+
+    def release(self):
+        del self.head, self.consumer_waiting, self.tail, self.producer_waiting
+
+
+class SharedMemoryLink:
+    """Same interface as EngineLink over the shared memory rings
+
+    The segment is created here and named after the port, the engine maps
+    it once the ready byte arrives on the socket.
+    """
+
+    def __init__(self, conn, port):
+        if SYS_FUTEX is None:
+            raise RuntimeError(f"No futex support on {platform.machine()}")
+
+        self.conn = conn
+        self.libc = ctypes.CDLL(None, use_errno=True)
+        self.exchange_u32 = load_exchange_u32()
+
+        name = f"gameengine_rl_{port}"
+        try:
+            stale = shared_memory.SharedMemory(name=name)
+            stale.close()
+            stale.unlink()
+        except FileNotFoundError:
+            pass
+
+        self.shm = shared_memory.SharedMemory(
+            name=name, create=True, size=SHM_SIZE
+        )
+        struct.pack_into(
+            "<4I", self.shm.buf, 0, SHM_MAGIC, SHM_VERSION, SHM_CAPACITY,
+            SHM_SLOT_SIZE,
+        )
+        self.closed = ctypes.c_uint32.from_buffer(self.shm.buf, 16)
+        self.to_agent = SharedRing(self, SHM_TO_AGENT)
+        self.to_engine = SharedRing(self, SHM_TO_ENGINE)
+
+        conn.sendall(b"\x01")
+
+    def futex(self, word, op, value, timeout=None):
+        self.libc.syscall(
+            SYS_FUTEX, ctypes.byref(word), op, value,
+            ctypes.byref(timeout) if timeout else None, None, 0,
+        )
+
+    def wake(self, word):
+        self.futex(word, FUTEX_WAKE, 1)
+
+    def store(self, word, value):
+        """Sequentially consistent store, a plain one without libatomic"""
+        if self.exchange_u32 is None:
+            word.value = value
+        else:
+            self.exchange_u32(ctypes.byref(word), value, ATOMIC_SEQ_CST)
+
+    def publish(self, word, value, waiting):
+        """Stores a head or tail and wakes the other side if it waits on it
+
+        The store and the load of the waiting flag mirror the flag store and
+        the futex check in wait(), so one of the two sides always sees the
+        other's write, as long as the store is a full barrier.
+        """
+        self.store(word, value)
+        if self.exchange_u32 is None or waiting.value:
+            self.wake(word)
+
+    def wait(self, word, waiting, value):
+        for _ in range(SHM_SPIN_COUNT):
+            if word.value != value:
+                return
+
+        timeout = Timespec(0, int(SHM_SLEEP_TIMEOUT * 1e9))
+        while word.value == value:
+            self.store(waiting, 1)
+            self.futex(word, FUTEX_WAIT, value, timeout)
+            waiting.value = 0
+            if self.closed.value:
+                raise ConnectionError("Engine closed the connection")
+
+    def send(self, msg):
+        self.to_engine.push(encode_command(msg))
+
+    def exchange(self, msgs):
+        """Same as EngineLink.exchange"""
+        for agent, msg in enumerate(msgs):
+            self.send(with_agent(msg, agent))
+        return collect(self, len(msgs))
+
+    def recv(self):
+        message = self.to_agent.pop()
+        header = message[: HEADER.size]
+        length = HEADER.unpack(header)[3]
+        return decode_state(header, message[HEADER.size : HEADER.size + length])
+
+    def close(self):
+        self.closed.value = 1
+        self.wake(self.to_engine.head)
+        self.wake(self.to_agent.tail)
+
+        self.to_agent.release()
+        self.to_engine.release()
+        del self.closed
+        self.shm.close()
+        self.shm.unlink()
+        self.conn.close()
+
+
+def open_link(conn, config):
+    """Link for the [Socket] section of config.conf"""
+    if config.get("Socket", "transport", fallback="tcp") == "shm":
+        return SharedMemoryLink(conn, config.getint("Socket", "port"))
+    return EngineLink(
+        conn, config.get("Socket", "protocol", fallback="binary")
+    )
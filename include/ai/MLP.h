@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Inference for small fully connected policies, such as the actor of the
+ * PPO models trained in AI/, without Python or any other dependency.
+ *
+ * Weights are loaded from the flat format written by AI/export_policy.py,
+ * all little-endian:
+ *
+ *	uint32 magic	"GEML"
+ *	uint32 version
+ *	uint32 layer count
+ *	per layer:
+ *		uint32 inputs, uint32 outputs, uint32 activation
+ *		float32 weights[outputs][inputs]
+ *		float32 bias[outputs]
+ *
+ * Rows are stored padded to a multiple of 8 floats so the dense kernel
+ * never needs a scalar tail. The kernel is picked once at runtime: AVX2
+ * with FMA where the CPU has it, SSE otherwise, and plain C++ off x86.
+ *
+ * A loaded MLP is immutable and forward() only uses thread local scratch,
+ * so one instance can serve every world at once. Many agents are best run
+ * through forward_batch(), which goes layer by layer over the whole batch
+ * so each layer's weights are loaded into cache once per batch rather
+ * than once per agent.
+ */
+class MLP {
+    public:
+	enum class Activation : uint32_t {
+		NONE = 0,
+		TANH = 1,
+		RELU = 2
+	};
+
+	static constexpr uint32_t MAGIC = 0x4c4d4547; // "GEML" on disk
+	static constexpr uint32_t VERSION = 1;
+
+    private:
+	struct Layer {
+		int32_t inputs;
+		int32_t outputs;
+		int32_t stride; // inputs rounded up to 8
+		Activation activation;
+		std::vector<float> weights; // outputs rows of stride floats
+		std::vector<float> bias;
+	};
+
+	std::vector<Layer> layers;
+	int32_t max_width = 0; // Widest padded layer input or output
+
+    public:
+	MLP();
+
+	static MLP load(const std::string &file_path);
+
+	// Row major weights[outputs][inputs], inputs must match the last layer
+	void add_layer(int32_t inputs, int32_t outputs, Activation activation,
+		       const float *weights, const float *bias);
+
+	int32_t get_input_size() const noexcept;
+
+	int32_t get_output_size() const noexcept;
+
+	// Writes get_output_size() values, the logits for a policy
+	void forward(const float *input, float *output) const;
+
+	// count rows of get_input_size() floats in, of get_output_size() out
+	void forward_batch(const float *inputs, int32_t count,
+			   float *outputs) const;
+
+	// Greedy action
+	int32_t argmax(const float *input) const;
+
+	// Action drawn from the softmax of the logits
+	int32_t sample(const float *input, std::mt19937 &rng) const;
+
+	// The same two choices from count logits computed already
+	static int32_t argmax_logits(const float *logits, int32_t count);
+
+	static int32_t sample_logits(const float *logits, int32_t count,
+				     std::mt19937 &rng);
+
+	// Name of the dense kernel in use, for logging
+	static const char *get_kernel_name();
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <math/Vector3f.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Walkable surface of the arena for bots to plan over, baked from the
+ * triangles of the terrain's collision mesh.
+ *
+ * Building voxelizes the triangles into a heightfield of cell_size cells,
+ * x and y with z up, keeping one surface per cell, the highest:
+ *
+ *	- triangles no steeper than max_slope are walkable surface
+ *	- steeper ones are walls, blocking the cells where they rise between
+ *	  max_climb and agent_height above the surface
+ *	- neighbouring cells connect when their heights differ by at most
+ *	  max_climb, and cells closer than agent_radius to an edge or a wall
+ *	  are eroded away, so bots planning over them stay on the arena
+ *
+ * What is left is merged greedily into rectangles of cells, the polygons,
+ * each linked to its neighbours through the edge segment they share.
+ *
+ * find_path() runs A* over the polygons, then pulls the string through the
+ * shared edges for the corners of the shortest path along that corridor.
+ * Corridors are cached by start and goal polygon, so bots chasing the same
+ * player share one search. Queries only read the mesh and use thread local
+ * scratch, so one mesh serves every world thread at once.
+ *
+ * A baked mesh is saved with a hash of the triangles and settings it was
+ * built from, and rebuilt once they change. The file is little-endian:
+ *
+ *	uint32 magic	"GENM"
+ *	uint32 version
+ *	uint32 hash low, uint32 hash high
+ *	uint32 width, uint32 height	in cells
+ *	float32 origin x, float32 origin y, float32 cell size
+ *	uint32 polygon count
+ *	per polygon:
+ *		uint32 x0, y0, x1, y1	cells [x0, x1) by [y0, y1)
+ *		float32 z
+ *		uint32 link count
+ *		per link: uint32 polygon, float32 ax, ay, bx, by
+ */
+class NavMesh {
+    public:
+	struct Settings {
+		float cell_size = 0.25f;
+		float agent_radius = 0.5f;
+		float agent_height = 2.0f;
+		float max_slope = 45.0f; // Degrees
+		float max_climb = 0.4f;
+	};
+
+	static constexpr uint32_t MAGIC = 0x4d4e4547; // "GENM" on disk
+	static constexpr uint32_t VERSION = 1;
+
+    private:
+	struct Polygon {
+		int32_t x0, y0, x1, y1; // Cells [x0, x1) by [y0, y1)
+		float z;
+		int32_t first_link;
+		int32_t link_count;
+	};
+
+	struct Link {
+		int32_t polygon;
+		float ax, ay, bx, by; // Ends of the shared edge
+	};
+
+	struct Cache;
+
+	uint64_t source_hash = 0;
+	int32_t width = 0, height = 0;
+	float origin_x = 0.0f, origin_y = 0.0f, cell_size = 1.0f;
+	std::vector<Polygon> polygons;
+	std::vector<Link> links;
+	std::vector<int32_t> cells; // Polygon of every cell, -1 for none
+	std::unique_ptr<Cache> cache;
+
+	// Fills cells from the polygons
+	void index_cells();
+
+	// Under x, y or the nearest one a few cells away, -1 for none
+	int32_t find_polygon(float x, float y) const;
+
+	float center_x(const Polygon &polygon) const noexcept;
+
+	float center_y(const Polygon &polygon) const noexcept;
+
+	bool search(int32_t start, int32_t goal,
+		    std::vector<int32_t> &corridor) const;
+
+	void find_corridor(int32_t start, int32_t goal,
+			   std::vector<int32_t> &corridor) const;
+
+    public:
+	NavMesh();
+	NavMesh(NavMesh &&) noexcept;
+	NavMesh &operator=(NavMesh &&) noexcept;
+	~NavMesh();
+
+	// positions holds 3 floats per vertex, indices 3 per triangle
+	static NavMesh build(const std::vector<float> &positions,
+			     const std::vector<int32_t> &indices,
+			     const Settings &settings);
+
+	static uint64_t hash_source(const std::vector<float> &positions,
+				    const std::vector<int32_t> &indices,
+				    const Settings &settings);
+
+	static NavMesh load(const std::string &file_path);
+
+	void save(const std::string &file_path) const;
+
+	// Loads file_path when it was baked from the same source, otherwise
+	// builds the mesh and saves it there
+	static NavMesh bake(const std::vector<float> &positions,
+			    const std::vector<int32_t> &indices,
+			    const Settings &settings,
+			    const std::string &file_path);
+
+	uint64_t get_source_hash() const noexcept;
+
+	int32_t get_polygon_count() const noexcept;
+
+	// Whether a bot can stand at x, y
+	bool is_walkable(float x, float y) const;
+
+	// Corners from start to goal, both included, with start and goal
+	// moved onto the mesh when just off it. False when there is no path
+	bool find_path(const Vector3f &start, const Vector3f &goal,
+		       std::vector<Vector3f> &path) const;
+};
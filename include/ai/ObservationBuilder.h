@@ -0,0 +1,63 @@
+#pragma once
+
+#include <core/RLProtocol.h>
+
+#include <cstddef>
+
+class Entity;
+
+/*
+ * Turns the state of an agent's entity and its target into the normalized
+ * features a policy acts on, SIZE floats:
+ *
+ *	0-2	target position relative to the agent, / position_scale
+ *	3	yaw error, from the agent's facing to the target, / pi
+ *	4	distance minus target_distance, / position_scale
+ *	5, 6	agent and target hp, as a fraction of their maximum
+ *	7, 8	agent and target hp change since the last observation
+ *	9	1 when the agent's last shot hit
+ *	10	1 when the agent lost hp since the last observation
+ *	11	1 when the agent is on the ground
+ *
+ * Readings of a RaySensor on the agent, when it has one, are appended by
+ * the caller.
+ *
+ * The hp of the last observation is kept for the deltas, so every agent
+ * needs its own builder.
+ */
+class ObservationBuilder {
+    public:
+	static constexpr size_t SIZE = 12;
+	// Raw layout the shipped policies were trained on, see AI/AI_RL.py
+	static constexpr size_t LEGACY_SIZE = 9;
+
+	struct Observation {
+		float features[SIZE];
+		float distance;
+		float distance_error; // Distance minus target_distance
+		float yaw_error; // Radians, in [-pi, pi]
+		float agent_hp;
+		float target_hp;
+		bool shot_hit;
+		bool got_hit;
+	};
+
+    private:
+	float target_distance;
+	float position_scale;
+	float last_agent_hp = 0.0f;
+	float last_target_hp = 0.0f;
+
+    public:
+	// Reads [Observation] target_distance and position_scale
+	ObservationBuilder();
+
+	// Sets the baseline of the hp deltas, after a reset
+	void reset(Entity &agent, Entity &target);
+
+	Observation build(Entity &agent, Entity &target, bool shot_hit);
+
+	// enemy position, player position, enemy hp, player hp, distance
+	static void build_legacy(const RLProtocol::AgentState &state,
+				 float *out) noexcept;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <ai/ObservationBuilder.h>
+
+#include <cstdint>
+#include <string>
+
+/*
+ * Reward and end of episode for one agent, the training objectives of
+ * AI/AI_RL.py evaluated in the engine.
+ *
+ * An episode terminates once either side is out of hp, rewarded with win
+ * or loss, and is truncated after max_steps steps when that is set.
+ * Otherwise the reward depends on the mode:
+ *
+ *	range	-|distance - target_distance|
+ *	face	-|yaw error|
+ *	shoot	hit if the last shot hit, else shot for shooting, else miss
+ *	final	shoot minus range
+ */
+class RewardEvaluator {
+    public:
+	enum class Mode : int32_t {
+		RANGE = 0,
+		FACE = 1,
+		SHOOT = 2,
+		FINAL = 3
+	};
+
+	struct Result {
+		float reward = 0.0f;
+		bool terminated = false;
+		bool truncated = false;
+	};
+
+    private:
+	Mode mode;
+	float win, loss, hit, shot, miss;
+	int32_t shoot_action;
+	int32_t max_steps;
+	int32_t steps = 0;
+
+    public:
+	// Reads the [Reward] section
+	RewardEvaluator();
+
+	static Mode parse_mode(const std::string &name);
+
+	void set_mode(Mode mode) noexcept;
+
+	Mode get_mode() const noexcept;
+
+	// Starts a new episode
+	void reset() noexcept;
+
+	// action is the one the agent took during the step
+	Result evaluate(const ObservationBuilder::Observation &observation,
+			int32_t action);
+};
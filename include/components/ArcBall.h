@@ -18,6 +18,9 @@ class ArcBall : public GameComponent {
 	float azimuth = 0.0f;
 	float elevation = 0.0f;
 	Transform *target;
+	bool dragging = false;
+	bool has_last_mouse_pos = false;
+	double last_mouse_pos[2] = { 0, 0 };
 
     public:
 	ArcBall(Transform *target = nullptr, float radius = 1.0f,
@@ -33,18 +36,21 @@ class ArcBall : public GameComponent {
 		if (target == nullptr)
 			return;
 
-		static bool flag = false;
 		if (input_handler.is_mouse_down(GLFW_MOUSE_BUTTON_2)) {
-			flag = true;
+			dragging = true;
 		}
-		if (flag && input_handler.is_mouse_up(GLFW_MOUSE_BUTTON_2)) {
-			flag = false;
+		if (dragging &&
+		    input_handler.is_mouse_up(GLFW_MOUSE_BUTTON_2)) {
+			dragging = false;
 		}
 
 		const double(*mouse_pos)[2] = input_handler.get_mouse_pos();
-		static double last_mouse_pos[2] = { mouse_pos[0][0],
-						    mouse_pos[0][1] };
-		if (flag) {
+		if (!has_last_mouse_pos) {
+			last_mouse_pos[0] = mouse_pos[0][0];
+			last_mouse_pos[1] = mouse_pos[0][1];
+			has_last_mouse_pos = true;
+		}
+		if (dragging) {
 			float dx = (mouse_pos[0][0] - last_mouse_pos[0]) *
 				   sensitivity;
 			float dy = (mouse_pos[0][1] - last_mouse_pos[1]) *
@@ -59,6 +65,19 @@ class ArcBall : public GameComponent {
 	}
 
 	void update(float delta) override
+	{
+		place();
+	}
+
+	void interpolate(float alpha) override
+	{
+		place();
+	}
+
+	void render(Shader &) override {};
+
+    private:
+	void place()
 	{
 		if (target == nullptr)
 			return;
@@ -73,6 +92,4 @@ class ArcBall : public GameComponent {
 			->set_translation(new_position)
 			.look_at(target->get_translation(), Vector3f::z_axis);
 	}
-
-	void render(Shader &) override {};
 };
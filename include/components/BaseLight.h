@@ -4,6 +4,7 @@
 
 #include <graphics/Shader.h>
 #include <graphics/Attenuation.h>
+#include <graphics/RenderSnapshot.h>
 
 #include <components/GameComponent.h>
 #include <core/SharedGlobals.h>
@@ -85,6 +86,11 @@ struct BaseLight : public GameComponent {
 			static_cast<void *>(this));
 	}
 
+	void add_to_snapshot(RenderSnapshot &snapshot) override
+	{
+		snapshot.lights.emplace_back(*this);
+	}
+
     private:
 	void input(float delta) override {};
 	void update(float delta) override {};
@@ -21,6 +21,8 @@
 class CameraObject : public GameObject {
 	float fov;
 	Quaternion init_rotation;
+	// Of the presented world, the only camera that follows the window
+	bool presented = false;
 
     public:
 	Camera *camera;
@@ -51,10 +53,15 @@ class CameraObject : public GameObject {
 		camera->set_projection(to_radians(fov), 1.0f, .1f, 1000.0f);
 	}
 
+	void set_presented(bool presented) noexcept
+	{
+		this->presented = presented;
+	}
+
 	void update(float delta) override
 	{
 		SharedGlobals &globals = SharedGlobals::get_instance();
-		if (globals.resized) {
+		if (presented && globals.resized) {
 			camera->set_projection(to_radians(fov),
 					       globals.w_height /
 						       globals.w_height,
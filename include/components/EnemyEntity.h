@@ -1,8 +1,8 @@
 #pragma once
 
-#include <core/SocketManager.h>
+#include <core/RLProtocol.h>
 
-#include <core/SharedGlobals.h>
+#include <core/World.h>
 #include <components/Entity.h>
 #include <components/LookAtComponent.h>
 #include <components/PointLight.h>
@@ -27,6 +27,10 @@ btScalar ROTATE_IMPULSE_FACTOR = 2.5e2;
 class EnemyEntity : public Entity {
 	bool should_shoot = false;
 	bool shot_hit = false;
+	// Set by the agent bridge. An action is repeated every tick until the
+	// next command arrives, a reset is applied once
+	RLProtocol::Command command;
+	int32_t damage_stage = 4;
 
     public:
 	EnemyEntity(const Vector3f &spawn_pos = DEFAULT_ENTITY_SPAWN_POS)
@@ -38,37 +42,40 @@ class EnemyEntity : public Entity {
 					->add_component(new PointLight(
 						"#fed", 1.0f, { 0, 0, 0.02f }))
 					->add_component(new FollowComponent(
-						{ 0, -0.5, 10 }, &transform)));
+						{ 0, -0.5, 10 }, &transform))
+					->set_parallel(true));
 		this->set_max_hp(250);
 		this->set_hp(this->get_max_hp());
 
 		rigid_body->setDamping(0.0f, 0.0f);
 		this->move_impulse_factor = MOVE_IMPULSE_FACTOR;
 		this->rotate_impulse_factor = ROTATE_IMPULSE_FACTOR;
+		update_material();
+	}
+
+	void set_command(const RLProtocol::Command &command) noexcept
+	{
+		this->command = command;
+	}
+
+	const RLProtocol::Command &get_command() const noexcept
+	{
+		return command;
 	}
 
 	void input(float delta) override
 	{
 #ifndef MULTIPLAYER
-		static SocketManager &sock_manager =
-			SocketManager::get_instance();
-		static Entity *p_ent =
-			static_cast<Entity *>(SharedGlobals::player_entity);
-		std::string received_data = sock_manager.receive_data();
+		Entity *p_ent = world->player_entity;
 
 		int32_t action = -1;
 		float factor = 1.0f;
-		if (received_data.find("reset") != std::string::npos) {
+		if (command.type == RLProtocol::Command::Type::RESET) {
 			p_ent->reset();
 			this->reset();
-			sock_manager.send_data(get_state());
-		} else if (received_data.find("action") != std::string::npos) {
-			std::stringstream ss(received_data);
-			std::string command;
-
-			std::getline(ss, command, ',');
-			ss >> action;
-			// ss >> factor;
+			command = {};
+		} else if (command.type == RLProtocol::Command::Type::ACTION) {
+			action = command.action;
 		}
 		if (p_ent && rigid_body && hp > 0) {
 			if (should_shoot) {
@@ -92,13 +99,10 @@ class EnemyEntity : public Entity {
 			} else if (action == 3) {
 				move_right(delta * factor);
 			} else if (action == 4) {
-				static std::random_device rd;
-				static std::mt19937 gen(rd());
-				static std::uniform_real_distribution<> dis(
-					0.0, 1.0);
+				std::uniform_real_distribution<> dis(0.0, 1.0);
 
 				if (action == 4) {
-					float probability = dis(gen);
+					float probability = dis(world->rng);
 
 					if (probability < 0.3f) {
 						shoot();
@@ -123,15 +127,7 @@ class EnemyEntity : public Entity {
 	void update(float delta) override
 	{
 		update_material();
-#ifndef MULTIPLAYER
-		static SocketManager &sock_manager =
-			SocketManager::get_instance();
-
-		sock_manager.send_data(get_state());
-#endif
-		static const btRigidBody *p_body =
-			static_cast<Entity *>(SharedGlobals::player_entity)
-				->get_rigid_body();
+		const btRigidBody *p_body = world->player_entity->get_rigid_body();
 
 		btVector3 rigidPos = rigid_body->getCenterOfMassPosition();
 		btVector3 targetPos = p_body->getCenterOfMassPosition();
@@ -163,6 +159,11 @@ class EnemyEntity : public Entity {
 		Entity::update(delta);
 	}
 
+	bool get_shot_hit() const noexcept
+	{
+		return shot_hit;
+	}
+
 	bool missed_shot()
 	{
 		bool state = shot_hit;
@@ -180,88 +181,55 @@ class EnemyEntity : public Entity {
 		Entity::get_hit();
 	}
 
-    private:
-	std::string get_enemy_position_string()
+	void save_state(WorldSnapshot &snapshot) const override
 	{
-		Vector3f enemy_pos = transform.get_translation();
-		return std::to_string(enemy_pos.getX()) + "," +
-		       std::to_string(enemy_pos.getY()) + "," +
-		       std::to_string(enemy_pos.getZ());
+		Entity::save_state(snapshot);
+		snapshot.write(should_shoot);
+		snapshot.write(shot_hit);
+		snapshot.write(command);
 	}
 
-	std::string get_player_position_string()
+	void restore_state(WorldSnapshot::Reader &reader) override
 	{
-		if (SharedGlobals::player_entity) {
-			Vector3f player_pos =
-				static_cast<Entity *>(
-					SharedGlobals::player_entity)
-					->transform.get_translation();
-			return std::to_string(player_pos.getX()) + "," +
-			       std::to_string(player_pos.getY()) + "," +
-			       std::to_string(player_pos.getZ());
-		}
-		return "0,0,0";
+		Entity::restore_state(reader);
+		reader.read(should_shoot);
+		reader.read(shot_hit);
+		reader.read(command);
 	}
 
-	std::string get_enemy_rotation_string()
+	RLProtocol::AgentState get_state()
 	{
+		Entity *p_ent = world->player_entity;
+		Vector3f enemy_pos = transform.get_translation();
+		Vector3f player_pos = p_ent->transform.get_translation();
 		Quaternion enemy_rot = transform.get_rotation();
-		return std::to_string(enemy_rot.getW()) + "," +
-		       std::to_string(enemy_rot.getX()) + "," +
-		       std::to_string(enemy_rot.getY()) + "," +
-		       std::to_string(enemy_rot.getZ());
-	}
-
-	std::string get_player_rotation_string()
-	{
-		if (SharedGlobals::player_entity) {
-			Quaternion player_rot =
-				static_cast<Entity *>(
-					SharedGlobals::player_entity)
-					->transform.get_rotation();
-			return std::to_string(player_rot.getW()) + "," +
-			       std::to_string(player_rot.getX()) + "," +
-			       std::to_string(player_rot.getY()) + "," +
-			       std::to_string(player_rot.getZ());
-		}
-		return "0,0,0,0";
+		Quaternion player_rot = p_ent->transform.get_rotation();
+
+		return { hp,
+			 p_ent->get_hp(),
+			 { enemy_pos.getX(), enemy_pos.getY(),
+			   enemy_pos.getZ() },
+			 { player_pos.getX(), player_pos.getY(),
+			   player_pos.getZ() },
+			 shot_hit ? 1.0f : 0.0f,
+			 { enemy_rot.getW(), enemy_rot.getX(), enemy_rot.getY(),
+			   enemy_rot.getZ() },
+			 { player_rot.getW(), player_rot.getX(),
+			   player_rot.getY(), player_rot.getZ() } };
 	}
 
+    private:
 	void update_material()
 	{
-		static Material &mat = mesh->get_material();
-		static int32_t old_stage = 4, new_stage = 4;
-		static const std::string diffuses[] = {
-			"./assets/objects/Main_model_0.png",
-			"./assets/objects/Main_model_25.png",
-			"./assets/objects/Main_model_50.png",
-			"./assets/objects/Main_model_75.png",
-			"./assets/objects/Main_model_100.png"
-		};
-
-		float hp = this->hp * 100.0f / this->max_hp;
-		new_stage =
-			4 - (hp <= 75) - (hp <= 50) - (hp <= 25) - (hp <= 0);
-
-		if (new_stage != old_stage) {
-			old_stage = new_stage;
-			mat.add_property(
-				"diffuse",
-				Texture::load_texture(diffuses[new_stage]));
+		// The first call, from the constructor, loads the textures
+		// while the GL context is still current on this thread
+		DamageTextures &diffuses = DamageTextures::get_instance();
+		int32_t stage = DamageTextures::get_stage(hp, max_hp);
+
+		if (stage != damage_stage) {
+			damage_stage = stage;
+			mesh->get_material().add_property("diffuse",
+							  diffuses.get(stage));
 		}
 	}
-
-	std::string get_state()
-	{
-		std::stringstream state;
-		state << hp << ","
-		      << static_cast<Entity *>(SharedGlobals::player_entity)
-				 ->get_hp()
-		      << "," << get_enemy_position_string() << ","
-		      << get_player_position_string() << ","
-		      << (shot_hit ? "True" : "False") << ','
-		      << get_enemy_rotation_string() << ','
-		      << get_player_rotation_string() << ',';
-		return state.str();
-	}
-};
\ No newline at end of file
+};
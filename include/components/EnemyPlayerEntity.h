@@ -1,15 +1,14 @@
 #pragma once
 #ifdef MULTIPLAYER
 
+#include <core/Config.h>
 #include <core/SharedGlobals.h>
 
 #include <components/Entity.h>
 #include <components/LookAtComponent.h>
 #include <components/PointLight.h>
 
-#include <misc/SafeQueue.h>
-
-#include <utility>
+#include <multiplayer/Moves.h>
 
 class EnemyPlayerEntity : public Entity {
     public:
@@ -17,14 +16,18 @@ class EnemyPlayerEntity : public Entity {
 		: Entity("./assets/objects/Main_model.fbx",
 			 "./assets/objects/Main_model_100.png", spawn_pos,
 			 false)
+		, interpolation(load_interpolation_settings())
 	{
 		this->add_child((new GameObject())
 					->add_component(new PointLight(
 						"#def", 1.0f, { 0, 0, 0.02f }))
 					->add_component(new FollowComponent(
-						{ 0, -0.5, 10 }, &transform)));
+						{ 0, -0.5, 10 }, &transform))
+					->set_parallel(true));
+		this->set_parallel(true);
 		this->set_hp(100);
 		this->set_max_hp(100);
+		update_material();
 	}
 
 	void input(float delta) override
@@ -33,81 +36,105 @@ class EnemyPlayerEntity : public Entity {
 		static Timer &timer = Timer::get_instance();
 		static SharedGlobals &globals = SharedGlobals::get_instance();
 
-		if (globals.enemy_moves) {
-			SafeQueue<std::pair<int32_t, std::vector<float> > >
-				*safe_queue = static_cast<SafeQueue<std::pair<
-					int32_t, std::vector<float> > > *>(
-					globals.enemy_moves);
-
-			if (safe_queue->size() && hp > 0) {
-				auto [action, delta] = safe_queue->pop();
-				switch (action) {
-				case 0:
-					move_forward(delta[0]);
-					break;
-				case 1:
-					move_left(delta[0]);
-					break;
-				case 2:
-					move_backward(delta[0]);
-					break;
-				case 3:
-					move_right(delta[0]);
-					break;
-				case 4:
-					rotate_left(delta[0]);
-					break;
-				case 5:
-					rotate_right(delta[0]);
-					break;
-				case 6:
-					shoot();
-					break;
-				case 7:
-					jump(delta[0]);
-					break;
-				case 9:
-					apply_entity_state(
-						{ { delta[0], delta[1],
-						    delta[2] },
-						  { delta[3], delta[4],
-						    delta[5], delta[6] },
-						  { delta[7], delta[8],
-						    delta[9] },
-						  { delta[10], delta[11],
-						    delta[12] } });
-				default:
-					break;
-				}
+		MoveQueue *moves =
+			static_cast<MoveQueue *>(globals.enemy_moves);
+		Move move;
+		// Everything that arrived since the last tick, a late burst
+		// included, so the queue never lags behind
+		while (moves && moves->try_pop(move)) {
+			const float *values = move.values;
+			if (move.action == Move::SYNC) {
+				if (move.count == Move::MAX_VALUES)
+					interpolation.push(
+						double(move.tick) * delta,
+						to_sync_state(values));
+				continue;
+			}
+			if (hp <= 0)
+				continue;
+			switch (move.action) {
+			case 0:
+				move_forward(values[0]);
+				break;
+			case 1:
+				move_left(values[0]);
+				break;
+			case 2:
+				move_backward(values[0]);
+				break;
+			case 3:
+				move_right(values[0]);
+				break;
+			case 4:
+				rotate_left(values[0]);
+				break;
+			case 5:
+				rotate_right(values[0]);
+				break;
+			case 6:
+				shoot();
+				break;
+			case 7:
+				jump(values[0]);
+				break;
+			default:
+				break;
 			}
 		}
+
+		InterpolationBuffer::State state;
+		// Updated while dead too, so its clock keeps up
+		if (interpolation.update(delta, state) && hp > 0) {
+			const Vector3f &p = state.position;
+			const Quaternion &q = state.orientation;
+			const Vector3f &v = state.velocity;
+			const Vector3f &w = state.angular_velocity;
+			apply_entity_state(
+				{ { p.getX(), p.getY(), p.getZ() },
+				  { q.getX(), q.getY(), q.getZ(), q.getW() },
+				  { v.getX(), v.getY(), v.getZ() },
+				  { w.getX(), w.getY(), w.getZ() } });
+		}
 		on_ground = false;
+		update_material();
 		Entity::input(delta);
 	}
 
-	void update(float delta) override
+    private:
+	int32_t damage_stage = 4;
+
+	// Of the states the other player sends, shown delay seconds late
+	InterpolationBuffer interpolation;
+
+	static InterpolationBuffer::Settings load_interpolation_settings()
 	{
-		static Material &mat = mesh->get_material();
-		static int32_t old_stage = 4, new_stage = 4;
-		static const std::string diffuses[] = {
-			"./assets/objects/Main_model_0.png",
-			"./assets/objects/Main_model_25.png",
-			"./assets/objects/Main_model_50.png",
-			"./assets/objects/Main_model_75.png",
-			"./assets/objects/Main_model_100.png"
-		};
+		Config &config = Config::get_instance();
+		InterpolationBuffer::Settings settings;
+		settings.delay =
+			config.get_double("Interpolation", "delay", 0.1);
+		settings.max_extrapolation = config.get_double(
+			"Interpolation", "max_extrapolation", 0.25);
+		settings.correction_time = config.get_double(
+			"Interpolation", "correction_time", 0.1);
+		settings.snap_distance = config.get_double(
+			"Interpolation", "snap_distance", 3.0);
+		return settings;
+	}
 
-		float hp = this->hp * 100.0f / this->max_hp;
-		new_stage =
-			4 - (hp <= 75) - (hp <= 50) - (hp <= 25) - (hp <= 0);
+	// Runs from input() so that update() stays free of GL calls and the
+	// entity can be updated as a parallel job
+	void update_material()
+	{
+		// The first call, from the constructor, loads the textures
+		// while the GL context is still current on this thread
+		DamageTextures &diffuses = DamageTextures::get_instance();
+		int32_t stage = DamageTextures::get_stage(hp, max_hp);
 
-		if (new_stage != old_stage) {
-			old_stage = new_stage;
-			mat.add_property(
-				"diffuse",
-				Texture::load_texture(diffuses[new_stage]));
+		if (stage != damage_stage) {
+			damage_stage = stage;
+			mesh->get_material().add_property("diffuse",
+							  diffuses.get(stage));
 		}
-		Entity::update(delta);
 	}
 };
 #endif
\ No newline at end of file
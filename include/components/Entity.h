@@ -7,13 +7,19 @@
 #include <graphics/Shader.h>
 #include <graphics/Texture.h>
 #include <graphics/Specular.h>
+#include <graphics/DamageTextures.h>
 
 #include <core/SharedGlobals.h>
+#include <core/World.h>
 #include <components/MeshRenderer.h>
 #include <components/GameObject.h>
 #include <components/GameComponent.h>
 
-#include <misc/SafeQueue.h>
+#ifdef MULTIPLAYER
+#include <core/Config.h>
+#include <multiplayer/Moves.h>
+#include <multiplayer/SyncPolicy.h>
+#endif
 
 #include <string>
 #include <cmath>
@@ -33,9 +39,18 @@ class Entity : public GameObject {
 	float jump_cd = 0.0;
 	MeshRenderer *mesh = nullptr;
 	Vector3f spawn_pos;
+	World *world; // The world current when the entity was built
+
+	// Rigid body pose at the last two fixed ticks, rendered in between
+	btTransform previous_transform, current_transform;
 
 #ifdef MULTIPLAYER
-	SafeQueue<std::pair<int32_t, std::vector<float> > > m_moves;
+	MoveQueue m_moves;
+	uint32_t m_sync_tick = 0; // Ticks of the player sent so far
+	SyncPolicy m_sync{ load_sync_settings() };
+	bool m_sync_stats =
+		Config::get_instance().get_bool("Sync", "stats", false);
+	float m_sync_stats_time = 0.0f;
 #endif
 	int32_t m_action = -1;
 	float m_delta = 0.0f;
@@ -56,6 +71,7 @@ class Entity : public GameObject {
 	       const Vector3f &spawn_pos, bool player = false)
 		: player(player)
 		, spawn_pos(spawn_pos)
+		, world(&World::current())
 	{
 		this->physics_type = 20; // Physics for Entity entities
 		transform.set_translation(Vector3f(spawn_pos));
@@ -74,9 +90,8 @@ class Entity : public GameObject {
 		this->add_component(this->mesh =
 					    new MeshRenderer(mesh, material));
 
-		if (SharedGlobals::get_instance().current_rigid_body) {
-			this->rigid_body =
-				SharedGlobals::get_instance().current_rigid_body;
+		if (world->current_rigid_body) {
+			this->rigid_body = world->current_rigid_body;
 			rigid_body->setUserPointer(this);
 
 			btTransform transform;
@@ -85,30 +100,28 @@ class Entity : public GameObject {
 				btVector3({ spawn_pos.getX(), spawn_pos.getY(),
 					    spawn_pos.getZ() }));
 			rigid_body->setWorldTransform(transform);
+			previous_transform = current_transform = transform;
 
-			SharedGlobals::get_instance().rigid_bodies.push_back(
-				rigid_body);
+			world->rigid_bodies.push_back(rigid_body);
 
 			rigid_body->setDamping(0.1f, 0.4f);
 		}
 
+		if (player) {
+			world->player_entity = this;
+		} else {
+			world->enemies.push_back(this);
+		}
+		world->entities.push_back(this);
 #ifdef MULTIPLAYER
 		static SharedGlobals &globals = SharedGlobals::get_instance();
 		if (player) {
-			SharedGlobals::player_entity = this;
 			globals.player_moves =
 				static_cast<void *>(&this->m_moves);
 		} else {
-			SharedGlobals::enemy_entity = this;
 			globals.enemy_moves =
 				static_cast<void *>(&this->m_moves);
 		}
-#else
-		if (player) {
-			SharedGlobals::player_entity = this;
-		} else {
-			SharedGlobals::enemy_entity = this;
-		}
 #endif
 	}
 
@@ -132,24 +145,40 @@ class Entity : public GameObject {
 
 				rigid_body->setLinearVelocity(velocity);
 			}
-			btTransform world_transform =
-				rigid_body->getWorldTransform();
-
-			btVector3 position = world_transform.getOrigin();
-			x = position.getX();
-			y = position.getY();
-			z = position.getZ();
-			transform.set_translation(Vector3f(x, y, z));
-
-			btQuaternion quaternion = world_transform.getRotation();
-			transform.set_rotation(
-				{ quaternion.getX(), quaternion.getY(),
-				  quaternion.getZ(), quaternion.getW() });
+
+			previous_transform = current_transform;
+			current_transform = rigid_body->getWorldTransform();
+			apply_pose(1.0f);
 		}
 
 		GameObject::update();
 	}
 
+	void interpolate(float alpha) override
+	{
+		if (rigid_body)
+			apply_pose(alpha);
+
+		GameObject::interpolate(alpha);
+	}
+
+	void apply_pose(float alpha) noexcept
+	{
+		btVector3 position = current_transform.getOrigin();
+		btQuaternion quaternion = current_transform.getRotation();
+		if (alpha < 1.0f) {
+			position = previous_transform.getOrigin().lerp(
+				position, alpha);
+			quaternion = previous_transform.getRotation().slerp(
+				quaternion, alpha);
+		}
+
+		transform.set_translation(Vector3f(
+			position.getX(), position.getY(), position.getZ()));
+		transform.set_rotation({ quaternion.getX(), quaternion.getY(),
+					 quaternion.getZ(), quaternion.getW() });
+	}
+
 	void move(const Vector3f &direction, float amount) noexcept
 	{
 		if (rigid_body) {
@@ -180,28 +209,37 @@ class Entity : public GameObject {
 		GameObject::input(delta);
 #ifdef MULTIPLAYER
 		if (player) {
-			if (m_action == 6)
-				m_moves.push({ m_action, { m_delta } });
-			// if (SharedGlobals::get_instance().get_tick() == 0)
-			{
-				EntityState state = get_entity_state();
-				m_moves.push(
-					{ 9, { state.position.x(),
-					       state.position.y(),
-					       state.position.z(),
-					       state.orientation.x(),
-					       state.orientation.y(),
-					       state.orientation.z(),
-					       state.orientation.w(),
-					       state.velocity.x(),
-					       state.velocity.y(),
-					       state.velocity.z(),
-					       state.angular_velocity.x(),
-					       state.angular_velocity.y(),
-					       state.angular_velocity.z() } });
+			if (m_action == 6) {
+				m_moves.try_push({ m_action, 1, { m_delta } });
+				m_sync.count_action();
 			}
+
+			EntityState state = get_entity_state();
+			Move sync = { Move::SYNC,
+				      Move::MAX_VALUES,
+				      { state.position.x(),
+					state.position.y(),
+					state.position.z(),
+					state.orientation.x(),
+					state.orientation.y(),
+					state.orientation.z(),
+					state.orientation.w(),
+					state.velocity.x(),
+					state.velocity.y(),
+					state.velocity.z(),
+					state.angular_velocity.x(),
+					state.angular_velocity.y(),
+					state.angular_velocity.z() },
+				      m_sync_tick };
+			if (m_sync.update(delta, to_sync_state(sync.values)) !=
+			    SyncPolicy::Trigger::NONE) {
+				m_moves.try_push(sync);
+			}
+			if (m_sync_stats)
+				report_sync(delta);
 			m_action = -1;
 			m_delta = 0;
+			m_sync_tick++;
 		}
 #endif
 	}
@@ -228,6 +266,11 @@ class Entity : public GameObject {
 		return max_hp;
 	}
 
+	float get_jump_cd() const noexcept
+	{
+		return jump_cd;
+	}
+
 	virtual void set_max_hp(float max_hp) noexcept
 	{
 		this->max_hp = max_hp;
@@ -245,7 +288,7 @@ class Entity : public GameObject {
 			btVector3(start.getX(), start.getY(), start.getZ()),
 			btVector3(end.getX(), end.getY(), end.getZ()));
 
-		SharedGlobals::get_instance().dynamics_world->rayTest(
+		world->dynamics_world->rayTest(
 			btVector3(start.getX(), start.getY(), start.getZ()),
 			btVector3(end.getX(), end.getY(), end.getZ()),
 			rayCallback);
@@ -331,6 +374,50 @@ class Entity : public GameObject {
 		m_delta = delta;
 	}
 
+#ifdef MULTIPLAYER
+	SyncPolicy::Settings load_sync_settings() const
+	{
+		Config &config = Config::get_instance();
+		SyncPolicy::Settings settings;
+		int32_t interval =
+			config.get_int("Sync", "interval", world->SYNC_TICK);
+		settings.interval = std::max(1, interval);
+		settings.position_threshold =
+			config.get_double("Sync", "position_threshold", 0.1);
+		settings.orientation_threshold = config.get_double(
+			"Sync", "orientation_threshold", 0.05);
+		settings.max_extrapolation = config.get_double(
+			"Interpolation", "max_extrapolation", 0.25);
+		return settings;
+	}
+
+	// Once a second, what made the player's state go out
+	void report_sync(float delta)
+	{
+		m_sync_stats_time += delta;
+		if (m_sync_stats_time < 1.0f)
+			return;
+
+		const SyncPolicy::Counters &counters = m_sync.get_counters();
+		std::cout << "Sync: interval " << counters.interval
+			  << " position " << counters.position
+			  << " orientation " << counters.orientation
+			  << " action " << counters.action << " skipped "
+			  << counters.skipped << "\r\n";
+		m_sync.reset_counters();
+		m_sync_stats_time = 0.0f;
+	}
+
+	// From the values of a SYNC
+	static InterpolationBuffer::State to_sync_state(const float *values)
+	{
+		return { { values[0], values[1], values[2] },
+			 { values[3], values[4], values[5], values[6] },
+			 { values[7], values[8], values[9] },
+			 { values[10], values[11], values[12] } };
+	}
+#endif
+
 	EntityState get_entity_state()
 	{
 		EntityState state;
@@ -370,6 +457,7 @@ class Entity : public GameObject {
 						      spawn_pos.getZ()));
 			transform.setRotation(btQuaternion(0, 0, 0, 1));
 			rigid_body->setWorldTransform(transform);
+			previous_transform = current_transform = transform;
 
 			this->transform.set_translation(spawn_pos);
 			this->transform.set_rotation({ 0, 0, 0, 1 });
@@ -380,8 +468,40 @@ class Entity : public GameObject {
 		on_ground = true;
 	}
 
+	// Gameplay state for World::save, the rigid body is saved by the world.
+	// Overrides append their own fields after calling this
+	virtual void save_state(WorldSnapshot &snapshot) const
+	{
+		snapshot.write(hp);
+		snapshot.write(rec_dmg);
+		snapshot.write(jump_cd);
+		snapshot.write(on_ground);
+		snapshot.write(m_action);
+		snapshot.write(m_delta);
+		World::save_transform(snapshot, previous_transform);
+		World::save_transform(snapshot, current_transform);
+	}
+
+	virtual void restore_state(WorldSnapshot::Reader &reader)
+	{
+		reader.read(hp);
+		reader.read(rec_dmg);
+		reader.read(jump_cd);
+		reader.read(on_ground);
+		reader.read(m_action);
+		reader.read(m_delta);
+		previous_transform = World::restore_transform(reader);
+		current_transform = World::restore_transform(reader);
+		apply_pose(1.0f);
+	}
+
 	const btRigidBody *get_rigid_body()
 	{
 		return rigid_body;
 	}
+
+	World &get_world() noexcept
+	{
+		return *world;
+	}
 };
@@ -18,6 +18,16 @@ class FollowComponent : public GameComponent {
 		, offset(offset) {};
 
 	void update(float delta) override
+	{
+		follow();
+	}
+
+	void interpolate(float alpha) override
+	{
+		follow();
+	}
+
+	void follow()
 	{
 		if (target != nullptr) {
 			get_parent_transform()->set_translation(
@@ -1,44 +1,100 @@
 #pragma once
 
 #include <graphics/Shader.h>
+#include <graphics/RenderSnapshot.h>
 
 #include <btBulletDynamicsCommon.h>
 
+#include <core/JobSystem.h>
 #include <core/SharedGlobals.h>
+#include <core/World.h>
+#include <components/Camera.h>
 #include <components/GameObject.h>
 
 #include <physics/Collision.h>
+
+#include <misc/Profiler.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * A game builds the same scene into one or more Worlds and ticks them in
+ * lockstep. The first world is the one presented; the others only exist
+ * in headless runs, where they serve as independent environments.
+ */
 class Game {
     private:
-	GameObject *root = nullptr;
+	std::vector<std::unique_ptr<World> > worlds;
 
     public:
-	~Game()
+	virtual ~Game() = default;
+
+	// Builds the scene of world, which is current on this thread
+	virtual void init(World &world) = 0;
+
+	// Runs before and after every tick of all worlds, on the calling
+	// thread, for work that has to see every world at once
+	virtual void begin_tick(float delta) {};
+	virtual void end_tick(float delta) {};
+
+	// Worlds are built one after another, seeded from seed
+	void create_worlds(int32_t count, uint32_t seed)
 	{
-		delete root;
+		for (int32_t i = 0; i < count; i++) {
+			worlds.push_back(std::make_unique<World>(seed + i));
+			World::Scope scope(*worlds.back());
+			init(*worlds.back());
+		}
 	}
 
-	virtual void init() = 0;
+	// Ticks every world once. With more than one, each world is a job so
+	// they step in parallel across the JobSystem workers
+	void tick(float delta)
+	{
+		static JobSystem &jobs = JobSystem::get_instance();
 
-	void input(float delta = 0)
+		begin_tick(delta);
+		if (worlds.size() == 1 || jobs.get_worker_count() == 0) {
+			for (std::unique_ptr<World> &world : worlds) {
+				tick_world(*world, delta);
+			}
+		} else {
+			PROFILE_SCOPE("Game::tick");
+			JobSystem::Counter counter;
+			for (size_t i = 1; i < worlds.size(); i++) {
+				World *world = worlds[i].get();
+				jobs.run([world,
+					  delta] { tick_world(*world, delta); },
+					 &counter);
+			}
+			tick_world(*worlds.front(), delta);
+			jobs.wait(counter);
+		}
+		end_tick(delta);
+	}
+
+	// Copies one saved state into every world, one job each, so rollouts
+	// can branch from a common state. Only between ticks
+	void restore_worlds(const WorldSnapshot &snapshot)
 	{
-#ifdef MULTIPLAYER
-		get_root_object()->input(1.0f / 60.0f);
-#else
-		get_root_object()->input(delta);
-#endif
-	};
+		static JobSystem &jobs = JobSystem::get_instance();
+
+		PROFILE_SCOPE("Game::restore_worlds");
+		JobSystem::Counter counter;
+		for (std::unique_ptr<World> &world : worlds) {
+			World *target = world.get();
+			jobs.run([target,
+				  &snapshot] { target->restore(snapshot); },
+				 &counter);
+		}
+		jobs.wait(counter);
+	}
 
-	void update(float delta = 0)
+	void interpolate(float alpha)
 	{
-		SharedGlobals &globals = SharedGlobals::get_instance();
-#ifdef MULTIPLAYER
-		globals.dynamics_world->stepSimulation(1.0f / 60.0f);
-		get_root_object()->update(1.0f / 60.0f);
-#else
-		globals.dynamics_world->stepSimulation(delta);
-		get_root_object()->update(delta);
-#endif
+		get_root_object()->interpolate(alpha);
 	};
 
 	void render(Shader &shader)
@@ -46,11 +102,48 @@ class Game {
 		get_root_object()->render(shader);
 	};
 
-	GameObject *get_root_object() noexcept
+	void snapshot(RenderSnapshot &snapshot)
 	{
-		if (root == nullptr) {
-			root = new GameObject();
-		}
-		return root;
+		SharedGlobals &globals = SharedGlobals::get_instance();
+		this->snapshot(snapshot, get_world(0),
+			       *static_cast<Camera *>(globals.main_camera));
+	};
+
+	// Any world seen through any camera in it, such as an agent's eyes
+	void snapshot(RenderSnapshot &snapshot, World &world, Camera &camera)
+	{
+		// A RenderThread snapshot comes back empty, this only frees
+		// handles of snapshots drawn on this thread
+		snapshot.clear();
+		snapshot.view_projection = camera.get_view_projection();
+		snapshot.eye_position = camera.get_parent_transform()
+						->get_transformed_position();
+		snapshot.ambient_light =
+			SharedGlobals::get_instance().active_ambient_light;
+		world.get_root()->add_to_snapshot(snapshot);
+	};
+
+	size_t get_world_count() const noexcept
+	{
+		return worlds.size();
+	}
+
+	World &get_world(size_t index)
+	{
+		return *worlds.at(index);
+	}
+
+	// Root of the presented world
+	GameObject *get_root_object()
+	{
+		return get_world(0).get_root();
+	}
+
+    private:
+	static void tick_world(World &world, float delta)
+	{
+		World::Scope scope(world);
+		world.input(delta);
+		world.update(delta);
 	}
 };
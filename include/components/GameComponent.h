@@ -16,10 +16,17 @@ class GameComponent {
 
 	virtual void reset() {};
 
+	// Called before rendering with the fraction of a tick that has elapsed
+	// since the last fixed update, for smoothing render-only state
+	virtual void interpolate(float alpha) {};
+
 	virtual ~GameComponent() = default;
 
 	virtual void add_to_rendering_engine(bool id = 0) {};
 
+	// Copies whatever the renderer needs from this component
+	virtual void add_to_snapshot(RenderSnapshot &snapshot) {};
+
 	Transform *get_parent_transform() const noexcept
 	{
 		return transform;
@@ -17,6 +17,24 @@ class GameObject {
 
 	std::vector<GameComponent *> components;
 
+	/*
+	 * Children marked parallel are updated as jobs on the JobSystem.
+	 * Consecutive parallel siblings form one batch which is joined before
+	 * the next serial sibling runs, so the serial traversal order is kept
+	 * everywhere except between the siblings of a batch.
+	 *
+	 * A parallel subtree must therefore not read or write the state of
+	 * its batch siblings. On the Bullet side it may only touch its own
+	 * rigid body; world queries (rayTest, contactTest), adding or
+	 * removing bodies and anything in World or SharedGlobals belong in
+	 * input(), which always runs serially within its world, or in a
+	 * serial subtree. GL calls such as Texture::load_texture must stay on
+	 * the main thread.
+	 */
+	bool parallel = false;
+
+	void update_children(float delta);
+
     public:
 	int32_t physics_type = 0; // default type no physics
 	~GameObject();
@@ -33,11 +51,19 @@ class GameObject {
 
 	virtual void reset();
 
+	virtual void interpolate(float alpha);
+
 	virtual void handle_collision(GameObject *obj) {};
 
 	GameObject *add_child(GameObject *obj);
 
 	GameObject *add_component(GameComponent *obj);
 
+	GameObject *set_parallel(bool parallel) noexcept;
+
+	bool is_parallel() const noexcept;
+
 	void add_to_rendering_engine();
+
+	virtual void add_to_snapshot(RenderSnapshot &snapshot);
 };
@@ -25,5 +25,7 @@ class MeshRenderer : public GameComponent {
 
 	void render(Shader &shader) override;
 
+	void add_to_snapshot(RenderSnapshot &snapshot) override;
+
 	Material &get_material();
 };
@@ -5,8 +5,6 @@
 #include <components/PointLight.h>
 #include <components/FollowComponent.h>
 
-#include <misc/SafeQueue.h>
-
 class PlayerEntity : public Entity {
     public:
 	PlayerEntity(const Vector3f &spawn_pos = DEFAULT_ENTITY_SPAWN_POS)
@@ -17,9 +15,12 @@ class PlayerEntity : public Entity {
 					->add_component(new PointLight(
 						"#def", 1.0f, { 0, 0, 0.02f }))
 					->add_component(new FollowComponent(
-						{ 0, -0.5, 10 }, &transform)));
+						{ 0, -0.5, 10 }, &transform))
+					->set_parallel(true));
+		this->set_parallel(true);
 		this->set_max_hp(100);
 		this->set_hp(this->get_max_hp());
+		update_material();
 	}
 
 	void input(float delta) override
@@ -54,31 +55,26 @@ class PlayerEntity : public Entity {
 			}
 		}
 		on_ground = false;
+		update_material();
 		Entity::input(delta);
 	}
 
-	void update(float delta) override
-	{
-		static Material &mat = mesh->get_material();
-		static int32_t old_stage = 4, new_stage = 4;
-		static const std::string diffuses[] = {
-			"./assets/objects/Main_model_0.png",
-			"./assets/objects/Main_model_25.png",
-			"./assets/objects/Main_model_50.png",
-			"./assets/objects/Main_model_75.png",
-			"./assets/objects/Main_model_100.png"
-		};
+    private:
+	int32_t damage_stage = 4;
 
-		float hp = this->hp * 100.0f / this->max_hp;
-		new_stage =
-			4 - (hp <= 75) - (hp <= 50) - (hp <= 25) - (hp <= 0);
+	// Runs from input() so that update() stays free of GL calls and the
+	// entity can be updated as a parallel job
+	void update_material()
+	{
+		// The first call, from the constructor, loads the textures
+		// while the GL context is still current on this thread
+		DamageTextures &diffuses = DamageTextures::get_instance();
+		int32_t stage = DamageTextures::get_stage(hp, max_hp);
 
-		if (new_stage != old_stage) {
-			old_stage = new_stage;
-			mat.add_property(
-				"diffuse",
-				Texture::load_texture(diffuses[new_stage]));
+		if (stage != damage_stage) {
+			damage_stage = stage;
+			mesh->get_material().add_property("diffuse",
+							  diffuses.get(stage));
 		}
-		Entity::update(delta);
 	}
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <btBulletDynamicsCommon.h>
+
+#include <components/GameComponent.h>
+
+#include <cstdint>
+#include <vector>
+
+class Entity;
+
+/*
+ * A horizontal fan of rays cast from an entity, for agents that need to
+ * see more than the player's position.
+ *
+ * Readings are two floats per ray, all distances first, then all types:
+ *
+ *	distance	hit distance / range, 1 when nothing was hit
+ *	type		0 nothing, 0.5 terrain (physics_type 10),
+ *			1 entity (physics_type 20)
+ *
+ * Rays are cast lazily, at most once per tick, when the readings are read.
+ * Instead of a rayTest walking the broadphase once per ray, the broadphase
+ * is queried once for everything within range, and every ray is then
+ * tested against the AABBs of those few objects before narrowphase, all
+ * through one reused result callback.
+ */
+class RaySensor : public GameComponent {
+	struct Candidate {
+		btCollisionObject *object;
+		btVector3 aabb_min, aabb_max;
+	};
+	struct CandidateCollector;
+
+	Entity &owner;
+	float range;
+	int32_t rays;
+	std::vector<btVector3> directions; // In the owner's frame
+	std::vector<Candidate> candidates;
+	std::vector<float> readings;
+	bool stale = true;
+
+	void cast();
+
+    public:
+	// fov in degrees, centered on the owner's forward
+	RaySensor(Entity &owner, int32_t rays, float fov, float range);
+
+	int32_t get_ray_count() const noexcept;
+
+	// 2 * get_ray_count() floats, see above
+	const std::vector<float> &get_readings();
+
+	void update(float delta) override;
+
+	void input(float delta) override {};
+	void render(Shader &) override {};
+};
@@ -18,6 +18,8 @@
 
 class Skybox : public GameObject {
 	Vector3f rotate_sens;
+	// Of the camera in the same world, which the skybox stays centred on
+	Transform *camera_transform = nullptr;
 
     public:
 	Skybox(const std::string &mesh_path, const std::string &texture_path,
@@ -38,6 +40,11 @@ class Skybox : public GameObject {
 		this->transform.set_scale(5);
 	}
 
+	void follow(Transform *camera_transform) noexcept
+	{
+		this->camera_transform = camera_transform;
+	}
+
 	void render(Shader &shader) override
 	{
 		Vector3f previous_ambient_light =
@@ -63,6 +70,15 @@ class Skybox : public GameObject {
 			previous_ambient_light;
 	}
 
+	void add_to_snapshot(RenderSnapshot &snapshot) override
+	{
+		size_t first = snapshot.draws.size();
+		GameObject::add_to_snapshot(snapshot);
+		for (size_t i = first; i < snapshot.draws.size(); i++) {
+			snapshot.draws[i].full_ambient = true;
+		}
+	}
+
 	void update(float delta) override
 	{
 		transform
@@ -73,12 +89,10 @@ class Skybox : public GameObject {
 			.rotate({ 0, 0, 1 },
 				to_radians(delta * rotate_sens.getZ()));
 
-		Transform *camera_transform =
-			static_cast<Camera *>(
-				SharedGlobals::get_instance().main_camera)
-				->get_parent_transform();
-
-		transform.set_translation(camera_transform->get_translation());
+		if (camera_transform != nullptr) {
+			transform.set_translation(
+				camera_transform->get_translation());
+		}
 		GameObject::update(delta);
 	}
 };
\ No newline at end of file
@@ -5,7 +5,7 @@
 #include <graphics/Texture.h>
 #include <graphics/Specular.h>
 
-#include <core/SharedGlobals.h>
+#include <core/World.h>
 #include <components/MeshRenderer.h>
 #include <components/GameObject.h>
 #include <components/GameComponent.h>
@@ -36,13 +36,12 @@ class Terrain : public GameObject {
 
 		this->add_component(new MeshRenderer(mesh, material));
 
-		if (SharedGlobals::get_instance().current_rigid_body) {
-			this->rigid_body =
-				SharedGlobals::get_instance().current_rigid_body;
+		World &world = World::current();
+		if (world.current_rigid_body) {
+			this->rigid_body = world.current_rigid_body;
 			rigid_body->setUserPointer(this);
 
-			SharedGlobals::get_instance().rigid_bodies.push_back(
-				rigid_body);
+			world.rigid_bodies.push_back(rigid_body);
 		}
 	}
 };
\ No newline at end of file
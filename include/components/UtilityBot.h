@@ -0,0 +1,85 @@
+#pragma once
+
+#include <components/GameComponent.h>
+
+#include <math/Vector3f.h>
+
+#include <cstdint>
+
+class Entity;
+class NavMesh;
+
+/*
+ * Built in AI for an enemy entity, for offline matches and headless
+ * stress tests with no agent process or policy attached.
+ *
+ * Every decision_ticks ticks each behaviour is scored from the distance to
+ * the player, the owner's hp and whether the player is in sight, and the
+ * best one is carried out every tick until the next decision:
+ *
+ *	chase	forward, the farther beyond range the player is
+ *	retreat	backward, the closer inside range and the lower the hp
+ *	strafe	sideways, while in sight around range, flipping side at
+ *		random so the bot is harder to hit
+ *	hold	nothing, the fallback
+ *
+ * The player is in sight when one Bullet ray from the owner reaches it
+ * first, cast on decision ticks only. In sight, within 2 * range and with
+ * the owner facing it, the bot shoots.
+ *
+ * With a NavMesh, chasing follows the first corner of the path to the
+ * player instead of a straight line, and moves that would leave the mesh
+ * are not made, a strafe turning to the other side instead.
+ *
+ * Past the first decision only new entries of the path cache allocate, so
+ * hundreds of bots cost a ray and a cached path query per decision.
+ */
+class UtilityBot : public GameComponent {
+    public:
+	enum class Behaviour : int32_t {
+		HOLD = 0,
+		CHASE = 1,
+		RETREAT = 2,
+		STRAFE = 3
+	};
+
+    private:
+	Entity &owner;
+	int32_t decision_ticks;
+	float range;
+	float strafe_flip;
+
+	const NavMesh *navmesh;
+
+	int32_t ticks_left; // Until the next decision
+	Behaviour behaviour = Behaviour::HOLD;
+	bool strafe_left = false;
+	bool in_sight = false;
+	bool has_waypoint = false;
+	Vector3f waypoint; // Next corner of the path to the player
+
+	bool has_line_of_sight(Entity &target);
+
+	void decide();
+
+	// Of forward, backward, left and right, the move heading closest to
+	// point
+	int32_t move_towards(const Vector3f &point) const;
+
+	bool stays_on_mesh(int32_t move) const;
+
+    public:
+	// range is the distance kept to the player, strafe_flip the chance
+	// of switching side at each decision. navmesh may be null
+	UtilityBot(Entity &owner, int32_t decision_ticks, float range,
+		   float strafe_flip, const NavMesh *navmesh = nullptr);
+
+	Behaviour get_behaviour() const noexcept;
+
+	bool get_in_sight() const noexcept;
+
+	void input(float delta) override;
+
+	void update(float delta) override {};
+	void render(Shader &) override {};
+};
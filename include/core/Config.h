@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+ * INI style settings shared by the engine, read from config.conf:
+ *
+ *	[Section]
+ *	key=value
+ *
+ * Command line flags override the file, either as "--Section.key=value"
+ * or through the shorthand "--headless" for "--Engine.headless=1".
+ */
+class Config {
+    public:
+	Config(const Config &) = delete;
+	Config &operator=(const Config &) = delete;
+
+	static Config &get_instance();
+
+    private:
+	std::unordered_map<std::string, std::string> values;
+
+	Config();
+
+	static std::string make_key(const std::string &section,
+				    const std::string &key);
+
+    public:
+	bool load(const std::string &config_file);
+
+	void parse_args(int argc, char const *argv[]);
+
+	void set(const std::string &section, const std::string &key,
+		 const std::string &value);
+
+	bool has(const std::string &section,
+		 const std::string &key) const noexcept;
+
+	std::string get_string(const std::string &section,
+			       const std::string &key,
+			       const std::string &fallback = "") const;
+
+	int32_t get_int(const std::string &section, const std::string &key,
+			int32_t fallback = 0) const;
+
+	double get_double(const std::string &section, const std::string &key,
+			  double fallback = 0.0) const;
+
+	bool get_bool(const std::string &section, const std::string &key,
+		      bool fallback = false) const;
+};
@@ -13,15 +13,41 @@ class Engine {
     private:
 	static bool created;
 
+	// Render rate, 0 leaves rendering uncapped
 	double FRAME_CAP = 60.0;
 
-	Window &window;
+	// Render rate while the window is unfocused, 0 disables throttling
+	double UNFOCUSED_FRAME_CAP = 15.0;
+
+	// Fixed simulation rate and the most ticks simulated per frame
+	double TICK_RATE = 60.0;
+	int32_t MAX_SUBSTEPS = 5;
+
+	// Independent worlds stepped in lockstep, more than one needs headless
+	int32_t worlds = 1;
+	// Seed of the first world, the others count up from it
+	uint32_t seed;
+
+	bool headless;
+	// Headless with an EGL context, for [Vision] pixel observations
+	bool offscreen;
+	// Draw snapshots on a dedicated thread instead of this one
+	bool render_thread;
+	// Print frame pacing error statistics once a second
+	bool pacing_stats;
+	// Chrome trace written by the profiler on F9 and at exit
+	std::string profile_output;
+	Window *window = nullptr;
 	Game *game;
 
 	bool running;
 
 	void run();
 
+	void run_headless();
+
+	void create_worlds();
+
     public:
 	Engine();
 
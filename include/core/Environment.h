@@ -0,0 +1,63 @@
+#pragma once
+
+#include <core/RLProtocol.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class TestGame;
+
+/*
+ * The headless worlds of the engine driven in process, by a caller that
+ * supplies the actions and reads back observations and rewards, instead of
+ * an agent on the other end of the socket bridge.
+ *
+ * Every world has [Agent] enemies agents, numbered world by world. All
+ * agents step in lockstep: step() starts a step of every agent and ticks
+ * until all of them ran [Agent] action_repeat ticks. The result of an
+ * agent's last step is read as a STEP payload, step_size() floats:
+ *
+ *	reward, terminated, truncated, then the observation
+ *
+ * Config, the JobSystem and the resource caches are process wide, so only
+ * one environment can exist at a time.
+ */
+class Environment {
+	static bool created;
+
+	std::unique_ptr<TestGame> game;
+	double tick_time;
+
+	// Ticks every world until all submitted steps are done
+	void run();
+
+    public:
+	// An action that resets its agent's world instead, keeping the reward
+	// mode. The other agents of that world start over with it
+	static constexpr int32_t RESET = -1;
+
+	// Reads config_file and then argv like the engine's command line,
+	// headless is implied
+	Environment(const std::string &config_file, int32_t argc,
+		    char const *argv[]);
+
+	Environment(const Environment &) = delete;
+	Environment &operator=(const Environment &) = delete;
+
+	~Environment();
+
+	size_t get_agent_count() const noexcept;
+
+	size_t get_step_size() const noexcept;
+
+	// Resets every world, reward_mode -1 keeps the current one
+	void reset(int32_t reward_mode = -1);
+
+	// One action per agent, in agent order
+	void step(const int32_t *actions, size_t count);
+
+	// Writes get_agent_count() * get_step_size() floats, in agent order
+	void observe(float *out) const;
+};
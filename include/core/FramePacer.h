@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/*
+ * Holds the main loop to a fixed frame rate without pinning a core.
+ *
+ * Frames are scheduled against absolute deadlines so sleep overshoot does
+ * not accumulate. The pacer sleeps until the spin time before the
+ * deadline and yields in a loop for the remainder, where the OS scheduler
+ * is too coarse to hit the deadline by sleeping.
+ *
+ * The error of every wake up against its deadline is recorded, positive
+ * when late, so frame time stability can be checked at runtime.
+ */
+class FramePacer {
+    public:
+	struct Stats {
+		int64_t frames = 0;
+		int64_t late_frames = 0; // Woke later than the spin time
+		double mean_error = 0.0; // Seconds, positive is late
+		double max_error = 0.0;
+		double min_error = 0.0;
+		double stddev_error = 0.0;
+	};
+
+	FramePacer(const FramePacer &) = delete;
+	FramePacer &operator=(const FramePacer &) = delete;
+
+	static FramePacer &get_instance();
+
+    private:
+	using clock = std::chrono::steady_clock;
+
+	double frame_time = 0.0;
+	double throttled_frame_time = 0.0;
+	double spin_time = 300e-6;
+
+	clock::time_point deadline;
+	bool scheduled = false;
+
+	// Welford running mean and variance of the wake up error
+	int64_t frames = 0, late_frames = 0;
+	double mean = 0.0, m2 = 0.0;
+	double max_error = 0.0, min_error = 0.0;
+
+	FramePacer();
+
+	void record(double error) noexcept;
+
+    public:
+	void set_frame_time(double frame_time) noexcept;
+
+	void set_throttled_frame_time(double frame_time) noexcept;
+
+	void set_spin_time(double spin_time) noexcept;
+
+	void reset() noexcept;
+
+	void wait(bool throttled = false);
+
+	Stats get_stats() const noexcept;
+
+	void reset_stats() noexcept;
+};
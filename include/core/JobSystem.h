@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Work-stealing job system shared by the engine.
+ *
+ * Every thread owns a deque: it pushes and pops its own jobs from the back
+ * and idle threads steal from the front of the others. The main thread is
+ * queue 0 and never sleeps inside the pool; instead wait() keeps executing
+ * queued jobs until the counter it waits on drops to zero.
+ *
+ * Counters are the only dependency primitive: run() increments the counter
+ * it is given and the job decrements it when done, so a parent job can fan
+ * out children and wait() on them before continuing.
+ */
+class JobSystem {
+    public:
+	using Job = std::function<void()>;
+
+	struct Counter {
+		std::atomic<int32_t> pending{ 0 };
+
+		bool done() const noexcept
+		{
+			return pending.load(std::memory_order_acquire) == 0;
+		}
+	};
+
+	JobSystem(const JobSystem &) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	static JobSystem &get_instance();
+
+    private:
+	struct WorkQueue {
+		std::deque<std::pair<Job, Counter *> > jobs;
+		std::mutex mutex;
+	};
+
+	std::vector<std::unique_ptr<WorkQueue> > queues;
+	std::vector<std::thread> workers;
+	std::atomic<bool> running = false;
+	std::atomic<int32_t> queued = 0;
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_cond;
+
+	static thread_local int32_t thread_index;
+
+	JobSystem();
+
+	bool pop(int32_t index, std::pair<Job, Counter *> &job);
+
+	bool steal(int32_t index, std::pair<Job, Counter *> &job);
+
+	bool try_execute();
+
+	void worker_loop(int32_t index);
+
+    public:
+	~JobSystem();
+
+	void init(int32_t worker_count);
+
+	void shutdown();
+
+	int32_t get_worker_count() const noexcept;
+
+	void run(Job job, Counter *counter = nullptr);
+
+	void wait(Counter &counter);
+};
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <vector>
+
+/*
+ * Messages exchanged with the RL agent over the socket bridge.
+ *
+ * Binary mode frames every message with a fixed 12 byte header followed by
+ * its payload, all little-endian and without padding:
+ *
+ *	uint32 magic	"GERL"
+ *	uint16 version
+ *	uint16 type	MessageType
+ *	uint32 length	payload bytes
+ *
+ *	STATE	17 x float32, laid out as AgentState, then uint32 agent
+ *	ACTION	int32 action, then optionally uint32 agent
+ *	RESET	no payload, int32 reward mode, or the mode and uint32 agent
+ *	STEP	uint32 agent, float32 reward, terminated, truncated, then the
+ *		observation as float32 up to the payload length
+ *	FRAME	uint16 width, height, channels, latency, then the pixels,
+ *		height rows top to bottom of width * channels bytes
+ *
+ * Agents are numbered world by world, see TestGame. Every reply names the
+ * agent it is for, and so should every command: one without an agent goes
+ * to the next agent in turn, which only suits agents that never skip one.
+ *
+ * STEP replaces STATE when [Agent] features is set, carrying the
+ * observation and reward the engine computed instead of the raw state.
+ * With [Vision] enabled the STEPs sent together are followed by the
+ * FRAMEs of the same worlds in the same order, latency being the readbacks
+ * the pixels lag behind the STEP. Frames only exist in binary mode.
+ *
+ * Text mode keeps the original comma separated strings in 2048 byte
+ * buffers for older agents.
+ */
+namespace RLProtocol {
+
+constexpr uint32_t MAGIC = 0x4c524547; // "GERL" on the wire
+constexpr uint16_t VERSION = 2;
+constexpr size_t HEADER_SIZE = 12;
+constexpr size_t TEXT_BUFFER_SIZE = 2048;
+constexpr size_t MAX_COMMAND_PAYLOAD = 16;
+
+enum class MessageType : uint16_t {
+	STATE = 1,
+	ACTION = 2,
+	RESET = 3,
+	STEP = 4,
+	FRAME = 5
+};
+
+struct Header {
+	uint32_t magic = MAGIC;
+	uint16_t version = VERSION;
+	MessageType type = MessageType::STATE;
+	uint32_t length = 0;
+};
+
+struct AgentState {
+	float enemy_hp = 0.0f;
+	float player_hp = 0.0f;
+	float enemy_position[3] = {};
+	float player_position[3] = {};
+	float shot_hit = 0.0f; // 1 when the last shot hit
+	float enemy_rotation[4] = {}; // w, x, y, z
+	float player_rotation[4] = {}; // w, x, y, z
+	uint32_t agent = 0;
+
+	static constexpr size_t FLOATS = 17;
+};
+static_assert(sizeof(AgentState) ==
+	      AgentState::FLOATS * sizeof(float) + sizeof(uint32_t));
+
+// See ObservationBuilder for the observation layout, its length depends on
+// the sensors configured
+struct AgentStep {
+	uint32_t agent = 0;
+	float reward = 0.0f;
+	float terminated = 0.0f; // 1 when the episode ended
+	float truncated = 0.0f; // 1 when it ran out of steps
+	std::vector<float> observation;
+};
+
+// Pixels are borrowed from the PixelObserver that read them back
+struct AgentFrame {
+	uint16_t width = 0;
+	uint16_t height = 0;
+	uint16_t channels = 0;
+	uint16_t latency = 0;
+	const uint8_t *pixels = nullptr;
+
+	size_t size() const noexcept
+	{
+		return size_t(width) * height * channels;
+	}
+};
+
+struct Command {
+	enum class Type {
+		NONE,
+		ACTION,
+		RESET
+	} type = Type::NONE;
+	int32_t action = -1; // Reward mode of a reset, -1 keeps the current
+	int32_t agent = -1; // -1 when the agent named none
+};
+
+inline void put_u32(uint8_t *out, uint32_t value) noexcept
+{
+	for (int32_t i = 0; i < 4; i++) {
+		out[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+}
+
+inline void put_f32(uint8_t *out, float value) noexcept
+{
+	put_u32(out, std::bit_cast<uint32_t>(value));
+}
+
+inline void put_u16(uint8_t *out, uint16_t value) noexcept
+{
+	out[0] = static_cast<uint8_t>(value);
+	out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline uint32_t get_u32(const uint8_t *in) noexcept
+{
+	return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 |
+	       uint32_t(in[3]) << 24;
+}
+
+inline uint16_t get_u16(const uint8_t *in) noexcept
+{
+	return uint16_t(in[0] | in[1] << 8);
+}
+
+inline void encode_header(uint8_t *out, const Header &header) noexcept
+{
+	put_u32(out, header.magic);
+	put_u16(out + 4, header.version);
+	put_u16(out + 6, static_cast<uint16_t>(header.type));
+	put_u32(out + 8, header.length);
+}
+
+inline Header decode_header(const uint8_t *in) noexcept
+{
+	Header header;
+	header.magic = get_u32(in);
+	header.version = get_u16(in + 4);
+	header.type = static_cast<MessageType>(get_u16(in + 6));
+	header.length = get_u32(in + 8);
+	return header;
+}
+
+inline size_t encoded_size(const AgentState &state) noexcept
+{
+	return HEADER_SIZE + 4 * (AgentState::FLOATS + 1);
+}
+
+inline size_t encoded_size(const AgentStep &step) noexcept
+{
+	return HEADER_SIZE + 4 * (4 + step.observation.size());
+}
+
+inline size_t encoded_size(const AgentFrame &frame) noexcept
+{
+	return HEADER_SIZE + 8 + frame.size();
+}
+
+// Out holds encoded_size(message) bytes, returns the bytes used
+inline size_t encode(uint8_t *out, const AgentState &state) noexcept
+{
+	constexpr uint32_t length = 4 * (AgentState::FLOATS + 1);
+	encode_header(out, { MAGIC, VERSION, MessageType::STATE, length });
+
+	float values[AgentState::FLOATS];
+	std::memcpy(values, &state, sizeof(values));
+	uint8_t *payload = out + HEADER_SIZE;
+	for (size_t i = 0; i < AgentState::FLOATS; i++) {
+		put_f32(payload + 4 * i, values[i]);
+	}
+	put_u32(payload + 4 * AgentState::FLOATS, state.agent);
+	return HEADER_SIZE + length;
+}
+
+inline size_t encode(uint8_t *out, const AgentStep &step) noexcept
+{
+	uint32_t length = 4 * (4 + step.observation.size());
+	encode_header(out, { MAGIC, VERSION, MessageType::STEP, length });
+
+	uint8_t *payload = out + HEADER_SIZE;
+	put_u32(payload, step.agent);
+	put_f32(payload + 4, step.reward);
+	put_f32(payload + 8, step.terminated);
+	put_f32(payload + 12, step.truncated);
+	for (size_t i = 0; i < step.observation.size(); i++) {
+		put_f32(payload + 16 + 4 * i, step.observation[i]);
+	}
+	return HEADER_SIZE + length;
+}
+
+inline size_t encode(uint8_t *out, const AgentFrame &frame) noexcept
+{
+	uint32_t length = 8 + frame.size();
+	encode_header(out, { MAGIC, VERSION, MessageType::FRAME, length });
+
+	uint8_t *payload = out + HEADER_SIZE;
+	put_u16(payload, frame.width);
+	put_u16(payload + 2, frame.height);
+	put_u16(payload + 4, frame.channels);
+	put_u16(payload + 6, frame.latency);
+	std::memcpy(payload + 8, frame.pixels, frame.size());
+	return HEADER_SIZE + length;
+}
+
+// Payload holds header.length bytes, at most MAX_COMMAND_PAYLOAD
+inline Command decode_command(const Header &header,
+			      const uint8_t *payload) noexcept
+{
+	Command command;
+	if (header.type == MessageType::RESET) {
+		command.type = Command::Type::RESET;
+	} else if (header.type == MessageType::ACTION && header.length >= 4) {
+		command.type = Command::Type::ACTION;
+	} else {
+		return command;
+	}
+	if (header.length >= 4)
+		command.action = static_cast<int32_t>(get_u32(payload));
+	if (header.length >= 8)
+		command.agent = static_cast<int32_t>(get_u32(payload + 4));
+	return command;
+}
+
+inline std::string to_text(const AgentState &state)
+{
+	auto join = [](const float *values, size_t count) {
+		std::string str;
+		for (size_t i = 0; i < count; i++) {
+			str += (i ? "," : "") + std::to_string(values[i]);
+		}
+		return str;
+	};
+
+	std::stringstream text;
+	text << state.enemy_hp << "," << state.player_hp << ","
+	     << join(state.enemy_position, 3) << ","
+	     << join(state.player_position, 3) << ","
+	     << (state.shot_hit != 0.0f ? "True" : "False") << ','
+	     << join(state.enemy_rotation, 4) << ','
+	     << join(state.player_rotation, 4) << ',' << state.agent;
+	return text.str();
+}
+
+// "step," then the agent and floats in the order of the binary payload
+inline std::string to_text(const AgentStep &step)
+{
+	std::string text = "step," + std::to_string(step.agent) + "," +
+			   std::to_string(step.reward) + "," +
+			   std::to_string(step.terminated) + "," +
+			   std::to_string(step.truncated);
+	for (float value : step.observation) {
+		text += "," + std::to_string(value);
+	}
+	return text;
+}
+
+// Only the shape, the text buffers are too small for the pixels
+inline std::string to_text(const AgentFrame &frame)
+{
+	return "frame," + std::to_string(frame.width) + "," +
+	       std::to_string(frame.height) + "," +
+	       std::to_string(frame.channels);
+}
+
+// "reset", "reset,<mode>", "reset,<mode>,<agent>", "action,<n>" or
+// "action,<n>,<agent>"
+inline Command from_text(const std::string &message)
+{
+	Command command;
+	if (message.find("reset") != std::string::npos) {
+		command.type = Command::Type::RESET;
+	} else if (message.find("action") != std::string::npos) {
+		command.type = Command::Type::ACTION;
+	} else {
+		return command;
+	}
+
+	std::stringstream ss(message);
+	std::string field;
+	std::getline(ss, field, ',');
+	if (std::getline(ss, field, ','))
+		command.action = std::atoi(field.c_str());
+	if (std::getline(ss, field, ','))
+		command.agent = std::atoi(field.c_str());
+	return command;
+}
+
+} // namespace RLProtocol
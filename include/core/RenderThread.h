@@ -0,0 +1,62 @@
+#pragma once
+
+#include <core/Window.h>
+
+#include <graphics/RenderSnapshot.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+/*
+ * Owns the GL context and draws the snapshots the game thread submits.
+ *
+ * Snapshots are double buffered: the game thread fills one while the other
+ * is being drawn, so simulating frame N+1 overlaps rendering frame N.
+ * submit() only blocks when the renderer is still busy with the frame
+ * before, which keeps the game at most one frame ahead.
+ *
+ * A snapshot may hold the last handle to a mesh or texture, so only this
+ * thread empties them: once drawn, and when it stops. Game::snapshot()
+ * then finds the write snapshot empty and frees nothing on the game thread.
+ */
+class RenderThread {
+    public:
+	RenderThread(const RenderThread &) = delete;
+	RenderThread &operator=(const RenderThread &) = delete;
+
+	static RenderThread &get_instance();
+
+    private:
+	RenderSnapshot snapshots[2];
+	int32_t write_index = 0;
+	int32_t pending_index = -1;
+	bool rendering = false;
+
+	Window *window = nullptr;
+	std::thread thread;
+	std::atomic<bool> running = false;
+	std::exception_ptr error;
+	std::mutex mutex;
+	std::condition_variable cond;
+
+	RenderThread();
+
+	void render_loop();
+
+    public:
+	~RenderThread();
+
+	void start(Window *window);
+
+	void stop();
+
+	bool is_running() const noexcept;
+
+	RenderSnapshot &get_write_snapshot() noexcept;
+
+	void submit();
+};
@@ -2,8 +2,6 @@
 
 #include <math/Vector3f.h>
 
-#include <btBulletDynamicsCommon.h>
-
 #include <unordered_set>
 
 class SharedGlobals {
@@ -16,33 +14,24 @@ class SharedGlobals {
     private:
 	SharedGlobals();
 	std::unordered_set<void *> lights;
-	uint8_t tick = 0;
 
     public:
-	btDiscreteDynamicsWorld *dynamics_world;
-	btAlignedObjectArray<btCollisionShape *> collision_shapes;
-	std::vector<btRigidBody *> rigid_bodies;
-	btRigidBody *current_rigid_body = nullptr;
-	const int32_t GRAVITY = 1.0f;
-
-	const int SYNC_TICK = 16;
+	// Physics, the scene and the entities live in World
 	Vector3f active_ambient_light;
 	void *active_light = nullptr;
 	void *main_camera = nullptr;
 	int32_t w_width = 1, w_height = 1;
 	bool resized = false;
+	bool headless = false; // No window, GL context or rendering
+	bool offscreen = false; // Headless, but with a GL context to render
 	void *window = nullptr;
-	static void *player_entity, *enemy_entity;
 
 	void add_to_lights(void *light) noexcept;
 	std::unordered_set<void *> &get_lights();
 	void clear_lights();
 
-	uint8_t get_tick();
-	void increment_tick();
-
 #ifdef MULTIPLAYER
-	void *enemy_moves = nullptr; // SafeQueue<pair<action, delta>>
-	void *player_moves = nullptr; // SafeQueue<pair<action, delta>>
+	void *enemy_moves = nullptr; // MoveQueue
+	void *player_moves = nullptr; // MoveQueue
 #endif
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Shared memory transport for the RL bridge, an alternative to the TCP
+ * stream for an agent on the same machine.
+ *
+ * The agent creates the segment and owns its lifetime, the engine maps it
+ * after the TCP rendezvous. It holds two single producer, single consumer
+ * rings of fixed size slots, one per direction, and every slot carries
+ * one binary RLProtocol message. Layout, shared with AI/protocol.py:
+ *
+ *	0	Segment header
+ *	64	to_agent ring	(engine -> agent, STATE / STEP / FRAME)
+ *	524480	to_engine ring	(agent -> engine, ACTION / RESET)
+ *
+ * A ring is head and the consumer's waiting flag on one cache line, tail
+ * and the producer's waiting flag on the next, then the slots. The head
+ * and tail counters only ever increase and are the futex words a blocked
+ * side sleeps on. Waiting spins briefly before sleeping so a lockstep
+ * agent is usually picked up without a syscall, and the producer only
+ * wakes when the other side announced it is asleep.
+ */
+class SharedMemoryChannel {
+    public:
+	static constexpr uint32_t MAGIC = 0x4d484547; // "GEHM"
+	static constexpr uint32_t VERSION = 3;
+	static constexpr uint32_t CAPACITY = 16;
+	// Fits a STEP with sensors, or an 84x84 RGB FRAME
+	static constexpr uint32_t SLOT_SIZE = 32768;
+
+	struct alignas(64) Ring {
+		std::atomic<uint32_t> head; // Written by the producer
+		std::atomic<uint32_t> consumer_waiting;
+		alignas(64) std::atomic<uint32_t> tail; // By the consumer
+		std::atomic<uint32_t> producer_waiting;
+		alignas(64) uint8_t slots[CAPACITY][SLOT_SIZE];
+	};
+
+	struct Segment {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t capacity;
+		uint32_t slot_size;
+		std::atomic<uint32_t> closed; // Set by either side on exit
+		Ring to_agent;
+		Ring to_engine;
+	};
+
+	SharedMemoryChannel(const SharedMemoryChannel &) = delete;
+	SharedMemoryChannel &operator=(const SharedMemoryChannel &) = delete;
+
+	SharedMemoryChannel();
+
+	~SharedMemoryChannel();
+
+	// Maps a segment created by the agent, liveness_fd is polled for a
+	// hang up while blocked so a crashed agent does not stall the engine
+	void open(const std::string &name, int32_t liveness_fd);
+
+	void close();
+
+	bool is_open() const noexcept;
+
+	void send(const uint8_t *message, size_t size);
+
+	// Blocks for the next message, returns its size
+	size_t receive(uint8_t *message, size_t capacity);
+
+	// Returns 0 when no message is waiting
+	size_t try_receive(uint8_t *message, size_t capacity);
+
+    private:
+	Segment *segment = nullptr;
+	int32_t liveness_fd = -1;
+
+	size_t pop(uint8_t *message, size_t capacity);
+
+	void wait(std::atomic<uint32_t> &word, std::atomic<uint32_t> &waiting,
+		  uint32_t value);
+
+	void check_alive();
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(offsetof(SharedMemoryChannel::Ring, tail) == 64);
+static_assert(offsetof(SharedMemoryChannel::Ring, slots) == 128);
+static_assert(offsetof(SharedMemoryChannel::Segment, to_agent) == 64);
+static_assert(offsetof(SharedMemoryChannel::Segment, to_engine) == 524480);
@@ -1,15 +1,25 @@
 #pragma once
 
+#include <core/Config.h>
+#include <core/RLProtocol.h>
+#include <core/SharedMemoryChannel.h>
+
 #include <string>
+#include <vector>
 #include <memory>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <cstring>
+#include <cstdint>
+#include <algorithm>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
+#include <cerrno>
 
 class SocketManager {
     public:
@@ -22,10 +32,148 @@ class SocketManager {
 		return instance;
 	}
 
+	enum class Protocol {
+		TEXT,
+		BINARY
+	};
+
+	// With SHM the socket is still connected, for the rendezvous and
+	// to notice the agent exiting
+	enum class Transport {
+		TCP,
+		SHM
+	};
+
 	void initialize(const std::string &config_file)
 	{
+		Config &config = Config::get_instance();
 		int32_t port = read_config(config_file);
+		protocol = config.get_string("Socket", "protocol", "binary") ==
+					   "text" ?
+				   Protocol::TEXT :
+				   Protocol::BINARY;
+		transport = config.get_string("Socket", "transport", "tcp") ==
+					    "shm" ?
+				    Transport::SHM :
+				    Transport::TCP;
 		create_socket(port);
+
+		if (transport == Transport::SHM) {
+			// Always binary framing, one message per slot
+			protocol = Protocol::BINARY;
+			open_shared_memory(port);
+		}
+	}
+
+	Transport get_transport() const noexcept
+	{
+		return transport;
+	}
+
+	Protocol get_protocol() const noexcept
+	{
+		return protocol;
+	}
+
+	// An AgentState or AgentStep
+	template <typename Message> void send_state(const Message &state)
+	{
+		if (protocol == Protocol::TEXT) {
+			send_data(RLProtocol::to_text(state));
+			return;
+		}
+
+		batch.resize(RLProtocol::encoded_size(state));
+		size_t size = RLProtocol::encode(batch.data(), state);
+		if (transport == Transport::SHM) {
+			channel.send(batch.data(), size);
+		} else {
+			send_bytes(batch.data(), size);
+		}
+	}
+
+	// One state per environment, written with a single call
+	template <typename Message>
+	void send_states(const std::vector<Message> &states)
+	{
+		if (protocol == Protocol::TEXT || transport == Transport::SHM) {
+			for (const Message &state : states) {
+				send_state(state);
+			}
+			return;
+		}
+
+		size_t size = 0;
+		for (const Message &state : states) {
+			size += RLProtocol::encoded_size(state);
+		}
+		batch.resize(size);
+
+		uint8_t *out = batch.data();
+		for (const Message &state : states) {
+			out += RLProtocol::encode(out, state);
+		}
+		send_bytes(batch.data(), batch.size());
+	}
+
+	// Blocks until the next command has arrived
+	RLProtocol::Command receive_command()
+	{
+		RLProtocol::Command command;
+		while (!poll_command(command, true)) {
+		}
+		return command;
+	}
+
+	// Returns false right away when no complete command has arrived yet
+	bool try_receive_command(RLProtocol::Command &command)
+	{
+		return poll_command(command, false);
+	}
+
+	// Sends exactly size bytes, retrying short writes
+	void send_bytes(const void *data, size_t size)
+	{
+		if (sock_fd == -1) {
+			throw std::runtime_error("Socket not initialized");
+		}
+
+		const uint8_t *bytes = static_cast<const uint8_t *>(data);
+		while (size > 0) {
+			ssize_t sent = send(sock_fd, bytes, size, MSG_NOSIGNAL);
+			if (sent < 0) {
+				if (errno == EINTR)
+					continue;
+				throw std::runtime_error("Failed to send data");
+			}
+			bytes += sent;
+			size -= sent;
+		}
+	}
+
+	// Blocks until exactly size bytes have arrived
+	void receive_bytes(void *data, size_t size)
+	{
+		if (sock_fd == -1) {
+			throw std::runtime_error("Socket not initialized");
+		}
+
+		uint8_t *bytes = static_cast<uint8_t *>(data);
+		while (size > 0) {
+			ssize_t received = recv(sock_fd, bytes, size, 0);
+			if (received < 0) {
+				if (errno == EINTR)
+					continue;
+				throw std::runtime_error(
+					"Failed to receive data");
+			}
+			if (received == 0) {
+				throw std::runtime_error(
+					"Connection closed by server");
+			}
+			bytes += received;
+			size -= received;
+		}
 	}
 
 	void send_data(const std::string &data)
@@ -35,7 +183,8 @@ class SocketManager {
 		}
 		try {
 			char buffer[2048] = { 0 };
-			strncpy(buffer, data.c_str(), data.size());
+			strncpy(buffer, data.c_str(),
+				std::min(data.size(), sizeof(buffer) - 1));
 			send(sock_fd, buffer, sizeof(buffer), 0) < 0;
 		} catch (std::exception) {
 			std::cout << "Error\r\n";
@@ -54,11 +203,14 @@ class SocketManager {
 		}
 
 		char buffer[2048] = { 0 };
-		size_t bytes_received = (size_t)recv(
-			sock_fd, buffer, sizeof(buffer), MSG_WAITALL);
+		ssize_t bytes_received =
+			recv(sock_fd, buffer, sizeof(buffer), MSG_WAITALL);
 		if (bytes_received < 0) {
 			throw std::runtime_error("Failed to receive data");
 		}
+		if (bytes_received == 0) {
+			throw std::runtime_error("Connection closed by server");
+		}
 
 		std::string message{ buffer, (size_t)bytes_received };
 		message.erase(std::remove(message.begin(), message.end(), '\0'),
@@ -70,9 +222,125 @@ class SocketManager {
     private:
 	int32_t sock_fd = -1;
 	sockaddr_in server_address;
+	Protocol protocol = Protocol::BINARY;
+	Transport transport = Transport::TCP;
+	SharedMemoryChannel channel;
+	std::vector<uint8_t> batch;
+	// Received bytes not yet decoded into commands
+	std::vector<uint8_t> inbox;
 
 	SocketManager() {};
 
+	// The agent names the segment after the port and writes a single
+	// byte once it is ready to be mapped
+	void open_shared_memory(int32_t port)
+	{
+		uint8_t ready;
+		receive_bytes(&ready, 1);
+		channel.open("/gameengine_rl_" + std::to_string(port),
+			     sock_fd);
+	}
+
+	bool poll_command(RLProtocol::Command &command, bool block)
+	{
+		if (transport == Transport::SHM)
+			return poll_shared_command(command, block);
+
+		if (take_command(command))
+			return true;
+		return fill_inbox(block) && take_command(command);
+	}
+
+	bool poll_shared_command(RLProtocol::Command &command, bool block)
+	{
+		uint8_t message[RLProtocol::HEADER_SIZE +
+				RLProtocol::MAX_COMMAND_PAYLOAD];
+		size_t size = block ? channel.receive(message, sizeof(message)) :
+				      channel.try_receive(message,
+							  sizeof(message));
+		if (size == 0)
+			return false;
+
+		RLProtocol::Header header = RLProtocol::decode_header(message);
+		if (header.magic != RLProtocol::MAGIC ||
+		    header.version != RLProtocol::VERSION ||
+		    size < RLProtocol::HEADER_SIZE + header.length) {
+			throw std::runtime_error("Unsupported agent message");
+		}
+		command = RLProtocol::decode_command(
+			header, message + RLProtocol::HEADER_SIZE);
+		return true;
+	}
+
+	// Decodes the first message in the inbox once it is complete
+	bool take_command(RLProtocol::Command &command)
+	{
+		if (protocol == Protocol::TEXT) {
+			if (inbox.size() < RLProtocol::TEXT_BUFFER_SIZE)
+				return false;
+
+			std::string message(inbox.begin(),
+					    inbox.begin() +
+						    RLProtocol::TEXT_BUFFER_SIZE);
+			message.erase(std::remove(message.begin(),
+						  message.end(), '\0'),
+				      message.end());
+			inbox.erase(inbox.begin(),
+				    inbox.begin() + RLProtocol::TEXT_BUFFER_SIZE);
+			command = RLProtocol::from_text(message);
+			return true;
+		}
+
+		if (inbox.size() < RLProtocol::HEADER_SIZE)
+			return false;
+
+		RLProtocol::Header header =
+			RLProtocol::decode_header(inbox.data());
+		if (header.magic != RLProtocol::MAGIC ||
+		    header.version != RLProtocol::VERSION) {
+			throw std::runtime_error("Unsupported agent message");
+		}
+		if (header.length > RLProtocol::MAX_COMMAND_PAYLOAD) {
+			throw std::runtime_error("Agent message too long");
+		}
+
+		size_t size = RLProtocol::HEADER_SIZE + header.length;
+		if (inbox.size() < size)
+			return false;
+
+		command = RLProtocol::decode_command(
+			header, inbox.data() + RLProtocol::HEADER_SIZE);
+		inbox.erase(inbox.begin(), inbox.begin() + size);
+		return true;
+	}
+
+	// Appends whatever has arrived, returns false if nothing had and
+	// block is off
+	bool fill_inbox(bool block)
+	{
+		if (sock_fd == -1) {
+			throw std::runtime_error("Socket not initialized");
+		}
+
+		uint8_t buffer[4096];
+		ssize_t received;
+		do {
+			received = recv(sock_fd, buffer, sizeof(buffer),
+					block ? 0 : MSG_DONTWAIT);
+		} while (received < 0 && errno == EINTR);
+
+		if (received < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return false;
+			throw std::runtime_error("Failed to receive data");
+		}
+		if (received == 0) {
+			throw std::runtime_error("Connection closed by server");
+		}
+		inbox.insert(inbox.end(), buffer, buffer + received);
+		return true;
+	}
+
 	void create_socket(int32_t port)
 	{
 		if ((sock_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
@@ -88,6 +356,11 @@ class SocketManager {
 			throw std::runtime_error("Connection to server failed");
 		}
 
+		// Every message is a complete request or reply, never batch
+		int32_t no_delay = 1;
+		setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay,
+			   sizeof(no_delay));
+
 		std::cout << "Connected to server on port " << port << "\r\n";
 	}
 
@@ -116,6 +389,7 @@ class SocketManager {
 
 	~SocketManager()
 	{
+		channel.close();
 		if (sock_fd != -1) {
 			close(sock_fd);
 		}
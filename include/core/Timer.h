@@ -17,14 +17,10 @@ class Timer {
 
 	double delta_time = 0.0;
 
-	double passed_time = 0.0;
-
     public:
 	void reset();
 
 	void update_delta_time() noexcept;
 
 	double get_delta_time() const noexcept;
-
-	bool can_render_frame(const double FRAME_TIME) noexcept;
 };
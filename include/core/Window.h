@@ -27,8 +27,14 @@ class Window {
 
 	bool set_window_context();
 
+	void make_context_current(bool current);
+
 	bool gl_create_window();
 
+	// A hidden window whose context renders through EGL, for headless
+	// runs that still draw. GLFW has to be on its null platform
+	bool gl_create_offscreen();
+
 	void terminate_window();
 
 	bool should_close();
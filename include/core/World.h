@@ -0,0 +1,103 @@
+#pragma once
+
+#include <btBulletDynamicsCommon.h>
+
+#include <core/WorldSnapshot.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class Entity;
+class GameObject;
+
+/*
+ * One independent simulation: its own Bullet world, scene graph, entity
+ * lookups, tick counter and random engine.
+ *
+ * Several worlds can live in one process and be stepped in lockstep, each
+ * as a job, since nothing a world touches while ticking is shared with
+ * another. Process wide presentation state (window, camera, lights) stays
+ * in SharedGlobals and belongs to the world being rendered.
+ *
+ * While a scene is being built, meshes and entities register their bodies
+ * with World::current(), set for the calling thread by a Scope. Objects
+ * keep a pointer to their world from then on and must not rely on the
+ * current world while ticking.
+ *
+ * The whole simulation state can be saved to a WorldSnapshot between ticks
+ * and restored into this or any other world built by the same init, which
+ * is how environments are reset and rollouts branched.
+ */
+class World {
+    public:
+	class Scope {
+		World *previous;
+
+	    public:
+		explicit Scope(World &world) noexcept;
+		~Scope();
+
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+	};
+
+	World(const World &) = delete;
+	World &operator=(const World &) = delete;
+
+	explicit World(uint32_t seed = std::random_device{}());
+
+	~World();
+
+	static World &current();
+
+    private:
+	btBroadphaseInterface *broadphase;
+	btDefaultCollisionConfiguration *collision_configuration;
+	btCollisionDispatcher *dispatcher;
+	btSequentialImpulseConstraintSolver *solver;
+
+	GameObject *root = nullptr;
+	uint8_t tick = 0;
+
+	static thread_local World *current_world;
+
+    public:
+	btDiscreteDynamicsWorld *dynamics_world;
+	btAlignedObjectArray<btCollisionShape *> collision_shapes;
+	std::vector<btRigidBody *> rigid_bodies;
+	btRigidBody *current_rigid_body = nullptr;
+
+	const int SYNC_TICK = 16;
+	Entity *player_entity = nullptr;
+	std::vector<Entity *> enemies; // In construction order
+	std::vector<Entity *> entities; // In construction order
+	// Gameplay randomness, seeded per world so runs can be reproduced
+	std::mt19937 rng;
+
+	GameObject *get_root() noexcept;
+
+	void input(float delta);
+
+	// Steps Bullet once by delta, then updates the scene
+	void update(float delta);
+
+	uint8_t get_tick() const noexcept;
+
+	// Tick counter, random engine, every non static body and every entity.
+	// Only valid between ticks
+	void save(WorldSnapshot &snapshot) const;
+
+	// Also drops Bullet's contact caches and resets the solver, so a
+	// restored world steps exactly like the one that was saved
+	void restore(const WorldSnapshot &snapshot);
+
+	// Bullet math types are not trivially copyable with SIMD enabled, these
+	// copy their scalars exactly
+	static void save_vector(WorldSnapshot &snapshot,
+				const btVector3 &vector);
+	static btVector3 restore_vector(WorldSnapshot::Reader &reader);
+	static void save_transform(WorldSnapshot &snapshot,
+				   const btTransform &transform);
+	static btTransform restore_transform(WorldSnapshot::Reader &reader);
+};
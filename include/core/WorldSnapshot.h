@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/*
+ * The simulation state of a World serialized into memory, see World::save.
+ *
+ * Values are appended as raw bytes in the order they are saved and read
+ * back in the same order, so a snapshot can only be restored into a world
+ * built by the same init. The buffer keeps its capacity across saves, so
+ * saving into the same snapshot again does not allocate.
+ */
+class WorldSnapshot {
+	std::vector<uint8_t> bytes;
+
+    public:
+	class Reader {
+		const WorldSnapshot &snapshot;
+		size_t offset = 0;
+
+	    public:
+		explicit Reader(const WorldSnapshot &snapshot) noexcept
+			: snapshot(snapshot)
+		{
+		}
+
+		template <typename T> void read(T &value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (offset + sizeof(T) > snapshot.bytes.size()) {
+				std::cerr << "Error: Snapshot does not match "
+					     "the world\r\n";
+				throw std::runtime_error(
+					"Snapshot does not match the world");
+			}
+			std::memcpy(&value, snapshot.bytes.data() + offset,
+				    sizeof(T));
+			offset += sizeof(T);
+		}
+
+		template <typename T> T read()
+		{
+			T value;
+			read(value);
+			return value;
+		}
+
+		bool done() const noexcept
+		{
+			return offset == snapshot.bytes.size();
+		}
+	};
+
+	template <typename T> void write(const T &value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		size_t offset = bytes.size();
+		bytes.resize(offset + sizeof(T));
+		std::memcpy(bytes.data() + offset, &value, sizeof(T));
+	}
+
+	void clear() noexcept
+	{
+		bytes.clear();
+	}
+
+	size_t size() const noexcept
+	{
+		return bytes.size();
+	}
+
+	bool empty() const noexcept
+	{
+		return bytes.empty();
+	}
+};
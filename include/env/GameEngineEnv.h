@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * C interface of libGameEngineEnv.so, the engine's headless worlds as an
+ * in-process environment, see core/Environment.h. AI/engine_env.py binds
+ * it through ctypes.
+ *
+ * Functions returning int32_t return 0 on success and -1 on failure, with
+ * the reason in env_last_error(). Buffers are owned by the caller.
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// As an action, resets the world of that agent instead
+#define ENV_RESET -1
+
+typedef struct GameEngineEnv GameEngineEnv;
+
+// Reads config_file, then argv like the engine's command line with argv[0]
+// skipped, e.g. "--Engine.worlds=8". Returns NULL on failure
+GameEngineEnv *env_create(const char *config_file, int32_t argc,
+			  const char **argv);
+
+void env_destroy(GameEngineEnv *env);
+
+// [Engine] worlds times [Agent] enemies, agents are numbered by world
+int32_t env_agent_count(const GameEngineEnv *env);
+
+// Floats per agent written by env_observe: reward, terminated, truncated,
+// then the observation
+int32_t env_step_size(const GameEngineEnv *env);
+
+// Resets every world, reward_mode -1 keeps the current one
+int32_t env_reset(GameEngineEnv *env, int32_t reward_mode);
+
+// n must be the agent count, actions in agent order
+int32_t env_step(GameEngineEnv *env, const int32_t *actions, int32_t n);
+
+// Writes env_agent_count() * env_step_size() floats, of the last step
+int32_t env_observe(const GameEngineEnv *env, float *buffer);
+
+// Of the last failure on this thread
+const char *env_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
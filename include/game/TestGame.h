@@ -1,9 +1,130 @@
 #pragma once
 
+#include <core/RLProtocol.h>
+
 #include <components/Game.h>
 
+#include <ai/MLP.h>
+#include <ai/NavMesh.h>
+#include <ai/ObservationBuilder.h>
+#include <ai/RewardEvaluator.h>
+
+#include <graphics/PixelObserver.h>
+#include <graphics/RenderSnapshot.h>
+
+#include <memory>
+#include <vector>
+
+class Camera;
+class EnemyEntity;
+class RaySensor;
+
 class TestGame : public Game {
     public:
-	TestGame();
-	void init() override;
+	// In process, commands come from and steps go to the caller, see
+	// Environment, instead of the socket agent
+	explicit TestGame(bool in_process = false);
+	void init(World &world) override;
+#ifndef MULTIPLAYER
+	void begin_tick(float delta) override;
+	void end_tick(float delta) override;
+
+	// Enemies of every world, agent i is enemy i % get_enemy_count() of
+	// world i / get_enemy_count()
+	size_t get_agent_count() const noexcept;
+
+	size_t get_enemy_count() const noexcept;
+
+	// Starts a step of agent, in process only
+	void submit(size_t agent, const RLProtocol::Command &command);
+
+	// True once every submitted step ran all of its ticks
+	bool steps_done() const noexcept;
+
+	// Of agent's last finished step
+	const RLProtocol::AgentStep &get_step(size_t agent) const;
+
+	size_t get_observation_size() const noexcept;
+
+    private:
+	bool in_process;
+	// Agent controlled enemies built into every world
+	int32_t enemy_count = 1;
+	// Ticks an agent action is applied for before its state is sent
+	int32_t action_repeat = 1;
+	// Wait for the agent every step instead of repeating the last action
+	bool blocking = true;
+	// Enemies act on their own UtilityBot, no agent or policy attached
+	bool bot = false;
+	int32_t bot_decision_ticks = 6;
+	float bot_range = 7.5f;
+	float bot_strafe_flip = 0.2f;
+	// Of the arena, shared by the bots of every world, when [NavMesh] file
+	std::unique_ptr<NavMesh> navmesh;
+	// Acts with an exported policy instead of the socket agent when set
+	std::unique_ptr<MLP> policy;
+	// Draw actions from the policy's distribution instead of the best one
+	bool sample = false;
+	// Send observations and rewards instead of the raw state
+	bool features = false;
+	// Rays of the enemy's sensor appended to the observation, 0 for none
+	int32_t sensor_rays = 0;
+	float sensor_fov = 120.0f;
+	float sensor_range = 30.0f;
+	// Pixels of the enemy's view follow every step, see PixelObserver
+	bool vision = false;
+	int32_t vision_width = 84;
+	int32_t vision_height = 84;
+	int32_t vision_channels = 3;
+	int32_t vision_ring = 2;
+	float vision_fov = 90.0f;
+
+	std::vector<int32_t> ticks_left; // Of the current step, per agent
+	size_t next_agent = 0; // Receives a command that names no agent
+	std::vector<RLProtocol::AgentState> states;
+	std::vector<RLProtocol::AgentStep> steps;
+	std::vector<RLProtocol::AgentStep> last_steps; // In process, per agent
+	std::vector<ObservationBuilder> observers; // Per agent
+	std::vector<RewardEvaluator> rewards;
+	std::vector<int32_t> last_actions;
+	std::vector<RaySensor *> sensors;
+	std::vector<Camera *> eyes; // On the enemy, per agent
+	std::unique_ptr<PixelObserver> pixels; // Made once there is a context
+	RenderSnapshot view;
+	std::vector<size_t> stepped; // Agents whose step ended this tick
+	// Policy inputs and logits of the agents acting this tick, one row each
+	std::vector<float> batch_inputs;
+	std::vector<float> batch_logits;
+	std::vector<RLProtocol::AgentFrame> frames;
+	// Each world as built, restored on a reset command
+	std::vector<WorldSnapshot> spawn_states;
+	// Steps of a world's other agents that a reset must not cancel
+	struct InFlight {
+		size_t agent;
+		RLProtocol::Command command;
+		int32_t action;
+	};
+	std::vector<InFlight> in_flight;
+
+	World &get_agent_world(size_t agent);
+
+	EnemyEntity *get_enemy(size_t agent);
+
+	// Per agent state, once every world is built
+	void prepare();
+
+	// Puts the world of agent back as built, for all of its agents
+	void reset_world(size_t agent, int32_t reward_mode);
+
+	// Applies command to the agent it names and starts its step
+	void receive_command(const RLProtocol::Command &command);
+
+	void apply_command(size_t agent, const RLProtocol::Command &command);
+
+	void act_with_policy();
+
+	RLProtocol::AgentStep observe(size_t agent);
+
+	void send_frames();
+#endif
 };
\ No newline at end of file
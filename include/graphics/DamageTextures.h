@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+/*
+ * Diffuse textures of the character model's damage stages, shared by the
+ * player and every enemy. Stage 0 is no health left, STAGES - 1 is full.
+ *
+ * Owned here instead of by the entities so that the GL textures go before
+ * the context does: Engine::cleanup() calls release() ahead of tearing
+ * down the window.
+ */
+class DamageTextures {
+    public:
+	static constexpr int32_t STAGES = 5;
+
+	DamageTextures(const DamageTextures &) = delete;
+	DamageTextures &operator=(const DamageTextures &) = delete;
+
+	static DamageTextures &get_instance();
+
+    private:
+	std::shared_ptr<void> diffuses[STAGES]; // Texture
+	bool loaded = false;
+
+	DamageTextures();
+
+    public:
+	// Stage of hp out of max_hp, in quarters
+	static int32_t get_stage(float hp, float max_hp) noexcept;
+
+	// Loads every stage on the first call, which needs a current context
+	const std::shared_ptr<void> &get(int32_t stage);
+
+	void release() noexcept;
+};
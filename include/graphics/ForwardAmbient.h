@@ -21,4 +21,8 @@ class ForwardAmbient : public Shader {
 
 	void update_uniforms(Transform *transform,
 			     const Material &material) override;
+
+	void update_uniforms(const RenderSnapshot &snapshot,
+			     const RenderSnapshot::Draw &draw,
+			     const RenderLight *light) override;
 };
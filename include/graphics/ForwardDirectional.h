@@ -26,6 +26,13 @@ class ForwardDirectional : public Shader {
 	void set_uniform(const std::string &uniform,
 			 const BaseLight &base_light) noexcept;
 
+	void set_uniform(const std::string &uniform,
+			 const RenderLight &light) noexcept;
+
 	void update_uniforms(Transform *transform,
 			     const Material &material) override;
+
+	void update_uniforms(const RenderSnapshot &snapshot,
+			     const RenderSnapshot::Draw &draw,
+			     const RenderLight *light) override;
 };
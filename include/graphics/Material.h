@@ -18,5 +18,8 @@ class Material {
 
 	void *get_property(const std::string &name) const noexcept;
 
+	std::shared_ptr<void>
+	get_shared_property(const std::string &name) const noexcept;
+
 	void delete_property(const std::string &name) noexcept;
 };
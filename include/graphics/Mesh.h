@@ -47,4 +47,10 @@ class Mesh {
 				      MeshPhysicsType::NO_PHYSICS);
 
 	static void pre_load(const std::string &file_path);
+
+	// Copies out the triangles the Bullet shape of file_path is built from,
+	// 3 floats per vertex and 3 indices per triangle
+	static void get_triangles(const std::string &file_path,
+				  std::vector<float> &positions,
+				  std::vector<int32_t> &indices);
 };
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <misc/glad.h>
+
+#include <graphics/RenderSnapshot.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Renders small views, one per agent, into an offscreen framebuffer and
+ * reads their pixels back without waiting on the GPU.
+ *
+ * The views are stacked vertically in one color and depth target, so a
+ * single glReadPixels copies all of them. The copy goes into the next of
+ * a ring of pixel pack buffers and returns at once; the CPU only maps a
+ * buffer once the ring comes back around to it, by which time its fence
+ * has usually signaled. The pixels handed out therefore lag the views
+ * rendered by ring size - 1 readbacks, none with a ring of 1, which then
+ * waits for the GPU every time.
+ *
+ * Frames are rows top to bottom of width * channels bytes, RGB, or
+ * luminance with 1 channel.
+ */
+class PixelObserver {
+	struct Readback {
+		GLuint buffer = 0;
+		GLsync fence = nullptr;
+	};
+
+	int32_t views, width, height, channels;
+	GLuint framebuffer = 0, color = 0, depth = 0;
+	std::vector<Readback> ring;
+	size_t next = 0; // Readback the next read() copies into
+	std::vector<uint8_t> frames; // views * get_frame_size() bytes
+
+	void unpack(const uint8_t *pixels);
+
+    public:
+	PixelObserver(int32_t views, int32_t width, int32_t height,
+		      int32_t channels, int32_t ring_size);
+
+	PixelObserver(const PixelObserver &) = delete;
+	PixelObserver &operator=(const PixelObserver &) = delete;
+
+	~PixelObserver();
+
+	// Draws snapshot into the region of view, camera and all come with it
+	void render(int32_t view, const RenderSnapshot &snapshot);
+
+	// Starts copying every view out, then takes the oldest copy in flight
+	void read();
+
+	const uint8_t *get_pixels(int32_t view) const noexcept;
+
+	size_t get_frame_size() const noexcept;
+
+	// Readbacks the pixels lag behind the rendered views
+	int32_t get_latency() const noexcept;
+
+	int32_t get_width() const noexcept;
+
+	int32_t get_height() const noexcept;
+
+	int32_t get_channels() const noexcept;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <math/Vector3f.h>
+#include <math/Matrix4f.h>
+
+#include <graphics/Mesh.h>
+#include <graphics/Specular.h>
+#include <graphics/Attenuation.h>
+
+#include <memory>
+#include <vector>
+
+class Shader;
+struct BaseLight;
+
+// Light parameters copied out of a BaseLight and its transform
+struct RenderLight {
+	Shader *shader = nullptr;
+	Vector3f color;
+	float intensity = 0.0f;
+	Attenuation attenuation;
+	float range = 0.0f;
+	float cutoff = 0.0f;
+	Vector3f position;
+	Vector3f direction;
+
+	RenderLight() = default;
+
+	explicit RenderLight(const BaseLight &light);
+};
+
+/*
+ * Everything the renderer needs to draw one frame, built on the game thread
+ * and read on the render thread without touching the scene graph.
+ *
+ * Meshes and textures are held by handle, so the GL objects stay alive for
+ * as long as a snapshot still refers to them.
+ */
+struct RenderSnapshot {
+	struct Draw {
+		Matrix4f world;
+		Mesh mesh;
+		std::shared_ptr<void> diffuse; // Texture
+		Specular specular;
+		bool full_ambient = false; // Skybox is always fully ambient lit
+	};
+
+	std::vector<Draw> draws;
+	std::vector<RenderLight> lights;
+
+	Matrix4f view_projection;
+	Vector3f eye_position;
+	Vector3f ambient_light;
+
+	void clear() noexcept
+	{
+		draws.clear();
+		lights.clear();
+	}
+};
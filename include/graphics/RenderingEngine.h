@@ -6,6 +6,11 @@
 
 #include <components/GameObject.h>
 
+#include <graphics/RenderSnapshot.h>
+
+#include <atomic>
+#include <cstdint>
+
 #include <vector>
 
 class RenderingEngine {
@@ -25,10 +30,28 @@ class RenderingEngine {
 
 	static void clear_screen();
 
+	// Resizes arrive on the event thread, which may not own the context
+	static std::atomic<bool> viewport_changed;
+	static std::atomic<int32_t> viewport_width, viewport_height;
+
+	static void apply_viewport();
+
+	void draw(const RenderSnapshot &snapshot);
+
 	RenderingEngine();
 
     public:
 	void input();
 
 	void render(GameObject *object);
+
+	void render(const RenderSnapshot &snapshot);
+
+	// Clears and draws only the given region of the bound framebuffer,
+	// for views rendered next to each other into one target. The window
+	// viewport is applied again on the next full render
+	void render(const RenderSnapshot &snapshot, int32_t x, int32_t y,
+		    int32_t width, int32_t height);
+
+	static void set_viewport(int32_t width, int32_t height) noexcept;
 };
@@ -11,6 +11,7 @@
 
 #include <graphics/Material.h>
 #include <graphics/Specular.h>
+#include <graphics/RenderSnapshot.h>
 #include <graphics/resource_management/ShaderResource.h>
 
 #include <string>
@@ -73,4 +74,10 @@ class Shader {
 
 	virtual void update_uniforms(Transform *transform,
 				     const Material &material) = 0;
+
+	// Same uniforms taken from a snapshot instead of the live scene, light
+	// is the one being drawn in a forward pass
+	virtual void update_uniforms(const RenderSnapshot &snapshot,
+				     const RenderSnapshot::Draw &draw,
+				     const RenderLight *light) = 0;
 };
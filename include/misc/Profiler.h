@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Scoped CPU profiler for the frame loop and startup.
+ *
+ *	PROFILE_SCOPE("name");	times the enclosing scope
+ *	PROFILE_FUNCTION();	same, named after the function
+ *	PROFILE_THREAD("name");	labels the calling thread in the trace
+ *	PROFILE_FRAME();	closes the frame on the main thread
+ *
+ * Scopes are appended to a buffer owned by the recording thread. At the end
+ * of every frame the buffers are collected into a ring of the most recent
+ * frames; everything recorded before the first frame is kept separately as
+ * startup. dump() writes startup and the ring as Chrome trace_event JSON,
+ * which chrome://tracing and Perfetto open directly.
+ *
+ * Recording is off until enabled at runtime. Building with
+ * PROFILER_DISABLED compiles every macro out.
+ */
+class Profiler {
+    public:
+	struct Event {
+		const char *name; // String literal, never copied
+		int64_t start, end; // Nanoseconds since the profiler started
+		uint32_t thread;
+	};
+
+	class Scope {
+		const char *name;
+		int64_t start;
+
+	    public:
+		explicit Scope(const char *name) noexcept;
+		~Scope();
+
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+	};
+
+	Profiler(const Profiler &) = delete;
+	Profiler &operator=(const Profiler &) = delete;
+
+	static Profiler &get_instance();
+
+    private:
+	struct ThreadBuffer {
+		uint32_t id;
+		std::string name;
+		std::mutex mutex;
+		std::vector<Event> events;
+	};
+
+	std::atomic<bool> enabled = false;
+	std::chrono::steady_clock::time_point epoch;
+
+	std::mutex mutex;
+	// Never shrinks, so a buffer outlives the thread that owns it
+	std::vector<std::unique_ptr<ThreadBuffer> > threads;
+
+	std::vector<Event> startup;
+	std::vector<std::vector<Event> > frames;
+	size_t frame_index = 0;
+
+	static thread_local ThreadBuffer *thread_buffer;
+
+	Profiler();
+
+	ThreadBuffer &get_thread_buffer();
+
+	void collect(std::vector<Event> &out);
+
+    public:
+	void configure(bool enabled, size_t frame_capacity);
+
+	bool is_enabled() const noexcept;
+
+	int64_t now() const noexcept;
+
+	void record(const char *name, int64_t start, int64_t end);
+
+	void set_thread_name(const std::string &name);
+
+	void end_startup();
+
+	void end_frame();
+
+	bool dump(const std::string &file_path);
+};
+
+#ifndef PROFILER_DISABLED
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_SCOPE(name) \
+	Profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD(name) Profiler::get_instance().set_thread_name(name)
+#define PROFILE_FRAME() Profiler::get_instance().end_frame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Bounded queue between exactly one producer and one consumer thread.
+ *
+ * try_push() and try_pop() are wait-free: each side owns one index, each
+ * on its own cache line, and keeps a cached copy of the other side's so
+ * it only touches the shared line when the queue looks full or empty.
+ * Items are copied into a fixed ring, T has to be trivially copyable, so
+ * nothing is allocated after construction.
+ *
+ * The consumer may sleep in wait_for_items() instead of spinning. It
+ * announces that with a flag the producer checks after every push, and
+ * only then does the producer pay for a wakeup, a futex on Linux.
+ */
+template <typename T, size_t Capacity> class SPSCQueue {
+	static_assert(std::is_trivially_copyable_v<T>,
+		      "SPSCQueue items are copied as plain bytes");
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+		      "SPSCQueue capacity must be a power of two");
+
+	static constexpr size_t CACHE_LINE = 64;
+
+	// Written by the consumer
+	alignas(CACHE_LINE) std::atomic<size_t> head = 0;
+	size_t cached_tail = 0;
+
+	// Written by the producer
+	alignas(CACHE_LINE) std::atomic<size_t> tail = 0;
+	size_t cached_head = 0;
+
+	alignas(CACHE_LINE) std::atomic<uint32_t> sleeping = 0;
+
+	alignas(CACHE_LINE) std::array<T, Capacity> items;
+
+	void wake()
+	{
+		sleeping.store(0, std::memory_order_relaxed);
+#ifdef __linux__
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(&sleeping),
+			FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+	}
+
+	void sleep(std::chrono::nanoseconds timeout)
+	{
+#ifdef __linux__
+		using std::chrono::duration_cast, std::chrono::seconds;
+		seconds whole = duration_cast<seconds>(timeout);
+		long nanos = (timeout - whole).count();
+		timespec time = { static_cast<time_t>(whole.count()), nanos };
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(&sleeping),
+			FUTEX_WAIT_PRIVATE, 1, &time, nullptr, 0);
+#else
+		std::this_thread::sleep_for(
+			std::min<std::chrono::nanoseconds>(
+				timeout, std::chrono::milliseconds(1)));
+#endif
+	}
+
+    public:
+	static constexpr size_t capacity() noexcept
+	{
+		return Capacity;
+	}
+
+	// Producer only, false when full
+	bool try_push(const T &item)
+	{
+		size_t next = tail.load(std::memory_order_relaxed);
+		if (next - cached_head == Capacity) {
+			cached_head = head.load(std::memory_order_acquire);
+			if (next - cached_head == Capacity)
+				return false;
+		}
+
+		items[next & (Capacity - 1)] = item;
+		// Ordered before the load of sleeping, against the consumer
+		// storing sleeping before it looks at tail
+		tail.store(next + 1, std::memory_order_seq_cst);
+		if (sleeping.load(std::memory_order_seq_cst))
+			wake();
+		return true;
+	}
+
+	// Consumer only, false when empty
+	bool try_pop(T &item)
+	{
+		size_t next = head.load(std::memory_order_relaxed);
+		if (next == cached_tail) {
+			cached_tail = tail.load(std::memory_order_acquire);
+			if (next == cached_tail)
+				return false;
+		}
+
+		item = items[next & (Capacity - 1)];
+		head.store(next + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only, sleeps until there is an item or timeout passes,
+	// true when there is one
+	bool wait_for_items(std::chrono::nanoseconds timeout)
+	{
+		if (!empty())
+			return true;
+
+		sleeping.store(1, std::memory_order_seq_cst);
+		if (tail.load(std::memory_order_seq_cst) ==
+		    head.load(std::memory_order_relaxed)) {
+			sleep(timeout);
+		}
+		sleeping.store(0, std::memory_order_relaxed);
+		return !empty();
+	}
+
+	// Consumer only
+	bool wait_pop(T &item, std::chrono::nanoseconds timeout)
+	{
+		return try_pop(item) ||
+		       (wait_for_items(timeout) && try_pop(item));
+	}
+
+	// Exact from the consumer, a snapshot from anywhere else
+	bool empty() const noexcept
+	{
+		return tail.load(std::memory_order_acquire) ==
+		       head.load(std::memory_order_acquire);
+	}
+
+	size_t size() const noexcept
+	{
+		return tail.load(std::memory_order_acquire) -
+		       head.load(std::memory_order_acquire);
+	}
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Writes values of 1 to 32 bits back to back into a byte buffer, least
+ * significant bit first, for messages where whole bytes per field would
+ * waste most of the link. Running past the buffer does not write, it only
+ * marks the writer as overflowed.
+ */
+class BitWriter {
+	uint8_t *buffer;
+	size_t capacity; // Bytes
+	size_t bit_count = 0;
+	bool overflowed = false;
+
+    public:
+	BitWriter(uint8_t *buffer, size_t capacity);
+
+	void write(uint32_t value, int32_t bits);
+
+	void write_bool(bool value);
+
+	// Bytes used so far, the last one padded with zero bits
+	size_t get_size() const noexcept;
+
+	bool is_overflowed() const noexcept;
+};
+
+/*
+ * Reads back what a BitWriter wrote. Reading past the end yields zero bits
+ * and marks the reader as overflowed, so a truncated message is detected
+ * once after decoding it instead of at every field.
+ */
+class BitReader {
+	const uint8_t *buffer;
+	size_t size; // Bytes
+	size_t bit_count = 0;
+	bool overflowed = false;
+
+    public:
+	BitReader(const uint8_t *buffer, size_t size);
+
+	uint32_t read(int32_t bits);
+
+	bool read_bool();
+
+	bool is_overflowed() const noexcept;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <math/Quaternion.h>
+#include <math/Vector3f.h>
+
+#include <cstdint>
+
+/*
+ * Shows a remote entity smoothly from the states its owner sends, however
+ * unevenly they arrive.
+ *
+ * States are pushed with the sender's time and kept in order. Each tick
+ * the local clock advances and the buffer is sampled delay seconds behind
+ * the newest time the sender is estimated to have reached, so that a state
+ * arriving up to delay late is still in the future when it is needed:
+ *
+ *	between two states	position and velocities are interpolated
+ *				linearly, orientation along the shortest arc
+ *	past the newest		dead reckoning from its velocities, for at most
+ *				max_extrapolation seconds, then holding still
+ *
+ * The sender's clock is tracked as an offset to the local one, following
+ * the arrival times slowly so jitter does not shake it.
+ *
+ * A state that arrives after its time was extrapolated over changes what
+ * was already shown. Instead of jumping, the difference becomes an error
+ * added on top of the samples that decays over correction_time seconds.
+ * Jumps beyond snap_distance, a respawn or a teleport, are shown as is.
+ */
+class InterpolationBuffer {
+    public:
+	struct State {
+		Vector3f position;
+		Quaternion orientation;
+		Vector3f velocity;
+		Vector3f angular_velocity;
+	};
+
+	struct Settings {
+		float delay = 0.1f;
+		float max_extrapolation = 0.25f;
+		float correction_time = 0.1f;
+		float snap_distance = 3.0f;
+	};
+
+	static constexpr int32_t CAPACITY = 64;
+
+    private:
+	struct Entry {
+		double time;
+		State state;
+	};
+
+	Settings settings;
+
+	Entry entries[CAPACITY];
+	int32_t first = 0;
+	int32_t count = 0;
+
+	double clock = 0.0; // Local, advanced by update()
+	double offset = 0.0; // Sender's clock minus the local one
+	bool synced = false;
+
+	bool has_shown = false;
+	double shown_time = 0.0; // Sender time last sampled
+	State shown_target; // Sample at shown_time, before the error
+	Vector3f position_error;
+	Quaternion rotation_error;
+
+	const Entry &at(int32_t index) const;
+
+	State sample(double time) const;
+
+	// Drops the entries no longer needed to sample at time or later
+	void trim(double time);
+
+    public:
+	explicit InterpolationBuffer(const Settings &settings);
+
+	// time is the sender's clock in seconds, states older than the newest
+	// are dropped
+	void push(double time, const State &state);
+
+	// Advances the local clock by delta and fills state with what to show
+	// now. False while nothing was pushed yet
+	bool update(float delta, State &state);
+
+	int32_t size() const noexcept;
+
+	// Dead reckoning, where state is predicted to be time seconds on
+	static State extrapolate(const State &state, float time);
+};
@@ -2,9 +2,16 @@
 
 #ifdef MULTIPLAYER
 
-#include <misc/SafeQueue.h>
+#include <multiplayer/Moves.h>
+#include <multiplayer/NetChannel.h>
+#include <multiplayer/SnapshotCodec.h>
+#include <multiplayer/Wire.h>
 
+#include <netinet/in.h>
+
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
 #include <cstdint>
 #include <thread>
@@ -24,11 +31,30 @@ class MatchMaking {
 	std::atomic<bool> match_running = false;
 	std::thread *player_thread = nullptr;
 
+	SnapshotCodec::Settings snapshot_settings;
+	// Latest snapshot sequence decoded from the enemy, to acknowledge,
+	// and acknowledged by the enemy, to delta encode against. -1 none
+	std::atomic<int32_t> snapshot_received = -1;
+	std::atomic<int32_t> snapshot_acked = -1;
+
+	// Over datagrams, state goes through channel, shared by both threads
+	bool datagrams = false;
+	int32_t datagram_sock = -1;
+	NetChannel channel;
+	std::mutex channel_mutex;
+	std::atomic<bool> peer_left = false;
+
 	std::map<std::string, std::string> get_opponents();
 	void sync_player_queue();
-	void
-	sync_enemy_queue(SafeQueue<std::pair<int32_t, std::vector<float> > >
-				 *enemy_queue);
+	void sync_enemy_queue(MoveQueue *enemy_queue);
+	bool open_datagrams(const sockaddr_in &server_addr);
+	bool agree_transport();
+	bool send_stream(const uint8_t *messages, size_t size);
+	bool send_packet(const uint8_t *unreliable, size_t size);
+	void send_match_end();
+	template <typename Callback>
+	void receive_datagrams(uint8_t *buffer, size_t capacity,
+			       Wire::Reader &reader, Callback &push);
 
     public:
 	~MatchMaking();
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <misc/SPSCQueue.h>
+
+#include <cstdint>
+
+/*
+ * One action of a networked player, passed between the game thread and the
+ * match's network threads by value. action is one of the agent actions, 0
+ * to 7, or SYNC carrying the full rigid body state in values:
+ *
+ *	position xyz, orientation xyzw, velocity xyz, angular velocity xyz
+ *
+ * and the tick of the sender it was taken at, counted from the entity's
+ * first, for the receiver to place it in time.
+ */
+struct Move {
+	static constexpr int32_t SYNC = 9;
+	static constexpr int32_t MAX_VALUES = 13;
+
+	int32_t action = -1;
+	int32_t count = 0; // Values used
+	float values[MAX_VALUES] = {};
+	uint32_t tick = 0; // Of a SYNC
+};
+
+// Pushed by one thread and popped by one other, a full queue drops the move
+using MoveQueue = SPSCQueue<Move, 256>;
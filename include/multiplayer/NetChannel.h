@@ -0,0 +1,127 @@
+#pragma once
+
+#include <multiplayer/Wire.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Sequencing and reliability over an unreliable datagram link, carrying
+ * Wire messages of two kinds:
+ *
+ *	unreliable	sent once, in the packet at hand, and dropped along with
+ *			it when it is lost or arrives after a newer one. For
+ *			state that the next tick replaces anyway
+ *	reliable	discrete events, repeated in every packet until one
+ *			carrying them is acknowledged and delivered once each,
+ *			in order
+ *
+ * Every packet, little-endian:
+ *
+ *	uint16 sequence
+ *	uint16 ack	newest sequence received from the peer
+ *	uint32 ack bits	bit i set when ack - 1 - i was received too
+ *	uint8 flags	bit 7 ack is valid, bits 0-6 reliable message count
+ *	uint16 first reliable id, when there are reliable messages
+ *	reliable messages, ids counting up from the first
+ *	unreliable messages to the end of the packet
+ *
+ * A packet older than the newest one received is stale and dropped whole,
+ * so unreliable state never goes back in time. Its reliable messages are
+ * not lost by that, the newer packet repeats every one not yet
+ * acknowledged when it was sent.
+ *
+ * Not thread safe, the owner serializes writing and reading packets.
+ */
+class NetChannel {
+    public:
+	static constexpr size_t MAX_PACKET_SIZE = 1200; // Below common MTUs
+	static constexpr size_t HEADER_SIZE = 9;
+	static constexpr int32_t MAX_RELIABLE = 64; // Unacknowledged
+
+    private:
+	struct Reliable {
+		uint8_t message[Wire::MAX_MESSAGE_SIZE];
+		size_t size;
+	};
+
+	struct Sent {
+		uint16_t sequence;
+		uint16_t reliable_end; // Id after the last reliable in it
+		bool valid = false;
+	};
+
+	static constexpr int32_t SENT_HISTORY = 256;
+
+	// Sending
+	uint16_t next_sequence = 0;
+	uint16_t oldest_reliable = 0; // Unacknowledged
+	uint16_t next_reliable = 0;
+	Reliable reliable[MAX_RELIABLE];
+	Sent sent[SENT_HISTORY];
+
+	// Receiving
+	bool has_received = false;
+	uint16_t newest_received = 0;
+	uint32_t received_bits = 0;
+	uint16_t next_delivered = 0; // Reliable id expected next
+
+	void acknowledge(uint16_t sequence);
+
+	// Validates packet and takes in its acks. Fills where its messages
+	// start. False when it is malformed or stale
+	bool accept(const uint8_t *packet, size_t size, size_t &offset,
+		    int32_t &reliable_count, uint16_t &first_reliable);
+
+    public:
+	// Length of the Wire message at offset of a buffer of size bytes, 0
+	// when it is cut off or malformed
+	static size_t message_size(const uint8_t *buffer, size_t size,
+				   size_t offset);
+
+	// Queues message for every packet until it is acknowledged. False
+	// when MAX_RELIABLE are waiting already
+	bool send_reliable(const uint8_t *message, size_t size);
+
+	bool has_unacknowledged() const noexcept;
+
+	// Writes the next packet into packet, MAX_PACKET_SIZE bytes: the
+	// header, the waiting reliable messages, and the Wire messages of
+	// unreliable that fit after them. Returns the packet size
+	size_t write_packet(const uint8_t *unreliable, size_t unreliable_size,
+			    uint8_t *packet);
+
+	// Calls on_message(message, size) for every new reliable message of
+	// packet, then for every unreliable one. False when packet is
+	// malformed or stale
+	template <typename Callback>
+	bool read_packet(const uint8_t *packet, size_t size,
+			 Callback &&on_message);
+};
+
+template <typename Callback>
+bool NetChannel::read_packet(const uint8_t *packet, size_t size,
+			     Callback &&on_message)
+{
+	size_t offset;
+	int32_t reliable_count;
+	uint16_t id;
+	if (!accept(packet, size, offset, reliable_count, id))
+		return false;
+
+	for (int32_t i = 0; i < reliable_count; i++, id++) {
+		size_t length = message_size(packet, size, offset);
+		// Older ones were delivered from an earlier packet
+		if (id == next_delivered) {
+			on_message(packet + offset, length);
+			next_delivered++;
+		}
+		offset += length;
+	}
+	while (offset < size) {
+		size_t length = message_size(packet, size, offset);
+		on_message(packet + offset, length);
+		offset += length;
+	}
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <multiplayer/InterpolationBuffer.h>
+
+#include <cstdint>
+
+/*
+ * Decides on which ticks the local player's state is worth sending.
+ *
+ * The sender runs the same dead reckoning as the receiving
+ * InterpolationBuffer from the last state it sent, and each tick compares
+ * that prediction with where the player really is:
+ *
+ *	interval	interval ticks passed since the last send, or
+ *			nothing was sent yet
+ *	position	the prediction is more than position_threshold off
+ *	orientation	or more than orientation_threshold radians off
+ *
+ * Any of these sends the state, otherwise the tick is skipped and the
+ * receiver keeps extrapolating correctly. Discrete actions are not
+ * predicted and always go out at once, they are only counted here.
+ *
+ * Counters of each trigger are kept until reset_counters(), for judging
+ * the thresholds against the traffic they save.
+ */
+class SyncPolicy {
+    public:
+	enum class Trigger : int32_t {
+		NONE = 0,
+		INTERVAL = 1,
+		POSITION = 2,
+		ORIENTATION = 3
+	};
+
+	struct Settings {
+		int32_t interval = 16; // Ticks
+		float position_threshold = 0.1f;
+		float orientation_threshold = 0.05f;
+		// The receiver's, dead reckoning holds still after it
+		float max_extrapolation = 0.25f;
+	};
+
+	struct Counters {
+		uint64_t interval = 0;
+		uint64_t position = 0;
+		uint64_t orientation = 0;
+		uint64_t action = 0;
+		uint64_t skipped = 0; // Ticks nothing was sent on
+	};
+
+    private:
+	Settings settings;
+	Counters counters;
+
+	bool has_sent = false;
+	InterpolationBuffer::State sent; // Last state sent
+	int32_t ticks = 0; // Since sent
+
+    public:
+	explicit SyncPolicy(const Settings &settings);
+
+	// Once a tick of length delta with the current state, which is taken
+	// as sent unless NONE is returned
+	Trigger update(float delta, const InterpolationBuffer::State &state);
+
+	// A discrete action was sent
+	void count_action() noexcept;
+
+	const Counters &get_counters() const noexcept;
+
+	void reset_counters() noexcept;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <multiplayer/Moves.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Binary framing of moves on the match connection, shared with
+ * server/server.py. Every message is a little-endian header and payload:
+ *
+ *	uint16 length	bytes after this field, the type included
+ *	uint8 type
+ *	payload
+ *
+ * with one message type per kind of move or event:
+ *
+ *	ACTION		uint8 action, float32 value, a move, turn or jump
+ *	STATE		uint32 tick, float32 x 13, a Move::SYNC as is
+ *	SHOT		nothing
+ *	SNAPSHOT	a Move::SYNC packed by SnapshotCodec
+ *	ACK		uint16 sequence of a decoded SNAPSHOT
+ *	MATCH_END	nothing, the peer left the match
+ *	TRANSPORT	uint8 1 for datagrams, 0 for the stream, asked for by
+ *			each client after the handshake and decided by the
+ *			relay, see MatchMaking::agree_transport()
+ *
+ * Floats are sent as their IEEE 754 bits, so a STATE arrives exactly as it
+ * was sent. A reader skips message types it does not know by their length.
+ */
+class Wire {
+    public:
+	enum class MessageType : uint8_t {
+		ACTION = 1,
+		STATE = 2,
+		SHOT = 3,
+		SNAPSHOT = 4,
+		ACK = 5,
+		MATCH_END = 6,
+		TRANSPORT = 7
+	};
+
+	static constexpr size_t LENGTH_SIZE = 2;
+	static constexpr size_t HEADER_SIZE = LENGTH_SIZE + 1;
+	static constexpr size_t MAX_PAYLOAD_SIZE =
+		sizeof(uint32_t) + Move::MAX_VALUES * sizeof(float);
+	static constexpr size_t MAX_MESSAGE_SIZE =
+		HEADER_SIZE + MAX_PAYLOAD_SIZE;
+
+	// Writes the header of a message whose payload_size bytes follow it.
+	// Returns the size of the whole message
+	static size_t write_header(MessageType type, size_t payload_size,
+				   uint8_t *buffer);
+
+	static MessageType get_type(const uint8_t *message) noexcept;
+
+	// Writes move as one message into buffer, which must have room for
+	// MAX_MESSAGE_SIZE bytes. Returns the bytes written, 0 for a move
+	// with no message
+	static size_t encode(const Move &move, uint8_t *buffer);
+
+	// Reads the message of size bytes, header included, into move. False
+	// for a type that is not a move or a payload of the wrong size
+	static bool decode(const uint8_t *message, size_t size, Move &move);
+
+	static size_t encode_ack(uint16_t sequence, uint8_t *buffer);
+
+	static bool decode_ack(const uint8_t *message, size_t size,
+			       uint16_t &sequence);
+
+	static size_t encode_transport(bool datagrams, uint8_t *buffer);
+
+	static bool decode_transport(const uint8_t *message, size_t size,
+				     bool &datagrams);
+
+	// Splits a byte stream into messages, however it was cut up by the
+	// socket
+	class Reader {
+		uint8_t pending[MAX_MESSAGE_SIZE];
+		size_t pending_size = 0;
+		size_t message_size = 0; // Of the message in pending, 0 unknown
+		bool corrupt = false;
+
+	    public:
+		// Calls on_message(message, size) for every message completed
+		// by data, header included. False once the stream announced a
+		// message longer than any this side knows, after which it
+		// cannot be followed
+		template <typename Callback>
+		bool feed(const uint8_t *data, size_t size,
+			  Callback &&on_message);
+	};
+};
+
+template <typename Callback>
+bool Wire::Reader::feed(const uint8_t *data, size_t size,
+			Callback &&on_message)
+{
+	while (size && !corrupt) {
+		size_t wanted = message_size ? message_size : LENGTH_SIZE;
+		size_t count = wanted - pending_size;
+		if (count > size)
+			count = size;
+		for (size_t i = 0; i < count; i++) {
+			pending[pending_size++] = data[i];
+		}
+		data += count;
+		size -= count;
+
+		if (pending_size < wanted)
+			break;
+
+		if (!message_size) {
+			message_size = LENGTH_SIZE +
+				       (pending[0] | (size_t(pending[1]) << 8));
+			if (message_size < HEADER_SIZE ||
+			    message_size > MAX_MESSAGE_SIZE) {
+				corrupt = true;
+			}
+			continue;
+		}
+
+		on_message(static_cast<const uint8_t *>(pending), pending_size);
+		pending_size = 0;
+		message_size = 0;
+	}
+	return !corrupt;
+}
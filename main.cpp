@@ -2,11 +2,13 @@
 #include <GLFW/glfw3.h>
 
 #include <core/Engine.h>
+#include <core/Config.h>
 #include <graphics/Shader.h>
 
 #include <csignal>
 #include <cstdlib>
 #include <iostream>
+#include <exception>
 
 #ifdef MULTIPLAYER
 
@@ -39,6 +41,10 @@ void setup_signal_handlers()
 int main(int argc, char const *argv[])
 {
 	setup_signal_handlers();
+	Config &config = Config::get_instance();
+	config.load("config.conf");
+	config.parse_args(argc, argv);
+	bool headless = config.get_bool("Engine", "headless");
 #ifdef MULTIPLAYER
 	MatchMaking &MM = MatchMaking::get_instance();
 	if (MM.init(argc, argv)) {
@@ -50,10 +56,16 @@ int main(int argc, char const *argv[])
 
 	if (MM.is_success()) {
 #endif
-		glfwInit();
-		Engine engine;
-		engine.start();
-		glfwTerminate();
+		if (!headless)
+			glfwInit();
+		try {
+			Engine engine;
+			engine.start();
+		} catch (const std::exception &e) {
+			std::cerr << "Engine stopped: " << e.what() << "\n";
+		}
+		if (!headless)
+			glfwTerminate();
 
 #ifdef MULTIPLAYER
 	}
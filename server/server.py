@@ -5,6 +5,7 @@ import random
 import json
 import socket
 import select
+import struct
 import time
 import requests
 
@@ -19,33 +20,147 @@ sock.bind((HOST, HOST_PORT))
 sock.listen(5)
 
 RUNNING = True
-MSG_LEN = 129
+RECV_SIZE = 4096
 
+# Framing of moves, as in include/multiplayer/Wire.h: a little-endian uint16
+# length of what follows it, a uint8 message type, then the payload
+LENGTH = struct.Struct("<H")
+MSG_ACTION = 1  # uint8 action, float32 value
+MSG_STATE = 2  # uint32 tick, float32 x 13
+MSG_SHOT = 3  # no payload
+MSG_SNAPSHOT = 4  # bit packed state, see include/multiplayer/SnapshotCodec.h
+MSG_ACK = 5  # uint16 sequence of a decoded snapshot
+MSG_MATCH_END = 6  # no payload
+MSG_TRANSPORT = 7  # uint8 1 for datagrams, 0 for the stream
+MAX_MSG_LEN = LENGTH.size + 1 + 4 + 13 * 4
 
-def play(conns: Dict[str, socket.socket], RUNNING: List[bool]):
+# UDP mode: after START each client asks for a transport with a TRANSPORT
+# message, and when it wants datagrams sends HELLO followed by its player id
+# from the socket it will use. Both are answered with the same TRANSPORT,
+# datagrams only when both asked for them and both HELLOs arrived within
+# HELLO_TIMEOUT, so the two never end up on different transports. Datagrams
+# from a registered address are then relayed to the other player as they
+# are, sequencing and reliability are up to the clients (NetChannel)
+HELLO = b"HELLO\0"
+HELLO_TIMEOUT = 2.0
+MAX_DATAGRAM = 2048
+
+
+def split_messages(pending: bytearray) -> List[bytes]:
+    """Removes the complete messages at the front of pending and returns them.
+    Raises ValueError when the stream can no longer be followed."""
+    messages = []
+    while len(pending) >= LENGTH.size:
+        (length,) = LENGTH.unpack_from(pending)
+        size = LENGTH.size + length
+        if length < 1 or size > MAX_MSG_LEN:
+            raise ValueError(f"bad message length {length}")
+        if len(pending) < size:
+            break
+        messages.append(bytes(pending[:size]))
+        del pending[:size]
+    return messages
+
+
+def relay_datagram(
+    udp_sock: socket.socket,
+    ids: Dict[str, str],
+    addrs: Dict[str, tuple],
+    relaying: bool,
+):
+    data, addr = udp_sock.recvfrom(MAX_DATAGRAM)
+    if data.startswith(HELLO):
+        key = ids.get(data[len(HELLO) :].decode(errors="replace"))
+        if key is not None:
+            addrs[key] = addr
+        return
+
+    # Until both players were told to use datagrams, there is no one to
+    # relay them to
+    if not relaying:
+        return
+    sender = next((key for key, known in addrs.items() if known == addr), None)
+    if sender is None:
+        return
+    target = "player2_id" if sender == "player1_id" else "player1_id"
+    if target in addrs:
+        udp_sock.sendto(data, addrs[target])
+
+
+def take_transport_requests(
+    messages: List[bytes], key: str, wants: Dict[str, bool]
+) -> List[bytes]:
+    """Records the transport key asked for in wants and returns the messages
+    to relay, which are all the others."""
+    relayed = []
+    for message in messages:
+        if message[LENGTH.size] != MSG_TRANSPORT:
+            relayed.append(message)
+        elif len(message) == LENGTH.size + 2:
+            wants[key] = message[-1] == 1
+    return relayed
+
+
+def play(
+    conns: Dict[str, socket.socket],
+    RUNNING: List[bool],
+    ids: Dict[str, str],
+    udp_sock: socket.socket,
+):
     conn1, conn2 = conns.values()
+    keys = {conn: key for key, conn in conns.items()}
+    pending = {conn1: bytearray(), conn2: bytearray()}
+    addrs: Dict[str, tuple] = {}
+    wants: Dict[str, bool] = {}
+    datagrams = None  # Until both players asked for a transport
+    hello_deadline = None
 
     try:
         conn1.setblocking(False)
         conn2.setblocking(False)
 
         while RUNNING[0]:
-            ready_sockets, _, _ = select.select(conns.values(), [], [], 0.5)
+            ready_sockets, _, _ = select.select(
+                [conn1, conn2, udp_sock], [], [], 0.5
+            )
 
             for sock in ready_sockets:
                 try:
-                    data = sock.recv(MSG_LEN)
-                    print(data)
+                    if sock is udp_sock:
+                        relay_datagram(udp_sock, ids, addrs, datagrams is True)
+                        continue
+
+                    data = sock.recv(RECV_SIZE)
                     if not data:
                         print("Connection closed by client.")
                         return
 
-                    target_conn = conn2 if sock is conn1 else conn1
-                    target_conn.send(data)
+                    # Only whole messages are relayed, so the other client
+                    # never waits on half of one
+                    pending[sock] += data
+                    messages = take_transport_requests(
+                        split_messages(pending[sock]), keys[sock], wants
+                    )
+                    if messages:
+                        target_conn = conn2 if sock is conn1 else conn1
+                        target_conn.sendall(b"".join(messages))
 
                 except socket.error as e:
                     print(f"Play:\t\tSocket error: {e}")
                     raise e
+
+            # Both players get the same answer, so that neither listens
+            # for datagrams the other never sends
+            if datagrams is None and len(wants) == 2:
+                if hello_deadline is None:
+                    hello_deadline = time.time() + HELLO_TIMEOUT
+                both = all(wants.values())
+                if not both or len(addrs) == 2 or time.time() >= hello_deadline:
+                    datagrams = both and len(addrs) == 2
+                    answer = LENGTH.pack(2) + bytes([MSG_TRANSPORT, datagrams])
+                    conn1.sendall(answer)
+                    conn2.sendall(answer)
+                    print("Play:\t\tTransport:", "udp" if datagrams else "tcp")
     except Exception as e:
         print("Play:\t\tError:", e)
     finally:
@@ -63,6 +178,9 @@ def match(player1_id: str, player2_id: str, port: int):
     play_sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
     play_sock.bind((HOST, port))
     play_sock.listen(2)
+    udp_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    udp_sock.bind((HOST, port))
+    udp_sock.setblocking(False)
     conns = {}
     start_time = time.time()
 
@@ -97,7 +215,8 @@ def match(player1_id: str, player2_id: str, port: int):
                 f"Match Server:\tMatch started between {player1_id} and {player2_id} on port {port}"
             )
 
-            play(conns, RUNNING)
+            ids = {player1_id: "player1_id", player2_id: "player2_id"}
+            play(conns, RUNNING, ids, udp_sock)
             print(f"Match Server:\tMatch ended for {player1_id} vs {player2_id}")
 
     except Exception as e:
@@ -105,6 +224,7 @@ def match(player1_id: str, player2_id: str, port: int):
 
     finally:
         play_sock.close()
+        udp_sock.close()
         ACTIVE_PORTS.discard(port)
         print(f"Match Server:\tServer on port {port} closed")
 
@@ -0,0 +1,348 @@
+#include <ai/MLP.h>
+
+#include <misc/Profiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MLP_X86 1
+#endif
+
+// output[o] = dot(weights[o], input) + bias[o], rows and input padded to 8
+using DenseKernel = void (*)(const float *weights, const float *bias,
+			     const float *input, float *output,
+			     int32_t outputs, int32_t stride);
+
+static void dense_scalar(const float *weights, const float *bias,
+			 const float *input, float *output, int32_t outputs,
+			 int32_t stride)
+{
+	for (int32_t o = 0; o < outputs; o++) {
+		const float *row = weights + o * stride;
+		float sum = 0.0f;
+		for (int32_t i = 0; i < stride; i++) {
+			sum += row[i] * input[i];
+		}
+		output[o] = sum + bias[o];
+	}
+}
+
+#ifdef MLP_X86
+__attribute__((target("sse3"))) static void
+dense_sse(const float *weights, const float *bias, const float *input,
+	  float *output, int32_t outputs, int32_t stride)
+{
+	for (int32_t o = 0; o < outputs; o++) {
+		const float *row = weights + o * stride;
+		__m128 sum0 = _mm_setzero_ps();
+		__m128 sum1 = _mm_setzero_ps();
+		for (int32_t i = 0; i < stride; i += 8) {
+			sum0 = _mm_add_ps(sum0,
+					  _mm_mul_ps(_mm_loadu_ps(row + i),
+						     _mm_loadu_ps(input + i)));
+			sum1 = _mm_add_ps(
+				sum1, _mm_mul_ps(_mm_loadu_ps(row + i + 4),
+						 _mm_loadu_ps(input + i + 4)));
+		}
+		__m128 sum = _mm_add_ps(sum0, sum1);
+		sum = _mm_hadd_ps(sum, sum);
+		sum = _mm_hadd_ps(sum, sum);
+		output[o] = _mm_cvtss_f32(sum) + bias[o];
+	}
+}
+
+__attribute__((target("avx2"))) static inline float reduce(__m256 v)
+{
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(v),
+				_mm256_extractf128_ps(v, 1));
+	sum = _mm_hadd_ps(sum, sum);
+	sum = _mm_hadd_ps(sum, sum);
+	return _mm_cvtss_f32(sum);
+}
+
+// Four rows per pass so every input load feeds four FMAs
+__attribute__((target("avx2,fma"))) static void
+dense_avx2(const float *weights, const float *bias, const float *input,
+	   float *output, int32_t outputs, int32_t stride)
+{
+	int32_t o = 0;
+	for (; o + 4 <= outputs; o += 4) {
+		const float *row = weights + o * stride;
+		__m256 sum0 = _mm256_setzero_ps();
+		__m256 sum1 = _mm256_setzero_ps();
+		__m256 sum2 = _mm256_setzero_ps();
+		__m256 sum3 = _mm256_setzero_ps();
+		for (int32_t i = 0; i < stride; i += 8) {
+			__m256 x = _mm256_loadu_ps(input + i);
+			sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(row + i), x,
+					       sum0);
+			sum1 = _mm256_fmadd_ps(
+				_mm256_loadu_ps(row + stride + i), x, sum1);
+			sum2 = _mm256_fmadd_ps(
+				_mm256_loadu_ps(row + 2 * stride + i), x, sum2);
+			sum3 = _mm256_fmadd_ps(
+				_mm256_loadu_ps(row + 3 * stride + i), x, sum3);
+		}
+		output[o] = reduce(sum0) + bias[o];
+		output[o + 1] = reduce(sum1) + bias[o + 1];
+		output[o + 2] = reduce(sum2) + bias[o + 2];
+		output[o + 3] = reduce(sum3) + bias[o + 3];
+	}
+	for (; o < outputs; o++) {
+		const float *row = weights + o * stride;
+		__m256 sum = _mm256_setzero_ps();
+		for (int32_t i = 0; i < stride; i += 8) {
+			sum = _mm256_fmadd_ps(_mm256_loadu_ps(row + i),
+					      _mm256_loadu_ps(input + i), sum);
+		}
+		output[o] = reduce(sum) + bias[o];
+	}
+}
+#endif
+
+struct KernelChoice {
+	DenseKernel kernel;
+	const char *name;
+};
+
+static KernelChoice choose_kernel()
+{
+#ifdef MLP_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return { dense_avx2, "avx2" };
+	if (__builtin_cpu_supports("sse3"))
+		return { dense_sse, "sse" };
+#endif
+	return { dense_scalar, "scalar" };
+}
+
+static const KernelChoice &get_kernel()
+{
+	static const KernelChoice choice = choose_kernel();
+	return choice;
+}
+
+static void activate(MLP::Activation activation, float *values, int32_t count)
+{
+	switch (activation) {
+	case MLP::Activation::TANH:
+		for (int32_t i = 0; i < count; i++) {
+			values[i] = std::tanh(values[i]);
+		}
+		break;
+	case MLP::Activation::RELU:
+		for (int32_t i = 0; i < count; i++) {
+			values[i] = std::max(values[i], 0.0f);
+		}
+		break;
+	case MLP::Activation::NONE:
+	default:
+		break;
+	}
+}
+
+static uint32_t read_u32(std::ifstream &file)
+{
+	uint8_t bytes[4];
+	file.read(reinterpret_cast<char *>(bytes), sizeof(bytes));
+	return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 |
+	       uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+static void read_floats(std::ifstream &file, std::vector<float> &values)
+{
+	for (float &value : values) {
+		uint32_t bits = read_u32(file);
+		std::memcpy(&value, &bits, sizeof(value));
+	}
+}
+
+MLP::MLP()
+{
+}
+
+MLP MLP::load(const std::string &file_path)
+{
+	std::ifstream file(file_path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Error: Unable to open policy: " << file_path
+			  << "\r\n";
+		throw std::runtime_error("Unable to open policy");
+	}
+
+	if (read_u32(file) != MAGIC || read_u32(file) != VERSION) {
+		std::cerr << "Error: Not a policy file: " << file_path
+			  << "\r\n";
+		throw std::runtime_error("Not a policy file");
+	}
+
+	MLP mlp;
+	uint32_t layer_count = read_u32(file);
+	for (uint32_t l = 0; l < layer_count && file; l++) {
+		uint32_t inputs = read_u32(file);
+		uint32_t outputs = read_u32(file);
+		uint32_t activation = read_u32(file);
+		if (!file || inputs == 0 || outputs == 0 ||
+		    inputs > (1 << 16) || outputs > (1 << 16) ||
+		    activation > static_cast<uint32_t>(Activation::RELU)) {
+			break;
+		}
+
+		std::vector<float> weights(inputs * outputs);
+		std::vector<float> bias(outputs);
+		read_floats(file, weights);
+		read_floats(file, bias);
+		if (!file)
+			break;
+
+		mlp.add_layer(inputs, outputs,
+			      static_cast<Activation>(activation),
+			      weights.data(), bias.data());
+	}
+
+	if (!file || mlp.layers.size() != layer_count || layer_count == 0) {
+		std::cerr << "Error: Corrupt policy file: " << file_path
+			  << "\r\n";
+		throw std::runtime_error("Corrupt policy file");
+	}
+	return mlp;
+}
+
+void MLP::add_layer(int32_t inputs, int32_t outputs, Activation activation,
+		    const float *weights, const float *bias)
+{
+	if (!layers.empty() && layers.back().outputs != inputs) {
+		throw std::runtime_error("Layer inputs do not match outputs");
+	}
+
+	Layer layer;
+	layer.inputs = inputs;
+	layer.outputs = outputs;
+	layer.stride = (inputs + 7) & ~7;
+	layer.activation = activation;
+	layer.weights.assign(outputs * layer.stride, 0.0f);
+	for (int32_t o = 0; o < outputs; o++) {
+		std::copy(weights + o * inputs, weights + (o + 1) * inputs,
+			  layer.weights.begin() + o * layer.stride);
+	}
+	layer.bias.assign(bias, bias + outputs);
+
+	max_width = std::max({ max_width, layer.stride, (outputs + 7) & ~7 });
+	layers.push_back(std::move(layer));
+}
+
+int32_t MLP::get_input_size() const noexcept
+{
+	return layers.empty() ? 0 : layers.front().inputs;
+}
+
+int32_t MLP::get_output_size() const noexcept
+{
+	return layers.empty() ? 0 : layers.back().outputs;
+}
+
+void MLP::forward(const float *input, float *output) const
+{
+	PROFILE_FUNCTION();
+	forward_batch(input, 1, output);
+}
+
+void MLP::forward_batch(const float *inputs, int32_t count,
+			float *outputs) const
+{
+	PROFILE_FUNCTION();
+	// Ping-pong activations, one row of max_width per input, zero past
+	// each layer's width for the padding
+	thread_local std::vector<float> scratch[2];
+	size_t size = static_cast<size_t>(count) * max_width;
+	for (std::vector<float> &buffer : scratch) {
+		if (buffer.size() < size)
+			buffer.resize(size);
+	}
+
+	static const DenseKernel dense = get_kernel().kernel;
+	const Layer &first = layers.front();
+	for (int32_t r = 0; r < count; r++) {
+		float *row = scratch[0].data() + r * max_width;
+		std::fill(row, row + first.stride, 0.0f);
+		std::copy(inputs + r * first.inputs,
+			  inputs + (r + 1) * first.inputs, row);
+	}
+
+	int32_t current = 0;
+	for (const Layer &layer : layers) {
+		int32_t padded = (layer.outputs + 7) & ~7;
+		const float *in = scratch[current].data();
+		float *out = scratch[current ^ 1].data();
+		for (int32_t r = 0; r < count;
+		     r++, in += max_width, out += max_width) {
+			dense(layer.weights.data(), layer.bias.data(), in, out,
+			      layer.outputs, layer.stride);
+			activate(layer.activation, out, layer.outputs);
+			std::fill(out + layer.outputs, out + padded, 0.0f);
+		}
+		current ^= 1;
+	}
+
+	int32_t outputs_size = get_output_size();
+	for (int32_t r = 0; r < count; r++) {
+		const float *row = scratch[current].data() + r * max_width;
+		std::copy(row, row + outputs_size, outputs + r * outputs_size);
+	}
+}
+
+int32_t MLP::argmax(const float *input) const
+{
+	thread_local std::vector<float> logits;
+	logits.resize(get_output_size());
+	forward(input, logits.data());
+	return argmax_logits(logits.data(), logits.size());
+}
+
+int32_t MLP::sample(const float *input, std::mt19937 &rng) const
+{
+	thread_local std::vector<float> logits;
+	logits.resize(get_output_size());
+	forward(input, logits.data());
+	return sample_logits(logits.data(), logits.size(), rng);
+}
+
+int32_t MLP::argmax_logits(const float *logits, int32_t count)
+{
+	return std::max_element(logits, logits + count) - logits;
+}
+
+int32_t MLP::sample_logits(const float *logits, int32_t count,
+			   std::mt19937 &rng)
+{
+	thread_local std::vector<float> weights;
+	weights.assign(logits, logits + count);
+
+	// Softmax shifted by the largest logit so exp cannot overflow
+	float largest = *std::max_element(weights.begin(), weights.end());
+	float total = 0.0f;
+	for (float &weight : weights) {
+		weight = std::exp(weight - largest);
+		total += weight;
+	}
+
+	float pick = std::uniform_real_distribution<float>(0.0f, total)(rng);
+	for (int32_t i = 0; i < count; i++) {
+		pick -= weights[i];
+		if (pick < 0.0f)
+			return i;
+	}
+	return count - 1;
+}
+
+const char *MLP::get_kernel_name()
+{
+	return get_kernel().name;
+}
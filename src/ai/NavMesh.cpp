@@ -0,0 +1,789 @@
+#include <ai/NavMesh.h>
+
+#include <misc/Profiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+// Corridors kept before the cache starts over
+#define corridor_cache_size 4096
+// Rings of cells searched around a point off the mesh for a polygon
+#define snap_rings 8
+
+struct NavMesh::Cache {
+	std::mutex mutex;
+	// By start polygon << 32 | goal polygon, empty when unreachable
+	std::unordered_map<uint64_t, std::vector<int32_t> > corridors;
+};
+
+static void write_u32(std::ofstream &file, uint32_t value)
+{
+	uint8_t bytes[4] = { uint8_t(value), uint8_t(value >> 8),
+			     uint8_t(value >> 16), uint8_t(value >> 24) };
+	file.write(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+static void write_float(std::ofstream &file, float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	write_u32(file, bits);
+}
+
+static uint32_t read_u32(std::ifstream &file)
+{
+	uint8_t bytes[4];
+	file.read(reinterpret_cast<char *>(bytes), sizeof(bytes));
+	return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 |
+	       uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+static float read_float(std::ifstream &file)
+{
+	uint32_t bits = read_u32(file);
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// FNV-1a
+static void hash_bytes(uint64_t &hash, const void *data, size_t size)
+{
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+}
+
+// Twice the signed area of a, b, c, positive when c is right of a to b
+static float triangle_area(const float *a, const float *b, const float *c)
+{
+	return (c[0] - a[0]) * (b[1] - a[1]) - (b[0] - a[0]) * (c[1] - a[1]);
+}
+
+NavMesh::NavMesh()
+	: cache(std::make_unique<Cache>())
+{
+}
+
+NavMesh::NavMesh(NavMesh &&) noexcept = default;
+
+NavMesh &NavMesh::operator=(NavMesh &&) noexcept = default;
+
+NavMesh::~NavMesh() = default;
+
+uint64_t NavMesh::hash_source(const std::vector<float> &positions,
+			      const std::vector<int32_t> &indices,
+			      const Settings &settings)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	hash_bytes(hash, positions.data(), positions.size() * sizeof(float));
+	hash_bytes(hash, indices.data(), indices.size() * sizeof(int32_t));
+	hash_bytes(hash, &settings, sizeof(settings));
+	return hash;
+}
+
+NavMesh NavMesh::build(const std::vector<float> &positions,
+		       const std::vector<int32_t> &indices,
+		       const Settings &settings)
+{
+	PROFILE_FUNCTION();
+	NavMesh mesh;
+	mesh.source_hash = hash_source(positions, indices, settings);
+	mesh.cell_size = std::max(settings.cell_size, 1e-3f);
+	if (positions.size() < 3 || indices.size() < 3)
+		return mesh;
+
+	const float size = mesh.cell_size;
+	const float min_normal =
+		std::cos(settings.max_slope * float(M_PI) / 180.0f);
+	auto vertex = [&positions](int32_t index) {
+		return Vector3f(positions.at(3 * index),
+				positions.at(3 * index + 1),
+				positions.at(3 * index + 2));
+	};
+
+	float min_x = std::numeric_limits<float>::max(), min_y = min_x;
+	float max_x = std::numeric_limits<float>::lowest(), max_y = max_x;
+	for (size_t i = 0; i + 2 < positions.size(); i += 3) {
+		min_x = std::min(min_x, positions[i]);
+		max_x = std::max(max_x, positions[i]);
+		min_y = std::min(min_y, positions[i + 1]);
+		max_y = std::max(max_y, positions[i + 1]);
+	}
+	mesh.origin_x = min_x;
+	mesh.origin_y = min_y;
+	mesh.width = int32_t((max_x - min_x) / size) + 1;
+	mesh.height = int32_t((max_y - min_y) / size) + 1;
+	const int32_t width = mesh.width, height = mesh.height;
+	auto cell_x = [&](float x) {
+		return int32_t(std::floor((x - min_x) / size));
+	};
+	auto cell_y = [&](float y) {
+		return int32_t(std::floor((y - min_y) / size));
+	};
+	auto at = [width](int32_t x, int32_t y) {
+		return size_t(y) * width + x;
+	};
+
+	// The highest walkable surface under every cell center
+	const float none = std::numeric_limits<float>::lowest();
+	std::vector<float> surface(size_t(width) * height, none);
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		Vector3f a = vertex(indices[t]), b = vertex(indices[t + 1]),
+			 c = vertex(indices[t + 2]);
+		Vector3f normal = (b - a).cross(c - a);
+		float area = normal.length();
+		if (area <= 0.0f || std::abs(normal.getZ()) < min_normal * area)
+			continue;
+
+		float det = (b.getY() - c.getY()) * (a.getX() - c.getX()) +
+			    (c.getX() - b.getX()) * (a.getY() - c.getY());
+		int32_t x0 = std::max(0, cell_x(std::min({ a.getX(), b.getX(),
+							   c.getX() })));
+		int32_t x1 = std::min(width - 1,
+				      cell_x(std::max({ a.getX(), b.getX(),
+							c.getX() })));
+		int32_t y0 = std::max(0, cell_y(std::min({ a.getY(), b.getY(),
+							   c.getY() })));
+		int32_t y1 = std::min(height - 1,
+				      cell_y(std::max({ a.getY(), b.getY(),
+							c.getY() })));
+		for (int32_t y = y0; y <= y1; y++) {
+			float py = min_y + (y + 0.5f) * size;
+			for (int32_t x = x0; x <= x1; x++) {
+				float px = min_x + (x + 0.5f) * size;
+				float l1 = ((b.getY() - c.getY()) *
+						    (px - c.getX()) +
+					    (c.getX() - b.getX()) *
+						    (py - c.getY())) /
+					   det;
+				float l2 = ((c.getY() - a.getY()) *
+						    (px - c.getX()) +
+					    (a.getX() - c.getX()) *
+						    (py - c.getY())) /
+					   det;
+				float l3 = 1.0f - l1 - l2;
+				if (l1 < -1e-4f || l2 < -1e-4f || l3 < -1e-4f)
+					continue;
+
+				float z = l1 * a.getZ() + l2 * b.getZ() +
+					  l3 * c.getZ();
+				float &cell = surface[at(x, y)];
+				cell = std::max(cell, z);
+			}
+		}
+	}
+
+	// Walls are sampled at half a cell, a wall is too thin from above
+	// for its triangles to cover any cell center
+	std::vector<uint8_t> open(surface.size());
+	for (size_t i = 0; i < surface.size(); i++) {
+		open[i] = surface[i] != none;
+	}
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		Vector3f a = vertex(indices[t]), b = vertex(indices[t + 1]),
+			 c = vertex(indices[t + 2]);
+		Vector3f normal = (b - a).cross(c - a);
+		float area = normal.length();
+		if (area <= 0.0f ||
+		    std::abs(normal.getZ()) >= min_normal * area)
+			continue;
+
+		float longest = std::max({ (b - a).length(), (c - a).length(),
+					   (c - b).length() });
+		int32_t steps = std::max(1, int32_t(std::ceil(2.0f * longest /
+							       size)));
+		for (int32_t i = 0; i <= steps; i++) {
+			for (int32_t j = 0; i + j <= steps; j++) {
+				Vector3f p = a + (b - a) * (float(i) / steps) +
+					     (c - a) * (float(j) / steps);
+				int32_t x = cell_x(p.getX());
+				int32_t y = cell_y(p.getY());
+				if (x < 0 || x >= width || y < 0 || y >= height)
+					continue;
+
+				size_t cell = at(x, y);
+				float rise = p.getZ() - surface[cell];
+				if (open[cell] && rise > settings.max_climb &&
+				    rise < settings.agent_height)
+					open[cell] = 0;
+			}
+		}
+	}
+
+	auto connected = [&](size_t a, size_t b) {
+		return open[a] && open[b] &&
+		       std::abs(surface[a] - surface[b]) <= settings.max_climb;
+	};
+
+	// Cells by distance to the nearest edge, in cells, from the open cells
+	// next to a drop, a wall or the end of the grid
+	std::vector<int32_t> distance(surface.size(),
+				      std::numeric_limits<int32_t>::max());
+	std::vector<size_t> frontier, next;
+	const int32_t dx[4] = { 1, -1, 0, 0 }, dy[4] = { 0, 0, 1, -1 };
+	for (int32_t y = 0; y < height; y++) {
+		for (int32_t x = 0; x < width; x++) {
+			size_t cell = at(x, y);
+			if (!open[cell])
+				continue;
+			for (int32_t d = 0; d < 4; d++) {
+				int32_t nx = x + dx[d], ny = y + dy[d];
+				if (nx < 0 || nx >= width || ny < 0 ||
+				    ny >= height ||
+				    !connected(cell,
+					       at(nx, ny))) {
+					distance[cell] = 0;
+					frontier.push_back(cell);
+					break;
+				}
+			}
+		}
+	}
+	for (int32_t step = 1; !frontier.empty(); step++) {
+		next.clear();
+		for (size_t cell : frontier) {
+			int32_t x = cell % width, y = cell / width;
+			for (int32_t ny = y - 1; ny <= y + 1; ny++) {
+				for (int32_t nx = x - 1; nx <= x + 1; nx++) {
+					if (nx < 0 || nx >= width || ny < 0 ||
+					    ny >= height)
+						continue;
+					size_t n = at(nx, ny);
+					if (!open[n] || distance[n] <= step)
+						continue;
+					distance[n] = step;
+					next.push_back(n);
+				}
+			}
+		}
+		std::swap(frontier, next);
+	}
+	int32_t erosion = int32_t(std::ceil(settings.agent_radius / size));
+	for (size_t i = 0; i < open.size(); i++) {
+		if (distance[i] < erosion)
+			open[i] = 0;
+	}
+
+	// Greedy rectangles, within max_climb of each other throughout so
+	// every polygon is flat enough to cross in a straight line
+	mesh.cells.assign(surface.size(), -1);
+	auto fits = [&](int32_t x, int32_t y, float base) {
+		size_t cell = at(x, y);
+		return open[cell] && mesh.cells[cell] < 0 &&
+		       std::abs(surface[cell] - base) <=
+			       0.5f * settings.max_climb;
+	};
+	for (int32_t y = 0; y < height; y++) {
+		for (int32_t x = 0; x < width; x++) {
+			float base = surface[at(x, y)];
+			if (!fits(x, y, base))
+				continue;
+
+			Polygon polygon = { x, y, x + 1, y + 1, 0.0f, 0, 0 };
+			while (polygon.x1 < width && fits(polygon.x1, y, base))
+				polygon.x1++;
+			for (; polygon.y1 < height; polygon.y1++) {
+				bool row = true;
+				for (int32_t cx = x; cx < polygon.x1 && row;
+				     cx++) {
+					row = fits(cx, polygon.y1, base);
+				}
+				if (!row)
+					break;
+			}
+
+			float total = 0.0f;
+			int32_t id = mesh.polygons.size();
+			for (int32_t cy = polygon.y0; cy < polygon.y1; cy++) {
+				for (int32_t cx = polygon.x0; cx < polygon.x1;
+				     cx++) {
+					size_t cell = at(cx, cy);
+					mesh.cells[cell] = id;
+					total += surface[cell];
+				}
+			}
+			polygon.z = total / ((polygon.x1 - polygon.x0) *
+					     (polygon.y1 - polygon.y0));
+			mesh.polygons.push_back(polygon);
+		}
+	}
+
+	// Runs of connected cells across each side of a polygon that belong
+	// to the same neighbour are the edge shared with it
+	for (Polygon &polygon : mesh.polygons) {
+		polygon.first_link = mesh.links.size();
+		for (int32_t side = 0; side < 4; side++) {
+			bool along_y = side < 2;
+			int32_t begin = along_y ? polygon.y0 : polygon.x0;
+			int32_t end = along_y ? polygon.y1 : polygon.x1;
+			int32_t edge = side == 0 ? polygon.x1 :
+				       side == 1 ? polygon.x0 :
+				       side == 2 ? polygon.y1 :
+						   polygon.y0;
+			int32_t inside = side % 2 == 0 ? edge - 1 : edge;
+			int32_t outside = side % 2 == 0 ? edge : edge - 1;
+			int32_t across = along_y ? width : height;
+			if (outside < 0 || outside >= across)
+				continue;
+
+			int32_t run = -1, run_start = begin;
+			for (int32_t k = begin; k <= end; k++) {
+				int32_t neighbour = -1;
+				if (k < end) {
+					size_t from = along_y ? at(inside, k) :
+								at(k, inside);
+					size_t to = along_y ? at(outside, k) :
+							      at(k, outside);
+					if (connected(from, to))
+						neighbour = mesh.cells[to];
+				}
+				if (neighbour == run)
+					continue;
+
+				if (run >= 0) {
+					Link link;
+					link.polygon = run;
+					if (along_y) {
+						link.ax = link.bx =
+							min_x + edge * size;
+						link.ay = min_y +
+							  run_start * size;
+						link.by = min_y + k * size;
+					} else {
+						link.ax = min_x +
+							  run_start * size;
+						link.bx = min_x + k * size;
+						link.ay = link.by =
+							min_y + edge * size;
+					}
+					mesh.links.push_back(link);
+				}
+				run = neighbour;
+				run_start = k;
+			}
+		}
+		polygon.link_count = mesh.links.size() - polygon.first_link;
+	}
+
+	return mesh;
+}
+
+NavMesh NavMesh::load(const std::string &file_path)
+{
+	std::ifstream file(file_path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Error: Unable to open navmesh: " << file_path
+			  << "\r\n";
+		throw std::runtime_error("Unable to open navmesh");
+	}
+
+	if (read_u32(file) != MAGIC || read_u32(file) != VERSION) {
+		std::cerr << "Error: Not a navmesh file: " << file_path
+			  << "\r\n";
+		throw std::runtime_error("Not a navmesh file");
+	}
+
+	NavMesh mesh;
+	mesh.source_hash = read_u32(file);
+	mesh.source_hash |= uint64_t(read_u32(file)) << 32;
+	mesh.width = read_u32(file);
+	mesh.height = read_u32(file);
+	mesh.origin_x = read_float(file);
+	mesh.origin_y = read_float(file);
+	mesh.cell_size = read_float(file);
+	uint32_t polygon_count = read_u32(file);
+	bool valid = file && mesh.width >= 0 && mesh.height >= 0 &&
+		     int64_t(mesh.width) * mesh.height <= (1 << 26) &&
+		     polygon_count <= uint32_t(mesh.width) * mesh.height &&
+		     mesh.cell_size > 0.0f;
+	for (uint32_t p = 0; p < polygon_count && valid; p++) {
+		Polygon polygon;
+		polygon.x0 = read_u32(file);
+		polygon.y0 = read_u32(file);
+		polygon.x1 = read_u32(file);
+		polygon.y1 = read_u32(file);
+		polygon.z = read_float(file);
+		uint32_t link_count = read_u32(file);
+		polygon.first_link = mesh.links.size();
+		polygon.link_count = link_count;
+		valid = file && polygon.x0 >= 0 && polygon.x0 < polygon.x1 &&
+			polygon.x1 <= mesh.width && polygon.y0 >= 0 &&
+			polygon.y0 < polygon.y1 && polygon.y1 <= mesh.height &&
+			link_count <= 4 * uint32_t(mesh.width + mesh.height);
+		for (uint32_t l = 0; l < link_count && valid; l++) {
+			Link link;
+			link.polygon = read_u32(file);
+			link.ax = read_float(file);
+			link.ay = read_float(file);
+			link.bx = read_float(file);
+			link.by = read_float(file);
+			valid = file && link.polygon >= 0 &&
+				uint32_t(link.polygon) < polygon_count;
+			mesh.links.push_back(link);
+		}
+		mesh.polygons.push_back(polygon);
+	}
+
+	if (!valid) {
+		std::cerr << "Error: Corrupt navmesh file: " << file_path
+			  << "\r\n";
+		throw std::runtime_error("Corrupt navmesh file");
+	}
+	mesh.index_cells();
+	return mesh;
+}
+
+void NavMesh::save(const std::string &file_path) const
+{
+	std::ofstream file(file_path, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Error: Unable to write navmesh: " << file_path
+			  << "\r\n";
+		throw std::runtime_error("Unable to write navmesh");
+	}
+
+	write_u32(file, MAGIC);
+	write_u32(file, VERSION);
+	write_u32(file, uint32_t(source_hash));
+	write_u32(file, uint32_t(source_hash >> 32));
+	write_u32(file, width);
+	write_u32(file, height);
+	write_float(file, origin_x);
+	write_float(file, origin_y);
+	write_float(file, cell_size);
+	write_u32(file, polygons.size());
+	for (const Polygon &polygon : polygons) {
+		write_u32(file, polygon.x0);
+		write_u32(file, polygon.y0);
+		write_u32(file, polygon.x1);
+		write_u32(file, polygon.y1);
+		write_float(file, polygon.z);
+		write_u32(file, polygon.link_count);
+		for (int32_t l = 0; l < polygon.link_count; l++) {
+			const Link &link = links[polygon.first_link + l];
+			write_u32(file, link.polygon);
+			write_float(file, link.ax);
+			write_float(file, link.ay);
+			write_float(file, link.bx);
+			write_float(file, link.by);
+		}
+	}
+}
+
+NavMesh NavMesh::bake(const std::vector<float> &positions,
+		      const std::vector<int32_t> &indices,
+		      const Settings &settings, const std::string &file_path)
+{
+	uint64_t hash = hash_source(positions, indices, settings);
+	if (std::ifstream(file_path).good()) {
+		try {
+			NavMesh mesh = load(file_path);
+			if (mesh.source_hash == hash)
+				return mesh;
+		} catch (const std::runtime_error &) {
+		}
+	}
+
+	std::cout << "Baking navmesh: " << file_path << "\r\n";
+	NavMesh mesh = build(positions, indices, settings);
+	try {
+		mesh.save(file_path);
+	} catch (const std::runtime_error &) {
+		std::cerr << "Warning: Navmesh is rebuilt on every start\r\n";
+	}
+	return mesh;
+}
+
+void NavMesh::index_cells()
+{
+	cells.assign(size_t(width) * height, -1);
+	for (size_t p = 0; p < polygons.size(); p++) {
+		const Polygon &polygon = polygons[p];
+		for (int32_t y = polygon.y0; y < polygon.y1; y++) {
+			auto row = cells.begin() + size_t(y) * width;
+			std::fill(row + polygon.x0, row + polygon.x1, p);
+		}
+	}
+}
+
+uint64_t NavMesh::get_source_hash() const noexcept
+{
+	return source_hash;
+}
+
+int32_t NavMesh::get_polygon_count() const noexcept
+{
+	return polygons.size();
+}
+
+float NavMesh::center_x(const Polygon &polygon) const noexcept
+{
+	return origin_x + 0.5f * (polygon.x0 + polygon.x1) * cell_size;
+}
+
+float NavMesh::center_y(const Polygon &polygon) const noexcept
+{
+	return origin_y + 0.5f * (polygon.y0 + polygon.y1) * cell_size;
+}
+
+bool NavMesh::is_walkable(float x, float y) const
+{
+	int32_t cx = int32_t(std::floor((x - origin_x) / cell_size));
+	int32_t cy = int32_t(std::floor((y - origin_y) / cell_size));
+	return cx >= 0 && cx < width && cy >= 0 && cy < height &&
+	       cells[size_t(cy) * width + cx] >= 0;
+}
+
+int32_t NavMesh::find_polygon(float x, float y) const
+{
+	int32_t cx = int32_t(std::floor((x - origin_x) / cell_size));
+	int32_t cy = int32_t(std::floor((y - origin_y) / cell_size));
+	for (int32_t ring = 0; ring <= snap_rings; ring++) {
+		int32_t best = -1;
+		float best_distance = std::numeric_limits<float>::max();
+		for (int32_t ny = cy - ring; ny <= cy + ring; ny++) {
+			for (int32_t nx = cx - ring; nx <= cx + ring; nx++) {
+				// Only the ring itself, the inside was searched
+				if (std::max(std::abs(nx - cx),
+					     std::abs(ny - cy)) != ring ||
+				    nx < 0 || nx >= width || ny < 0 ||
+				    ny >= height)
+					continue;
+				int32_t polygon =
+					cells[size_t(ny) * width + nx];
+				if (polygon < 0)
+					continue;
+
+				float ox = origin_x + (nx + 0.5f) * cell_size;
+				float oy = origin_y + (ny + 0.5f) * cell_size;
+				float d = (ox - x) * (ox - x) +
+					  (oy - y) * (oy - y);
+				if (d < best_distance) {
+					best_distance = d;
+					best = polygon;
+				}
+			}
+		}
+		if (best >= 0)
+			return best;
+	}
+	return -1;
+}
+
+bool NavMesh::search(int32_t start, int32_t goal,
+		     std::vector<int32_t> &corridor) const
+{
+	PROFILE_FUNCTION();
+	// Costs of the polygons stamped with this search are current
+	thread_local std::vector<float> cost;
+	thread_local std::vector<int32_t> parent;
+	thread_local std::vector<uint32_t> stamp;
+	thread_local std::vector<std::pair<float, int32_t> > open;
+	thread_local uint32_t search_id = 0;
+	if (stamp.size() < polygons.size()) {
+		cost.resize(polygons.size());
+		parent.resize(polygons.size());
+		stamp.resize(polygons.size(), 0);
+	}
+	search_id++;
+
+	auto distance = [this](int32_t a, int32_t b) {
+		return std::hypot(center_x(polygons[a]) - center_x(polygons[b]),
+				  center_y(polygons[a]) -
+					  center_y(polygons[b]));
+	};
+	std::greater<std::pair<float, int32_t> > later;
+
+	open.clear();
+	cost[start] = 0.0f;
+	parent[start] = -1;
+	stamp[start] = search_id;
+	open.push_back({ distance(start, goal), start });
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), later);
+		auto [estimate, current] = open.back();
+		open.pop_back();
+		if (current == goal) {
+			corridor.clear();
+			for (int32_t p = goal; p >= 0; p = parent[p]) {
+				corridor.push_back(p);
+			}
+			std::reverse(corridor.begin(), corridor.end());
+			return true;
+		}
+		// Superseded by a cheaper way here
+		if (estimate > cost[current] + distance(current, goal) + 1e-4f)
+			continue;
+
+		const Polygon &polygon = polygons[current];
+		for (int32_t l = 0; l < polygon.link_count; l++) {
+			int32_t next = links[polygon.first_link + l].polygon;
+			float step = cost[current] + distance(current, next);
+			if (stamp[next] == search_id && step >= cost[next])
+				continue;
+
+			stamp[next] = search_id;
+			cost[next] = step;
+			parent[next] = current;
+			open.push_back({ step + distance(next, goal), next });
+			std::push_heap(open.begin(), open.end(), later);
+		}
+	}
+	corridor.clear();
+	return false;
+}
+
+void NavMesh::find_corridor(int32_t start, int32_t goal,
+			    std::vector<int32_t> &corridor) const
+{
+	uint64_t key = uint64_t(uint32_t(start)) << 32 | uint32_t(goal);
+	{
+		std::lock_guard<std::mutex> lock(cache->mutex);
+		auto it = cache->corridors.find(key);
+		if (it != cache->corridors.end()) {
+			corridor.assign(it->second.begin(), it->second.end());
+			return;
+		}
+	}
+
+	search(start, goal, corridor);
+
+	std::lock_guard<std::mutex> lock(cache->mutex);
+	if (cache->corridors.size() >= corridor_cache_size)
+		cache->corridors.clear();
+	cache->corridors.emplace(key, corridor);
+}
+
+/*
+ * The simple stupid funnel: the path leaves the apex through the narrowing
+ * wedge of the shared edges ahead, and turns at a corner of the wedge once
+ * an edge falls entirely to one side of it.
+ */
+bool NavMesh::find_path(const Vector3f &start, const Vector3f &goal,
+			std::vector<Vector3f> &path) const
+{
+	PROFILE_FUNCTION();
+	path.clear();
+	int32_t from = find_polygon(start.getX(), start.getY());
+	int32_t to = find_polygon(goal.getX(), goal.getY());
+	if (from < 0 || to < 0)
+		return false;
+
+	thread_local std::vector<int32_t> corridor;
+	find_corridor(from, to, corridor);
+	if (corridor.empty())
+		return false;
+
+	auto onto = [this](const Polygon &polygon, const Vector3f &point) {
+		float x = std::clamp(point.getX(),
+				     origin_x + polygon.x0 * cell_size,
+				     origin_x + polygon.x1 * cell_size);
+		float y = std::clamp(point.getY(),
+				     origin_y + polygon.y0 * cell_size,
+				     origin_y + polygon.y1 * cell_size);
+		return Vector3f(x, y, polygon.z);
+	};
+	Vector3f first = onto(polygons[from], start);
+	Vector3f last = onto(polygons[to], goal);
+
+	// Left and right ends of every edge crossed, seen walking the
+	// corridor, between the start and goal collapsed to points
+	thread_local std::vector<float> portals;
+	portals.clear();
+	portals.insert(portals.end(), { first.getX(), first.getY(),
+					first.getX(), first.getY() });
+	for (size_t i = 0; i + 1 < corridor.size(); i++) {
+		const Polygon &current = polygons[corridor[i]];
+		const Polygon &next = polygons[corridor[i + 1]];
+		const Link *link = nullptr;
+		for (int32_t l = 0; l < current.link_count && !link; l++) {
+			if (links[current.first_link + l].polygon ==
+			    corridor[i + 1])
+				link = &links[current.first_link + l];
+		}
+
+		float cx = center_x(current), cy = center_y(current);
+		float dx = center_x(next) - cx, dy = center_y(next) - cy;
+		float side_a = dx * (link->ay - cy) - dy * (link->ax - cx);
+		float side_b = dx * (link->by - cy) - dy * (link->bx - cx);
+		if (side_a > side_b) {
+			portals.insert(portals.end(), { link->ax, link->ay,
+							link->bx, link->by });
+		} else {
+			portals.insert(portals.end(), { link->bx, link->by,
+							link->ax, link->ay });
+		}
+	}
+	portals.insert(portals.end(),
+		       { last.getX(), last.getY(), last.getX(), last.getY() });
+
+	// Corners take the height of the polygon past the edge they are on
+	int32_t count = portals.size() / 4;
+	auto corner = [&](const float *point, int32_t portal) {
+		float z = portal == 0 ? first.getZ() :
+			  portal == count - 1 ?
+					last.getZ() :
+					polygons[corridor[portal]].z;
+		Vector3f position(point[0], point[1], z);
+		if (path.empty() || !(path.back() == position))
+			path.push_back(position);
+	};
+
+	float apex[2], left[2], right[2];
+	int32_t apex_index = 0, left_index = 0, right_index = 0;
+	std::copy(portals.begin(), portals.begin() + 2, apex);
+	std::copy(portals.begin(), portals.begin() + 2, left);
+	std::copy(portals.begin() + 2, portals.begin() + 4, right);
+	corner(apex, 0);
+	for (int32_t i = 1; i < count; i++) {
+		const float *next_left = &portals[4 * i];
+		const float *next_right = &portals[4 * i + 2];
+
+		if (triangle_area(apex, right, next_right) <= 0.0f) {
+			if ((apex[0] == right[0] && apex[1] == right[1]) ||
+			    triangle_area(apex, left, next_right) > 0.0f) {
+				std::copy(next_right, next_right + 2, right);
+				right_index = i;
+			} else {
+				// Right crossed over left, turn at left
+				corner(left, left_index);
+				std::copy(left, left + 2, apex);
+				apex_index = left_index;
+				std::copy(apex, apex + 2, right);
+				right_index = apex_index;
+				i = apex_index;
+				continue;
+			}
+		}
+
+		if (triangle_area(apex, left, next_left) >= 0.0f) {
+			if ((apex[0] == left[0] && apex[1] == left[1]) ||
+			    triangle_area(apex, right, next_left) < 0.0f) {
+				std::copy(next_left, next_left + 2, left);
+				left_index = i;
+			} else {
+				// Left crossed over right, turn at right
+				corner(right, right_index);
+				std::copy(right, right + 2, apex);
+				apex_index = right_index;
+				std::copy(apex, apex + 2, left);
+				left_index = apex_index;
+				i = apex_index;
+				continue;
+			}
+		}
+	}
+	corner(&portals[4 * (count - 1)], count - 1);
+	return true;
+}
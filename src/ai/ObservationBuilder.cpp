@@ -0,0 +1,86 @@
+#include <ai/ObservationBuilder.h>
+
+#include <components/Entity.h>
+
+#include <core/Config.h>
+
+#include <algorithm>
+#include <cmath>
+
+ObservationBuilder::ObservationBuilder()
+{
+	Config &config = Config::get_instance();
+	target_distance =
+		config.get_double("Observation", "target_distance", 7.5);
+	position_scale =
+		config.get_double("Observation", "position_scale", 20.0);
+}
+
+void ObservationBuilder::reset(Entity &agent, Entity &target)
+{
+	last_agent_hp = agent.get_hp();
+	last_target_hp = target.get_hp();
+}
+
+ObservationBuilder::Observation
+ObservationBuilder::build(Entity &agent, Entity &target, bool shot_hit)
+{
+	Entity::EntityState self = agent.get_entity_state();
+	Entity::EntityState other = target.get_entity_state();
+	btVector3 offset = other.position - self.position;
+
+	// Entities face local -y, rotated by their orientation, as they move
+	// and shoot. Both angles are from +x, like quaternion_to_yaw and
+	// calculate_angle in AI_RL.py
+	const btQuaternion &q = self.orientation;
+	float forward_x = -2.0f * (q.x() * q.y() - q.w() * q.z());
+	float forward_y = -(1.0f - 2.0f * (q.x() * q.x() + q.z() * q.z()));
+	float facing = std::atan2(forward_y, forward_x);
+	float bearing = std::atan2(offset.y(), offset.x());
+
+	Observation observation;
+	observation.distance = offset.length();
+	observation.distance_error = observation.distance - target_distance;
+	observation.yaw_error =
+		std::remainder(bearing - facing, 2.0f * float(M_PI));
+	observation.agent_hp = agent.get_hp();
+	observation.target_hp = target.get_hp();
+	observation.shot_hit = shot_hit;
+	observation.got_hit = observation.agent_hp < last_agent_hp;
+
+	float agent_max = std::max(agent.get_max_hp(), 1.0f);
+	float target_max = std::max(target.get_max_hp(), 1.0f);
+	float *features = observation.features;
+	features[0] = offset.x() / position_scale;
+	features[1] = offset.y() / position_scale;
+	features[2] = offset.z() / position_scale;
+	features[3] = observation.yaw_error / float(M_PI);
+	features[4] = observation.distance_error / position_scale;
+	features[5] = observation.agent_hp / agent_max;
+	features[6] = observation.target_hp / target_max;
+	features[7] = (observation.agent_hp - last_agent_hp) / agent_max;
+	features[8] = (observation.target_hp - last_target_hp) / target_max;
+	features[9] = shot_hit ? 1.0f : 0.0f;
+	features[10] = observation.got_hit ? 1.0f : 0.0f;
+	features[11] = agent.on_ground ? 1.0f : 0.0f;
+
+	last_agent_hp = observation.agent_hp;
+	last_target_hp = observation.target_hp;
+	return observation;
+}
+
+void ObservationBuilder::build_legacy(const RLProtocol::AgentState &state,
+				      float *out) noexcept
+{
+	const float *enemy = state.enemy_position;
+	const float *player = state.player_position;
+	float dx = enemy[0] - player[0];
+	float dy = enemy[1] - player[1];
+	float dz = enemy[2] - player[2];
+
+	std::copy(enemy, enemy + 3, out);
+	std::copy(player, player + 3, out + 3);
+	out[6] = state.enemy_hp;
+	out[7] = state.player_hp;
+	out[8] = std::sqrt(dx * dx + dy * dy + dz * dz);
+}
@@ -0,0 +1,84 @@
+#include <ai/RewardEvaluator.h>
+
+#include <core/Config.h>
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+RewardEvaluator::RewardEvaluator()
+{
+	Config &config = Config::get_instance();
+	mode = parse_mode(config.get_string("Reward", "mode", "final"));
+	win = config.get_double("Reward", "win", 100.0);
+	loss = config.get_double("Reward", "loss", -100.0);
+	hit = config.get_double("Reward", "hit", 10.0);
+	shot = config.get_double("Reward", "shot", 5.0);
+	miss = config.get_double("Reward", "miss", -2.5);
+	shoot_action = config.get_int("Reward", "shoot_action", 4);
+	max_steps = config.get_int("Reward", "max_steps", 0);
+}
+
+RewardEvaluator::Mode RewardEvaluator::parse_mode(const std::string &name)
+{
+	if (name == "range")
+		return Mode::RANGE;
+	if (name == "face")
+		return Mode::FACE;
+	if (name == "shoot")
+		return Mode::SHOOT;
+	if (name == "final")
+		return Mode::FINAL;
+
+	std::cerr << "Error: Unknown reward mode: " << name << "\r\n";
+	throw std::runtime_error("Unknown reward mode");
+}
+
+void RewardEvaluator::set_mode(Mode mode) noexcept
+{
+	this->mode = mode;
+}
+
+RewardEvaluator::Mode RewardEvaluator::get_mode() const noexcept
+{
+	return mode;
+}
+
+void RewardEvaluator::reset() noexcept
+{
+	steps = 0;
+}
+
+RewardEvaluator::Result
+RewardEvaluator::evaluate(const ObservationBuilder::Observation &observation,
+			  int32_t action)
+{
+	Result result;
+	steps++;
+
+	if (observation.agent_hp <= 0 || observation.target_hp <= 0) {
+		result.terminated = true;
+		result.reward = observation.agent_hp > 0 ? win : loss;
+		return result;
+	}
+	result.truncated = max_steps > 0 && steps >= max_steps;
+
+	float range = -std::abs(observation.distance_error);
+	float shooting = observation.shot_hit ? hit :
+			 action == shoot_action ? shot : miss;
+	switch (mode) {
+	case Mode::RANGE:
+		result.reward = range;
+		break;
+	case Mode::FACE:
+		result.reward = -std::abs(observation.yaw_error);
+		break;
+	case Mode::SHOOT:
+		result.reward = shooting;
+		break;
+	case Mode::FINAL:
+		result.reward = shooting + range;
+		break;
+	}
+	return result;
+}
@@ -5,11 +5,13 @@
 #include <graphics/Shader.h>
 
 #include <core/SharedGlobals.h>
+#include <core/JobSystem.h>
 #include <components/GameComponent.h>
 
 #include <physics/Collision.h>
 
 #include <vector>
+#include <cstddef>
 
 GameObject::GameObject()
 	: children()
@@ -34,8 +36,40 @@ void GameObject::update(float delta)
 		component->update(delta);
 	}
 
-	for (GameObject *child : children) {
-		child->update(delta);
+	update_children(delta);
+}
+
+void GameObject::update_children(float delta)
+{
+	static JobSystem &jobs = JobSystem::get_instance();
+
+	if (jobs.get_worker_count() == 0) {
+		for (GameObject *child : children) {
+			child->update(delta);
+		}
+		return;
+	}
+
+	size_t i = 0;
+	while (i < children.size()) {
+		size_t end = i;
+		while (end < children.size() && children[end]->parallel)
+			end++;
+
+		if (end - i < 2) {
+			children[i++]->update(delta);
+			continue;
+		}
+
+		// The last one of the batch runs here while the rest are stolen
+		JobSystem::Counter counter;
+		for (; i + 1 < end; i++) {
+			GameObject *child = children[i];
+			jobs.run([child, delta] { child->update(delta); },
+				 &counter);
+		}
+		children[i++]->update(delta);
+		jobs.wait(counter);
 	}
 }
 
@@ -61,6 +95,17 @@ void GameObject::reset()
 	}
 }
 
+void GameObject::interpolate(float alpha)
+{
+	for (GameComponent *component : components) {
+		component->interpolate(alpha);
+	}
+
+	for (GameObject *child : children) {
+		child->interpolate(alpha);
+	}
+}
+
 void GameObject::add_to_rendering_engine()
 {
 	for (GameComponent *component : components) {
@@ -72,6 +117,17 @@ void GameObject::add_to_rendering_engine()
 	}
 }
 
+void GameObject::add_to_snapshot(RenderSnapshot &snapshot)
+{
+	for (GameComponent *component : components) {
+		component->add_to_snapshot(snapshot);
+	}
+
+	for (GameObject *child : children) {
+		child->add_to_snapshot(snapshot);
+	}
+}
+
 GameObject::~GameObject()
 {
 	for (GameComponent *obj : components) {
@@ -96,3 +152,14 @@ GameObject *GameObject::add_component(GameComponent *obj)
 	components.push_back(obj);
 	return this;
 }
+
+GameObject *GameObject::set_parallel(bool parallel) noexcept
+{
+	this->parallel = parallel;
+	return this;
+}
+
+bool GameObject::is_parallel() const noexcept
+{
+	return parallel;
+}
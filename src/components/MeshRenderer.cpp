@@ -7,6 +7,8 @@
 #include <graphics/Mesh.h>
 #include <graphics/Shader.h>
 #include <graphics/Material.h>
+#include <graphics/Specular.h>
+#include <graphics/RenderSnapshot.h>
 
 #include <core/SharedGlobals.h>
 #include <components/GameComponent.h>
@@ -22,6 +24,18 @@ void MeshRenderer::render(Shader &shader)
 	mesh.draw();
 }
 
+void MeshRenderer::add_to_snapshot(RenderSnapshot &snapshot)
+{
+	RenderSnapshot::Draw &draw = snapshot.draws.emplace_back();
+	draw.world = get_parent_transform()->get_transformation();
+	draw.mesh = mesh;
+	draw.diffuse = material.get_shared_property("diffuse");
+	if (Specular *specular = static_cast<Specular *>(
+		    material.get_shared_property("specular").get())) {
+		draw.specular = *specular;
+	}
+}
+
 Material &MeshRenderer::get_material()
 {
 	return material;
@@ -0,0 +1,147 @@
+#include <components/RaySensor.h>
+
+#include <components/Entity.h>
+#include <components/GameObject.h>
+
+#include <core/World.h>
+
+#include <misc/Profiler.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Every object but the owner whose broadphase AABB overlaps the query box
+struct RaySensor::CandidateCollector : btBroadphaseAabbCallback {
+	std::vector<Candidate> &candidates;
+	const btCollisionObject *ignore;
+
+	CandidateCollector(std::vector<Candidate> &candidates,
+			   const btCollisionObject *ignore)
+		: candidates(candidates)
+		, ignore(ignore)
+	{
+	}
+
+	bool process(const btBroadphaseProxy *proxy) override
+	{
+		btCollisionObject *object =
+			static_cast<btCollisionObject *>(proxy->m_clientObject);
+		if (object != ignore) {
+			candidates.push_back(
+				{ object, proxy->m_aabbMin, proxy->m_aabbMax });
+		}
+		return true;
+	}
+};
+
+// Whether from + t * delta crosses the box for some t in [0, 1], inverse
+// holds 1 / delta per axis
+static bool segment_hits_aabb(const btVector3 &from, const btVector3 &inverse,
+			      const btVector3 &min, const btVector3 &max)
+{
+	float enter = 0.0f, exit = 1.0f;
+	for (int32_t axis = 0; axis < 3; axis++) {
+		float t0 = (min[axis] - from[axis]) * inverse[axis];
+		float t1 = (max[axis] - from[axis]) * inverse[axis];
+		enter = std::max(enter, std::min(t0, t1));
+		exit = std::min(exit, std::max(t0, t1));
+	}
+	return enter <= exit;
+}
+
+RaySensor::RaySensor(Entity &owner, int32_t rays, float fov, float range)
+	: owner(owner)
+	, range(range)
+	, rays(std::max(rays, 1))
+{
+	// Entities face local -y
+	float spread = fov * float(M_PI) / 180.0f;
+	for (int32_t i = 0; i < this->rays; i++) {
+		float angle = 0.0f;
+		if (this->rays > 1)
+			angle = spread * (float(i) / (this->rays - 1) - 0.5f);
+		directions.push_back(
+			btVector3(std::sin(angle), -std::cos(angle), 0.0f));
+	}
+	readings.resize(2 * this->rays);
+}
+
+int32_t RaySensor::get_ray_count() const noexcept
+{
+	return rays;
+}
+
+const std::vector<float> &RaySensor::get_readings()
+{
+	if (stale)
+		cast();
+	return readings;
+}
+
+void RaySensor::update(float delta)
+{
+	stale = true;
+}
+
+void RaySensor::cast()
+{
+	PROFILE_FUNCTION();
+	const btRigidBody *body = owner.get_rigid_body();
+	const btTransform &pose = body->getWorldTransform();
+	btVector3 from = pose.getOrigin();
+	btVector3 reach(range, range, range);
+
+	candidates.clear();
+	CandidateCollector collector(candidates, body);
+	owner.get_world().dynamics_world->getBroadphase()->aabbTest(
+		from - reach, from + reach, collector);
+
+	btTransform from_transform, to_transform;
+	from_transform.setIdentity();
+	from_transform.setOrigin(from);
+	to_transform.setIdentity();
+
+	btCollisionWorld::ClosestRayResultCallback callback(from, from);
+	for (int32_t i = 0; i < rays; i++) {
+		btVector3 delta = (pose.getBasis() * directions[i]) * range;
+		btVector3 to = from + delta;
+		btVector3 inverse;
+		for (int32_t axis = 0; axis < 3; axis++) {
+			if (delta[axis] == 0.0f) {
+				inverse[axis] = 1e30f;
+			} else {
+				inverse[axis] = 1.0f / delta[axis];
+			}
+		}
+
+		callback.m_closestHitFraction = 1.0f;
+		callback.m_collisionObject = nullptr;
+		callback.m_rayToWorld = to;
+		to_transform.setOrigin(to);
+		for (const Candidate &candidate : candidates) {
+			if (!segment_hits_aabb(from, inverse, candidate.aabb_min,
+					       candidate.aabb_max))
+				continue;
+
+			btCollisionWorld::rayTestSingle(
+				from_transform, to_transform, candidate.object,
+				candidate.object->getCollisionShape(),
+				candidate.object->getWorldTransform(), callback);
+		}
+
+		float type = 0.0f;
+		if (callback.m_collisionObject &&
+		    callback.m_collisionObject->getUserPointer()) {
+			const GameObject *hit = static_cast<const GameObject *>(
+				callback.m_collisionObject->getUserPointer());
+			if (hit->physics_type == 20) {
+				type = 1.0f;
+			} else if (hit->physics_type == 10) {
+				type = 0.5f;
+			}
+		}
+		readings[i] = callback.m_closestHitFraction;
+		readings[rays + i] = type;
+	}
+	stale = false;
+}
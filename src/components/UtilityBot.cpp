@@ -0,0 +1,229 @@
+#include <components/UtilityBot.h>
+
+#include <ai/NavMesh.h>
+
+#include <components/Entity.h>
+
+#include <core/World.h>
+
+#include <misc/Profiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Cosine of the widest angle between the owner's forward and the player
+// the bot still shoots at
+#define aim_cos 0.95f
+// How far ahead a move is checked against the navmesh
+#define lookahead 1.0f
+// A waypoint closer than this is reached
+#define waypoint_radius 0.5f
+
+// Local directions of the moves forward, backward, left and right, the
+// entities face local -y
+static const btVector3 moves[4] = { btVector3(0.0f, -1.0f, 0.0f),
+				    btVector3(0.0f, 1.0f, 0.0f),
+				    btVector3(-1.0f, 0.0f, 0.0f),
+				    btVector3(1.0f, 0.0f, 0.0f) };
+
+// Ignores the owner's own body, which the ray starts inside
+struct IgnoreOwnerCallback : btCollisionWorld::ClosestRayResultCallback {
+	const btCollisionObject *owner;
+
+	IgnoreOwnerCallback(const btVector3 &from, const btVector3 &to,
+			    const btCollisionObject *owner)
+		: btCollisionWorld::ClosestRayResultCallback(from, to)
+		, owner(owner)
+	{
+	}
+
+	btScalar addSingleResult(btCollisionWorld::LocalRayResult &result,
+				 bool normal_in_world_space) override
+	{
+		if (result.m_collisionObject == owner)
+			return 1.0f;
+		return ClosestRayResultCallback::addSingleResult(
+			result, normal_in_world_space);
+	}
+};
+
+UtilityBot::UtilityBot(Entity &owner, int32_t decision_ticks, float range,
+		       float strafe_flip, const NavMesh *navmesh)
+	: owner(owner)
+	, decision_ticks(std::max(1, decision_ticks))
+	, range(std::max(range, 0.5f))
+	, strafe_flip(strafe_flip)
+	, navmesh(navmesh)
+{
+	// Bots built together spread their decisions over the ticks
+	ticks_left = std::uniform_int_distribution<int32_t>(
+		1, this->decision_ticks)(owner.get_world().rng);
+}
+
+UtilityBot::Behaviour UtilityBot::get_behaviour() const noexcept
+{
+	return behaviour;
+}
+
+bool UtilityBot::get_in_sight() const noexcept
+{
+	return in_sight;
+}
+
+bool UtilityBot::has_line_of_sight(Entity &target)
+{
+	const btRigidBody *body = owner.get_rigid_body();
+	btVector3 from = body->getCenterOfMassPosition();
+	btVector3 to = target.get_rigid_body()->getCenterOfMassPosition();
+
+	IgnoreOwnerCallback callback(from, to, body);
+	owner.get_world().dynamics_world->rayTest(from, to, callback);
+	return callback.hasHit() &&
+	       callback.m_collisionObject->getUserPointer() == &target;
+}
+
+void UtilityBot::decide()
+{
+	PROFILE_FUNCTION();
+	World &world = owner.get_world();
+	Entity *target = world.player_entity;
+	if (target == nullptr || target->get_hp() <= 0) {
+		behaviour = Behaviour::HOLD;
+		in_sight = false;
+		return;
+	}
+
+	const btRigidBody *body = owner.get_rigid_body();
+	btVector3 from = body->getCenterOfMassPosition();
+	btVector3 to = target->get_rigid_body()->getCenterOfMassPosition();
+	btVector3 offset = to - from;
+	offset.setZ(0.0f);
+	float distance = offset.length();
+	float health = owner.get_hp() / owner.get_max_hp();
+	in_sight = has_line_of_sight(*target);
+
+	float scores[4];
+	scores[int32_t(Behaviour::HOLD)] = 0.1f;
+	scores[int32_t(Behaviour::CHASE)] =
+		std::clamp((distance - range) / range, 0.0f, 1.0f);
+	scores[int32_t(Behaviour::RETREAT)] =
+		std::clamp((range - distance) / range, 0.0f, 1.0f) *
+		(1.5f - health);
+	float off_range = std::min(std::abs(distance - range) / range, 1.0f);
+	scores[int32_t(Behaviour::STRAFE)] =
+		in_sight ? 0.5f * (1.0f - off_range) : 0.0f;
+	behaviour = static_cast<Behaviour>(
+		std::max_element(scores, scores + 4) - scores);
+
+	// A path of two points is the straight line, chased head on
+	has_waypoint = false;
+	if (navmesh && behaviour == Behaviour::CHASE) {
+		thread_local std::vector<Vector3f> path;
+		if (navmesh->find_path({ from.x(), from.y(), from.z() },
+				       { to.x(), to.y(), to.z() }, path) &&
+		    path.size() > 2) {
+			waypoint = path[1];
+			has_waypoint = true;
+		}
+	}
+
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+	if (behaviour == Behaviour::STRAFE && chance(world.rng) < strafe_flip)
+		strafe_left = !strafe_left;
+
+	// Entities face local -y
+	btVector3 forward = body->getWorldTransform().getBasis() *
+			    btVector3(0.0f, -1.0f, 0.0f);
+	forward.setZ(0.0f);
+	if (in_sight && distance <= 2.0f * range && distance > 0.0f &&
+	    forward.dot(offset) >= aim_cos * forward.length() * distance)
+		owner.shoot();
+}
+
+int32_t UtilityBot::move_towards(const Vector3f &point) const
+{
+	const btTransform &pose = owner.get_rigid_body()->getWorldTransform();
+	btVector3 offset = btVector3(point.getX(), point.getY(), 0.0f) -
+			   pose.getOrigin();
+	offset.setZ(0.0f);
+
+	int32_t best = 0;
+	float best_dot = std::numeric_limits<float>::lowest();
+	for (int32_t move = 0; move < 4; move++) {
+		float dot = (pose.getBasis() * moves[move]).dot(offset);
+		if (dot > best_dot) {
+			best_dot = dot;
+			best = move;
+		}
+	}
+	return best;
+}
+
+bool UtilityBot::stays_on_mesh(int32_t move) const
+{
+	const btTransform &pose = owner.get_rigid_body()->getWorldTransform();
+	btVector3 ahead =
+		pose.getOrigin() + (pose.getBasis() * moves[move]) * lookahead;
+	return navmesh->is_walkable(ahead.x(), ahead.y());
+}
+
+void UtilityBot::input(float delta)
+{
+	if (--ticks_left <= 0) {
+		decide();
+		ticks_left = decision_ticks;
+	}
+
+	int32_t move;
+	switch (behaviour) {
+	case Behaviour::CHASE: {
+		if (has_waypoint) {
+			btVector3 position = owner.get_rigid_body()
+						     ->getWorldTransform()
+						     .getOrigin();
+			float dx = waypoint.getX() - position.x();
+			float dy = waypoint.getY() - position.y();
+			has_waypoint = dx * dx + dy * dy >
+				       waypoint_radius * waypoint_radius;
+		}
+		move = has_waypoint ? move_towards(waypoint) : 0;
+		break;
+	}
+	case Behaviour::RETREAT:
+		move = 1;
+		break;
+	case Behaviour::STRAFE:
+		move = strafe_left ? 2 : 3;
+		break;
+	case Behaviour::HOLD:
+	default:
+		return;
+	}
+
+	if (navmesh && !stays_on_mesh(move)) {
+		if (behaviour != Behaviour::STRAFE)
+			return;
+		strafe_left = !strafe_left;
+		move = strafe_left ? 2 : 3;
+		if (!stays_on_mesh(move))
+			return;
+	}
+
+	switch (move) {
+	case 0:
+		owner.move_forward(delta);
+		break;
+	case 1:
+		owner.move_backward(delta);
+		break;
+	case 2:
+		owner.move_left(delta);
+		break;
+	case 3:
+		owner.move_right(delta);
+		break;
+	}
+}
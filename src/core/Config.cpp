@@ -0,0 +1,151 @@
+#include <core/Config.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+
+static std::string trim(const std::string &str)
+{
+	size_t begin = str.find_first_not_of(" \t\r\n");
+	if (begin == std::string::npos)
+		return "";
+	size_t end = str.find_last_not_of(" \t\r\n");
+	return str.substr(begin, end - begin + 1);
+}
+
+Config &Config::get_instance()
+{
+	static Config instance;
+	return instance;
+}
+
+Config::Config()
+	: values{}
+{
+}
+
+std::string Config::make_key(const std::string &section,
+			     const std::string &key)
+{
+	return section + '.' + key;
+}
+
+bool Config::load(const std::string &config_file)
+{
+	std::ifstream file(config_file);
+	if (!file.is_open()) {
+		std::cerr << "Warning: Unable to open config file: "
+			  << config_file << "\r\n";
+		return false;
+	}
+
+	std::string line, section;
+	while (std::getline(file, line)) {
+		line = trim(line);
+		if (line.empty() || line[0] == '#' || line[0] == ';')
+			continue;
+
+		if (line.front() == '[' && line.back() == ']') {
+			section = trim(line.substr(1, line.size() - 2));
+			continue;
+		}
+
+		size_t eq = line.find('=');
+		if (eq == std::string::npos)
+			continue;
+
+		set(section, trim(line.substr(0, eq)),
+		    trim(line.substr(eq + 1)));
+	}
+
+	return true;
+}
+
+void Config::parse_args(int argc, char const *argv[])
+{
+	for (int32_t i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--headless") {
+			set("Engine", "headless", "1");
+			continue;
+		}
+		if (!arg.starts_with("--"))
+			continue;
+
+		size_t dot = arg.find('.'), eq = arg.find('=');
+		if (dot == std::string::npos || eq == std::string::npos ||
+		    eq < dot)
+			continue;
+
+		set(arg.substr(2, dot - 2), arg.substr(dot + 1, eq - dot - 1),
+		    arg.substr(eq + 1));
+	}
+}
+
+void Config::set(const std::string &section, const std::string &key,
+		 const std::string &value)
+{
+	values[make_key(section, key)] = value;
+}
+
+bool Config::has(const std::string &section,
+		 const std::string &key) const noexcept
+{
+	return values.count(make_key(section, key));
+}
+
+std::string Config::get_string(const std::string &section,
+			       const std::string &key,
+			       const std::string &fallback) const
+{
+	auto it = values.find(make_key(section, key));
+	if (it == values.end())
+		return fallback;
+	return it->second;
+}
+
+int32_t Config::get_int(const std::string &section, const std::string &key,
+			int32_t fallback) const
+{
+	auto it = values.find(make_key(section, key));
+	if (it == values.end())
+		return fallback;
+	try {
+		return std::stoi(it->second);
+	} catch (const std::exception &) {
+		std::cerr << "Warning: Invalid integer for " << it->first
+			  << ": " << it->second << "\r\n";
+		return fallback;
+	}
+}
+
+double Config::get_double(const std::string &section, const std::string &key,
+			  double fallback) const
+{
+	auto it = values.find(make_key(section, key));
+	if (it == values.end())
+		return fallback;
+	try {
+		return std::stod(it->second);
+	} catch (const std::exception &) {
+		std::cerr << "Warning: Invalid number for " << it->first
+			  << ": " << it->second << "\r\n";
+		return fallback;
+	}
+}
+
+bool Config::get_bool(const std::string &section, const std::string &key,
+		      bool fallback) const
+{
+	auto it = values.find(make_key(section, key));
+	if (it == values.end())
+		return fallback;
+
+	std::string value = it->second;
+	std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+	return value == "1" || value == "true" || value == "yes" ||
+	       value == "on";
+}
@@ -5,18 +5,27 @@
 
 #include <graphics/Shader.h>
 #include <graphics/RenderingEngine.h>
+#include <graphics/DamageTextures.h>
 
 #include <core/Input.h>
 #include <core/Timer.h>
+#include <core/Config.h>
+#include <core/FramePacer.h>
+#include <core/JobSystem.h>
+#include <core/RenderThread.h>
 
 #include <components/BaseCamera.h>
 #include <core/SharedGlobals.h>
 
 #include <game/TestGame.h>
 
+#include <misc/Profiler.h>
+
+#include <cmath>
 #include <iostream>
 #include <algorithm>
 #include <exception>
+#include <random>
 #include <string>
 
 #ifdef MULTIPLAYER
@@ -69,10 +78,41 @@ void mouse_scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 }
 
 Engine::Engine()
-	: game(new TestGame())
-	, window(Window::get_instance())
+	: headless(Config::get_instance().get_bool("Engine", "headless"))
+	, render_thread(
+		  Config::get_instance().get_bool("Engine", "render_thread", true))
+	, pacing_stats(Config::get_instance().get_bool("Engine", "pacing_stats"))
 {
-	if (!glfwInit()) {
+	Config &config = Config::get_instance();
+	FRAME_CAP = config.get_double("Engine", "frame_cap", FRAME_CAP);
+	UNFOCUSED_FRAME_CAP = config.get_double(
+		"Engine", "unfocused_frame_cap", UNFOCUSED_FRAME_CAP);
+#ifndef MULTIPLAYER
+	// Both peers of a match must simulate at the same rate
+	TICK_RATE = config.get_double("Engine", "tick_rate", TICK_RATE);
+#endif
+	MAX_SUBSTEPS = std::max(
+		1, config.get_int("Engine", "max_substeps", MAX_SUBSTEPS));
+	worlds = std::max(1, config.get_int("Engine", "worlds", worlds));
+	// -1 seeds every run differently
+	int32_t seed = config.get_int("Engine", "seed", -1);
+	this->seed = seed < 0 ? std::random_device{}() : seed;
+	FramePacer::get_instance().set_spin_time(
+		config.get_int("Engine", "pacer_spin_us", 300) * 1e-6);
+
+	profile_output =
+		config.get_string("Profiler", "output", "profile.json");
+	Profiler::get_instance().configure(
+		config.get_bool("Profiler", "enabled"),
+		std::max(1, config.get_int("Profiler", "frames", 300)));
+	PROFILE_THREAD("Main");
+
+	// Pixel observations need a context without a display, GLFW's null
+	// platform creates it through EGL (surfaceless Mesa or a pbuffer)
+	offscreen = headless && config.get_bool("Vision", "enabled");
+	if (offscreen)
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+	if ((!headless || offscreen) && !glfwInit()) {
 		std::cerr << "Error: Failed to initialize GLFW\r\n";
 		throw std::runtime_error(
 			"Error: Failed to initialize GLFW\r\n");
@@ -81,6 +121,21 @@ Engine::Engine()
 		std::cerr << "Error: Engine Already Created\r\n";
 		throw std::runtime_error("Error: Engine Already Created\r\n");
 	}
+	SharedGlobals::get_instance().headless = headless && !offscreen;
+	SharedGlobals::get_instance().offscreen = offscreen;
+	if (!headless && worlds > 1) {
+		std::cerr << "Warning: Multiple worlds need headless mode, "
+			     "running one\r\n";
+		worlds = 1;
+	}
+	// 0 keeps the whole scene update on this thread, -1 uses every core
+	JobSystem::get_instance().init(
+		config.get_int("Engine", "worker_threads", 0));
+	if (!headless || offscreen) {
+		window = &Window::get_instance();
+	}
+	game = new TestGame();
+
 	paused = false;
 	this->running = false;
 	Engine::created = true;
@@ -88,92 +143,209 @@ Engine::Engine()
 
 Engine::~Engine()
 {
+	RenderThread::get_instance().stop();
+	JobSystem::get_instance().shutdown();
+	this->cleanup();
+}
+
+void Engine::create_worlds()
+{
+	PROFILE_SCOPE("Game::init");
+	game->create_worlds(worlds, seed);
+}
+
+void Engine::run_headless()
+{
+	Profiler &profiler = Profiler::get_instance();
+	create_worlds();
+	profiler.end_startup();
+
+	// Simulated time advances by one fixed tick per iteration, so the loop
+	// runs as fast as the game logic allows instead of waiting on the cap
+	double tick_time = 1.0 / this->TICK_RATE;
+
+	while (this->running) {
+		game->tick(tick_time);
+		PROFILE_FRAME();
+	}
+
+	if (profiler.is_enabled())
+		profiler.dump(profile_output);
 	this->cleanup();
 }
 
 void Engine::run()
 {
+	if (headless) {
+		this->run_headless();
+		return;
+	}
+
 	Timer &timer = Timer::get_instance();
-	game->init();
+	FramePacer &pacer = FramePacer::get_instance();
+	Profiler &profiler = Profiler::get_instance();
+	create_worlds();
 	RenderingEngine &rendering_engine = RenderingEngine::get_instance();
+	RenderThread &renderer = RenderThread::get_instance();
 #ifdef MULTIPLAYER
 	MatchMaking &MM = MatchMaking::get_instance();
 #endif
+	// Everything that needs GL at load time has been created by now
+	if (render_thread) {
+		renderer.start(window);
+	}
 
 	int32_t frames = 0;
 	double frame_counter = 0;
-	double frame_time = 1.0f / this->FRAME_CAP;
+	double accumulator = 0;
+	double tick_time = 1.0 / this->TICK_RATE;
 	// glfwSwapInterval(0); // Disable Vsync
 
+	pacer.set_frame_time(this->FRAME_CAP > 0 ? 1.0 / this->FRAME_CAP : 0);
+	// Never throttle below the rate the substep limit can keep up with,
+	// or the simulation would fall behind while unfocused
+	if (this->UNFOCUSED_FRAME_CAP > 0) {
+		pacer.set_throttled_frame_time(
+			std::min(1.0 / this->UNFOCUSED_FRAME_CAP,
+				 this->MAX_SUBSTEPS * tick_time));
+	}
+
+	profiler.end_startup();
+	bool capture_key = false;
+
 	timer.reset();
+	pacer.reset();
 
 	while (this->running
 #ifdef MULTIPLAYER
 	       && MM.is_match_running()
 #endif
 	) {
-		glfwPollEvents();
+		{
+			PROFILE_SCOPE("glfwPollEvents");
+			glfwPollEvents();
+		}
 #ifndef MULTIPLAYER
 		// if (paused) {
 		// 	timer.reset();
 		// 	continue;
 		// }
 #endif
-		bool render_frame = false;
-
-		while (timer.can_render_frame(frame_time)) {
-			render_frame = true;
-			if (window.should_close()) {
+		timer.update_delta_time();
+		accumulator += timer.get_delta_time();
+		frame_counter += timer.get_delta_time();
+
+		int32_t substeps = 0;
+		while (accumulator >= tick_time) {
+			// Drop the backlog instead of falling further behind when
+			// ticks take longer to simulate than they cover
+			if (substeps == this->MAX_SUBSTEPS) {
+				accumulator = std::fmod(accumulator, tick_time);
+				break;
+			}
+			if (window->should_close()) {
 				this->stop();
 			}
 
-			game->input(frame_time);
-			game->update(frame_time);
-			SharedGlobals::get_instance().increment_tick();
+			PROFILE_SCOPE("tick");
+			game->tick(tick_time);
 
-			frame_counter += timer.get_delta_time();
+			accumulator -= tick_time;
+			substeps++;
+		}
 
-			if (frame_counter >= 1) {
+		if (frame_counter >= 1) {
 #if _DEBUG_FPS_ON
-				std::cout << "FPS: " << frames << ' '
-					  << frame_counter << "\r\n";
+			std::cout << "FPS: " << frames << ' ' << frame_counter
+				  << "\r\n";
 #endif
-				frames = 0;
-				frame_counter = 0;
+			if (pacing_stats) {
+				FramePacer::Stats stats = pacer.get_stats();
+				std::cout << "Pacing: frames " << stats.frames
+					  << " late " << stats.late_frames
+					  << " error(us) mean "
+					  << stats.mean_error * 1e6 << " sd "
+					  << stats.stddev_error * 1e6 << " min "
+					  << stats.min_error * 1e6 << " max "
+					  << stats.max_error * 1e6 << "\r\n";
+				pacer.reset_stats();
 			}
+			frames = 0;
+			frame_counter = 0;
 		}
 
-		if (render_frame) {
+		game->interpolate(accumulator / tick_time);
+		if (render_thread) {
+			{
+				PROFILE_SCOPE("Game::snapshot");
+				game->snapshot(renderer.get_write_snapshot());
+			}
+			game->interpolate(1.0f);
+			PROFILE_SCOPE("RenderThread::submit");
+			renderer.submit();
+		} else {
 			rendering_engine.render(game->get_root_object());
-			window.swap_buffers();
-			frames++;
+			game->interpolate(1.0f);
+			PROFILE_SCOPE("swap_buffers");
+			window->swap_buffers();
+		}
+		frames++;
+
+		{
+			PROFILE_SCOPE("FramePacer::wait");
+			pacer.wait(paused);
 		}
+		PROFILE_FRAME();
+
+		// F9 writes out the frames currently held by the profiler
+		bool capture_pressed =
+			input_handler.is_key_pressed(GLFW_KEY_F9);
+		if (capture_pressed && !capture_key && profiler.is_enabled())
+			profiler.dump(profile_output);
+		capture_key = capture_pressed;
 	}
 
+	if (profiler.is_enabled())
+		profiler.dump(profile_output);
+
+	renderer.stop();
 	this->cleanup();
 }
 
 void Engine::start()
 {
-	if (!window.gl_create_window()) {
+	if (running) {
+		std::cerr << "Error: Engine Already Running\r\n";
+		throw std::runtime_error("Engine Already Running\r\n");
+	}
+	if (headless) {
+		if (offscreen && !(window->gl_create_offscreen() &&
+				   window->set_window_context())) {
+			std::cerr
+				<< "Error: Failed to create offscreen context\r\n";
+			throw std::runtime_error(
+				"Failed to create offscreen context\r\n");
+		}
+		running = true;
+		this->run();
+		return;
+	}
+
+	if (!window->gl_create_window()) {
 		std::cerr << "Error: Failed to create window\r\n";
 		throw std::runtime_error("Failed to create window\r\n");
 	}
-	if (!window.set_window_context()) {
+	if (!window->set_window_context()) {
 		std::cerr << "Error: Failed to set window context\r\n";
 		throw std::runtime_error("Failed to set window context\r\n");
 	}
-	if (running) {
-		std::cerr << "Error: Engine Already Running\r\n";
-		throw std::runtime_error("Engine Already Running\r\n");
-	}
 
-	window.set_key_callback(key_callback);
-	window.set_mouse_callback(mouse_motion_callback, mouse_button_callback,
-				  mouse_scroll_callback);
-	window.set_focus_callback(handle_window_focus);
-	window.set_close_callback(handle_window_close);
-	SharedGlobals::get_instance().window = static_cast<void *>(&window);
+	window->set_key_callback(key_callback);
+	window->set_mouse_callback(mouse_motion_callback, mouse_button_callback,
+				   mouse_scroll_callback);
+	window->set_focus_callback(handle_window_focus);
+	window->set_close_callback(handle_window_close);
+	SharedGlobals::get_instance().window = static_cast<void *>(window);
 	running = true;
 	this->run();
 }
@@ -185,11 +357,14 @@ void Engine::stop()
 
 void Engine::cleanup()
 {
-	window.terminate_window();
+	if (window == nullptr)
+		return;
+	DamageTextures::get_instance().release();
+	window->terminate_window();
 	glfwTerminate();
 }
 
 Window &Engine::get_window() const noexcept
 {
-	return window;
+	return *window;
 }
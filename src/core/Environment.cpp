@@ -0,0 +1,114 @@
+#include <core/Environment.h>
+
+#include <core/Config.h>
+#include <core/JobSystem.h>
+#include <core/SharedGlobals.h>
+
+#include <game/TestGame.h>
+
+#include <misc/Profiler.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+bool Environment::created = false;
+
+Environment::Environment(const std::string &config_file, int32_t argc,
+			 char const *argv[])
+{
+	if (Environment::created) {
+		std::cerr << "Error: Environment Already Created\r\n";
+		throw std::runtime_error("Environment Already Created");
+	}
+
+	Config &config = Config::get_instance();
+	config.load(config_file);
+	config.parse_args(argc, argv);
+	config.set("Engine", "headless", "1");
+	SharedGlobals::get_instance().headless = true;
+
+	tick_time = 1.0 / config.get_double("Engine", "tick_rate", 60.0);
+	int32_t worlds = std::max(1, config.get_int("Engine", "worlds", 1));
+	int32_t seed = config.get_int("Engine", "seed", -1);
+	JobSystem::get_instance().init(
+		config.get_int("Engine", "worker_threads", 0));
+
+	game = std::make_unique<TestGame>(true);
+	game->create_worlds(worlds,
+			    seed < 0 ? std::random_device{}() : seed);
+	Environment::created = true;
+}
+
+Environment::~Environment()
+{
+	game.reset();
+	JobSystem::get_instance().shutdown();
+	Environment::created = false;
+}
+
+size_t Environment::get_agent_count() const noexcept
+{
+	return game->get_agent_count();
+}
+
+size_t Environment::get_step_size() const noexcept
+{
+	return 3 + game->get_observation_size();
+}
+
+void Environment::run()
+{
+	do {
+		game->tick(tick_time);
+		PROFILE_FRAME();
+	} while (!game->steps_done());
+}
+
+void Environment::reset(int32_t reward_mode)
+{
+	RLProtocol::Command command;
+	command.type = RLProtocol::Command::Type::RESET;
+	command.action = reward_mode;
+	// Every agent, so each has a step to read back. Restoring a world
+	// again before it ticks changes nothing
+	for (size_t i = 0; i < game->get_agent_count(); i++) {
+		game->submit(i, command);
+	}
+	run();
+}
+
+void Environment::step(const int32_t *actions, size_t count)
+{
+	if (count != game->get_agent_count()) {
+		std::cerr << "Error: " << count << " actions for "
+			  << game->get_agent_count() << " agents\r\n";
+		throw std::runtime_error("Action count mismatch");
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		RLProtocol::Command command;
+		command.type = actions[i] == RESET ?
+				       RLProtocol::Command::Type::RESET :
+				       RLProtocol::Command::Type::ACTION;
+		command.action = actions[i];
+		game->submit(i, command);
+	}
+	run();
+}
+
+void Environment::observe(float *out) const
+{
+	for (size_t i = 0; i < game->get_agent_count(); i++) {
+		const RLProtocol::AgentStep &step = game->get_step(i);
+		out[0] = step.reward;
+		out[1] = step.terminated;
+		out[2] = step.truncated;
+		// A step that never ran has no observation yet
+		std::fill(out + 3, out + get_step_size(), 0.0f);
+		std::copy(step.observation.begin(), step.observation.end(),
+			  out + 3);
+		out += get_step_size();
+	}
+}
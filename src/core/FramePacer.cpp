@@ -0,0 +1,105 @@
+#include <core/FramePacer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+FramePacer &FramePacer::get_instance()
+{
+	static FramePacer instance;
+	return instance;
+}
+
+FramePacer::FramePacer()
+{
+}
+
+void FramePacer::set_frame_time(double frame_time) noexcept
+{
+	this->frame_time = std::max(0.0, frame_time);
+}
+
+void FramePacer::set_throttled_frame_time(double frame_time) noexcept
+{
+	throttled_frame_time = std::max(0.0, frame_time);
+}
+
+void FramePacer::set_spin_time(double spin_time) noexcept
+{
+	this->spin_time = std::max(0.0, spin_time);
+}
+
+void FramePacer::reset() noexcept
+{
+	scheduled = false;
+}
+
+void FramePacer::wait(bool throttled)
+{
+	double budget = frame_time;
+	if (throttled)
+		budget = std::max(budget, throttled_frame_time);
+
+	if (budget <= 0.0) {
+		scheduled = false;
+		return;
+	}
+
+	clock::time_point now = clock::now();
+	auto step = std::chrono::duration_cast<clock::duration>(
+		std::chrono::duration<double>(budget));
+
+	// Start a new schedule after a reset or a stall longer than a frame
+	// instead of rushing through the missed deadlines
+	if (!scheduled || now - deadline > step) {
+		deadline = now;
+		scheduled = true;
+	}
+	deadline += step;
+
+	auto spin = std::chrono::duration_cast<clock::duration>(
+		std::chrono::duration<double>(spin_time));
+	if (deadline - now > spin)
+		std::this_thread::sleep_until(deadline - spin);
+
+	while ((now = clock::now()) < deadline) {
+		std::this_thread::yield();
+	}
+
+	record(std::chrono::duration<double>(now - deadline).count());
+}
+
+void FramePacer::record(double error) noexcept
+{
+	if (frames == 0) {
+		max_error = min_error = error;
+	}
+	frames++;
+	late_frames += error > spin_time;
+	max_error = std::max(max_error, error);
+	min_error = std::min(min_error, error);
+
+	double delta = error - mean;
+	mean += delta / frames;
+	m2 += delta * (error - mean);
+}
+
+FramePacer::Stats FramePacer::get_stats() const noexcept
+{
+	Stats stats;
+	stats.frames = frames;
+	stats.late_frames = late_frames;
+	stats.mean_error = mean;
+	stats.max_error = max_error;
+	stats.min_error = min_error;
+	stats.stddev_error = frames > 1 ? std::sqrt(m2 / (frames - 1)) : 0.0;
+	return stats;
+}
+
+void FramePacer::reset_stats() noexcept
+{
+	frames = late_frames = 0;
+	mean = m2 = 0.0;
+	max_error = min_error = 0.0;
+}
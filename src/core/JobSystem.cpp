@@ -0,0 +1,163 @@
+#include <core/JobSystem.h>
+
+#include <misc/Profiler.h>
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <utility>
+
+thread_local int32_t JobSystem::thread_index = 0;
+
+JobSystem &JobSystem::get_instance()
+{
+	static JobSystem instance;
+	return instance;
+}
+
+JobSystem::JobSystem()
+{
+	queues.push_back(std::make_unique<WorkQueue>());
+}
+
+JobSystem::~JobSystem()
+{
+	shutdown();
+}
+
+void JobSystem::init(int32_t worker_count)
+{
+	if (running)
+		return;
+
+	if (worker_count < 0) {
+		worker_count = std::max<int32_t>(
+			0, static_cast<int32_t>(
+				   std::thread::hardware_concurrency()) -
+				   1);
+	}
+
+	running = true;
+	for (int32_t i = 1; i <= worker_count; i++) {
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+	for (int32_t i = 1; i <= worker_count; i++) {
+		workers.emplace_back(&JobSystem::worker_loop, this, i);
+	}
+}
+
+void JobSystem::shutdown()
+{
+	if (!running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		running = false;
+	}
+	sleep_cond.notify_all();
+	for (std::thread &worker : workers) {
+		if (worker.joinable())
+			worker.join();
+	}
+	workers.clear();
+	queues.resize(1);
+}
+
+int32_t JobSystem::get_worker_count() const noexcept
+{
+	return static_cast<int32_t>(workers.size());
+}
+
+void JobSystem::run(Job job, Counter *counter)
+{
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+	// Nothing to fan out to, run inline
+	if (workers.empty()) {
+		job();
+		if (counter)
+			counter->pending.fetch_sub(1,
+						   std::memory_order_release);
+		return;
+	}
+
+	WorkQueue &queue = *queues[thread_index];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.emplace_back(std::move(job), counter);
+	}
+	queued.fetch_add(1, std::memory_order_release);
+	sleep_cond.notify_one();
+}
+
+void JobSystem::wait(Counter &counter)
+{
+	while (!counter.done()) {
+		if (!try_execute())
+			std::this_thread::yield();
+	}
+}
+
+bool JobSystem::pop(int32_t index, std::pair<Job, Counter *> &job)
+{
+	WorkQueue &queue = *queues[index];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty())
+		return false;
+
+	job = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	return true;
+}
+
+bool JobSystem::steal(int32_t index, std::pair<Job, Counter *> &job)
+{
+	int32_t count = static_cast<int32_t>(queues.size());
+	for (int32_t i = 1; i < count; i++) {
+		WorkQueue &queue = *queues[(index + i) % count];
+		std::unique_lock<std::mutex> lock(queue.mutex,
+						  std::try_to_lock);
+		if (!lock.owns_lock() || queue.jobs.empty())
+			continue;
+
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::try_execute()
+{
+	std::pair<Job, Counter *> job;
+	if (!pop(thread_index, job) && !steal(thread_index, job))
+		return false;
+
+	queued.fetch_sub(1, std::memory_order_relaxed);
+	job.first();
+	if (job.second)
+		job.second->pending.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void JobSystem::worker_loop(int32_t index)
+{
+	thread_index = index;
+	PROFILE_THREAD("Worker " + std::to_string(index));
+	while (running) {
+		if (try_execute())
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleep_cond.wait_for(lock, std::chrono::milliseconds(1), [this] {
+			return !running ||
+			       queued.load(std::memory_order_acquire) > 0;
+		});
+	}
+}
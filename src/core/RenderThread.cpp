@@ -0,0 +1,140 @@
+#include <core/RenderThread.h>
+
+#include <core/Window.h>
+
+#include <graphics/RenderSnapshot.h>
+#include <graphics/RenderingEngine.h>
+
+#include <misc/Profiler.h>
+
+#include <iostream>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+RenderThread &RenderThread::get_instance()
+{
+	static RenderThread instance;
+	return instance;
+}
+
+RenderThread::RenderThread()
+{
+}
+
+RenderThread::~RenderThread()
+{
+	stop();
+}
+
+void RenderThread::start(Window *window)
+{
+	if (running) {
+		std::cerr << "Error: Render Thread Already Running\r\n";
+		throw std::runtime_error("Render Thread Already Running\r\n");
+	}
+
+	this->window = window;
+	write_index = 0;
+	pending_index = -1;
+	rendering = false;
+	error = nullptr;
+
+	window->make_context_current(false);
+	running = true;
+	thread = std::thread(&RenderThread::render_loop, this);
+}
+
+void RenderThread::stop()
+{
+	if (!thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	cond.notify_all();
+	thread.join();
+
+	// Hand the context back for cleanup on the calling thread
+	window->make_context_current(true);
+}
+
+bool RenderThread::is_running() const noexcept
+{
+	return running;
+}
+
+RenderSnapshot &RenderThread::get_write_snapshot() noexcept
+{
+	return snapshots[write_index];
+}
+
+void RenderThread::submit()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	cond.wait(lock, [this] {
+		return !running || (!rendering && pending_index == -1);
+	});
+
+	if (error)
+		std::rethrow_exception(error);
+	if (!running)
+		return;
+
+	pending_index = write_index;
+	write_index ^= 1;
+	lock.unlock();
+	cond.notify_all();
+}
+
+void RenderThread::render_loop()
+{
+	PROFILE_THREAD("Render");
+	window->make_context_current(true);
+	RenderingEngine &rendering_engine = RenderingEngine::get_instance();
+
+	while (true) {
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock,
+			  [this] { return !running || pending_index != -1; });
+		if (!running)
+			break;
+
+		RenderSnapshot &snapshot = snapshots[pending_index];
+		pending_index = -1;
+		rendering = true;
+		lock.unlock();
+
+		try {
+			rendering_engine.render(snapshot);
+			// Drop the handles here, where the context is current,
+			// in case the scene has let go of the mesh or texture
+			snapshot.clear();
+			PROFILE_SCOPE("swap_buffers");
+			window->swap_buffers();
+		} catch (...) {
+			std::cerr << "Error: Render Thread stopped\r\n";
+			lock.lock();
+			error = std::current_exception();
+			running = false;
+			rendering = false;
+			lock.unlock();
+			cond.notify_all();
+			break;
+		}
+
+		lock.lock();
+		rendering = false;
+		lock.unlock();
+		cond.notify_all();
+	}
+
+	// The game thread is stopped or waiting on us, neither snapshot is
+	// being written
+	for (RenderSnapshot &snapshot : snapshots) {
+		snapshot.clear();
+	}
+	window->make_context_current(false);
+}
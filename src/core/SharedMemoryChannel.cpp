@@ -0,0 +1,229 @@
+#include <core/SharedMemoryChannel.h>
+
+#include <core/RLProtocol.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Busy checks before sleeping, a few microseconds on current hardware
+constexpr int32_t SPIN_COUNT = 4096;
+constexpr long SLEEP_TIMEOUT_NS = 100'000'000;
+
+static inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+// Shared futexes, the words live in memory mapped by another process.
+// Returns false when the timeout ran out
+static bool futex_wait(std::atomic<uint32_t> &word, uint32_t value,
+		       const timespec *timeout)
+{
+	return syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word),
+		       FUTEX_WAIT, value, timeout, nullptr, 0) == 0 ||
+	       errno != ETIMEDOUT;
+}
+
+static void futex_wake(std::atomic<uint32_t> &word)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, 1,
+		nullptr, nullptr, 0);
+}
+
+SharedMemoryChannel::SharedMemoryChannel()
+{
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+	close();
+}
+
+void SharedMemoryChannel::open(const std::string &name, int32_t liveness_fd)
+{
+	int32_t fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (fd < 0) {
+		std::cerr << "Error: Unable to open shared memory: " << name
+			  << "\r\n";
+		throw std::runtime_error("Unable to open shared memory");
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) < 0 ||
+	    static_cast<size_t>(info.st_size) < sizeof(Segment)) {
+		::close(fd);
+		std::cerr << "Error: Shared memory too small: " << name
+			  << "\r\n";
+		throw std::runtime_error("Shared memory too small");
+	}
+
+	void *memory = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE,
+			    MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED) {
+		throw std::runtime_error("Unable to map shared memory");
+	}
+
+	Segment *mapped = static_cast<Segment *>(memory);
+	if (mapped->magic != MAGIC || mapped->version != VERSION ||
+	    mapped->capacity != CAPACITY || mapped->slot_size != SLOT_SIZE) {
+		munmap(memory, sizeof(Segment));
+		std::cerr << "Error: Unsupported shared memory layout: "
+			  << name << "\r\n";
+		throw std::runtime_error("Unsupported shared memory layout");
+	}
+
+	segment = mapped;
+	this->liveness_fd = liveness_fd;
+	std::cout << "Mapped shared memory " << name << "\r\n";
+}
+
+void SharedMemoryChannel::close()
+{
+	if (segment == nullptr)
+		return;
+
+	// Wake the agent wherever it is blocked so it sees the flag
+	segment->closed.store(1);
+	futex_wake(segment->to_agent.head);
+	futex_wake(segment->to_engine.tail);
+
+	munmap(segment, sizeof(Segment));
+	segment = nullptr;
+}
+
+bool SharedMemoryChannel::is_open() const noexcept
+{
+	return segment != nullptr;
+}
+
+void SharedMemoryChannel::send(const uint8_t *message, size_t size)
+{
+	if (segment == nullptr) {
+		throw std::runtime_error("Shared memory not initialized");
+	}
+	if (size > SLOT_SIZE) {
+		throw std::runtime_error("Message too long for shared memory");
+	}
+
+	Ring &ring = segment->to_agent;
+	uint32_t head = ring.head.load(std::memory_order_relaxed);
+	while (head - ring.tail.load(std::memory_order_acquire) == CAPACITY) {
+		wait(ring.tail, ring.producer_waiting, head - CAPACITY);
+	}
+
+	std::memcpy(ring.slots[head % CAPACITY], message, size);
+	ring.head.store(head + 1, std::memory_order_seq_cst);
+	if (ring.consumer_waiting.load(std::memory_order_seq_cst))
+		futex_wake(ring.head);
+}
+
+size_t SharedMemoryChannel::receive(uint8_t *message, size_t capacity)
+{
+	if (segment == nullptr) {
+		throw std::runtime_error("Shared memory not initialized");
+	}
+
+	Ring &ring = segment->to_engine;
+	uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+	while (ring.head.load(std::memory_order_acquire) == tail) {
+		wait(ring.head, ring.consumer_waiting, tail);
+	}
+	return pop(message, capacity);
+}
+
+size_t SharedMemoryChannel::try_receive(uint8_t *message, size_t capacity)
+{
+	if (segment == nullptr) {
+		throw std::runtime_error("Shared memory not initialized");
+	}
+
+	Ring &ring = segment->to_engine;
+	if (ring.head.load(std::memory_order_acquire) ==
+	    ring.tail.load(std::memory_order_relaxed)) {
+		if (segment->closed.load()) {
+			throw std::runtime_error("Connection closed by server");
+		}
+		return 0;
+	}
+	return pop(message, capacity);
+}
+
+// Caller made sure the ring is not empty
+size_t SharedMemoryChannel::pop(uint8_t *message, size_t capacity)
+{
+	Ring &ring = segment->to_engine;
+	uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+	const uint8_t *slot = ring.slots[tail % CAPACITY];
+	RLProtocol::Header header = RLProtocol::decode_header(slot);
+	size_t size = std::min<size_t>(RLProtocol::HEADER_SIZE + header.length,
+				       SLOT_SIZE);
+	if (size > capacity) {
+		throw std::runtime_error("Agent message too long");
+	}
+	std::memcpy(message, slot, size);
+
+	ring.tail.store(tail + 1, std::memory_order_seq_cst);
+	if (ring.producer_waiting.load(std::memory_order_seq_cst))
+		futex_wake(ring.tail);
+	return size;
+}
+
+// Returns once word no longer holds value, or throws if the agent is gone
+void SharedMemoryChannel::wait(std::atomic<uint32_t> &word,
+			       std::atomic<uint32_t> &waiting, uint32_t value)
+{
+	// Spinning only helps when the other side runs on another core
+	static const int32_t spin_count =
+		std::thread::hardware_concurrency() > 1 ? SPIN_COUNT : 0;
+	for (int32_t i = 0; i < spin_count; i++) {
+		if (word.load(std::memory_order_acquire) != value)
+			return;
+		cpu_relax();
+	}
+
+	const timespec timeout = { 0, SLEEP_TIMEOUT_NS };
+	while (word.load(std::memory_order_acquire) == value) {
+		waiting.store(1, std::memory_order_seq_cst);
+		// The kernel rechecks the word, a wake between the load and
+		// the sleep is not lost
+		bool woken = futex_wait(word, value, &timeout);
+		waiting.store(0, std::memory_order_relaxed);
+		if (segment->closed.load()) {
+			throw std::runtime_error("Connection closed by server");
+		}
+		if (!woken)
+			check_alive();
+	}
+}
+
+// Only polled after a quiet timeout, the agent may have died without
+// setting the closed flag
+void SharedMemoryChannel::check_alive()
+{
+	if (liveness_fd == -1)
+		return;
+
+	pollfd fd = { liveness_fd, POLLRDHUP, 0 };
+	if (poll(&fd, 1, 0) > 0 &&
+	    (fd.revents & (POLLRDHUP | POLLHUP | POLLERR))) {
+		throw std::runtime_error("Connection closed by server");
+	}
+}
@@ -16,7 +16,6 @@ Timer::Timer()
 void Timer::reset()
 {
 	last_time = std::chrono::high_resolution_clock::now();
-	passed_time = 0.0;
 	delta_time = 0.0;
 }
 
@@ -32,14 +31,3 @@ double Timer::get_delta_time() const noexcept
 {
 	return delta_time;
 }
-
-bool Timer::can_render_frame(const double FRAME_TIME) noexcept
-{
-	update_delta_time();
-	passed_time += delta_time;
-	if (passed_time >= FRAME_TIME) {
-		passed_time -= FRAME_TIME;
-		return true;
-	}
-	return false;
-}
@@ -10,6 +10,8 @@
 #include <core/SharedGlobals.h>
 #include <components/BaseCamera.h>
 
+#include <graphics/RenderingEngine.h>
+
 #include <iostream>
 #include <cstdlib>
 #include <exception>
@@ -33,7 +35,7 @@ void framebuffer_size_callback(GLFWwindow *window, int32_t width,
 	SharedGlobals::get_instance().w_height = height;
 	SharedGlobals::get_instance().w_width = width;
 	SharedGlobals::get_instance().resized = true;
-	glViewport(0, 0, width, height);
+	RenderingEngine::set_viewport(width, height);
 }
 
 bool Window::gl_create_window()
@@ -53,6 +55,27 @@ bool Window::gl_create_window()
 	return true;
 }
 
+bool Window::gl_create_offscreen()
+{
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	// Rendering goes to framebuffer objects, the window's own surface is
+	// never drawn to
+	this->window = glfwCreateWindow(1, 1, "Engine", nullptr, nullptr);
+
+	if (window == nullptr) {
+		std::cerr << "Failed to create offscreen GLFW context\r\n";
+		glfwTerminate();
+		return false;
+	}
+
+	return true;
+}
+
 bool Window::set_window_context()
 {
 	glfwMakeContextCurrent(this->window);
@@ -65,6 +88,13 @@ bool Window::set_window_context()
 	return true;
 }
 
+// A context can be current on one thread at a time, release it before
+// another thread takes it over
+void Window::make_context_current(bool current)
+{
+	glfwMakeContextCurrent(current ? this->window : nullptr);
+}
+
 void Window::terminate_window()
 {
 	if (this->window != nullptr) {
@@ -0,0 +1,265 @@
+#include <core/World.h>
+
+#include <components/GameObject.h>
+#include <components/Entity.h>
+
+#include <physics/Collision.h>
+
+#include <misc/Profiler.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <unordered_set>
+
+thread_local World *World::current_world = nullptr;
+
+static void collision_near_callback(btBroadphasePair &collisionPair,
+				    btCollisionDispatcher &dispatcher,
+				    const btDispatcherInfo &dispatchInfo)
+{
+	const btCollisionObject *colObj0 =
+		static_cast<const btCollisionObject *>(
+			collisionPair.m_pProxy0->m_clientObject);
+	const btCollisionObject *colObj1 =
+		static_cast<const btCollisionObject *>(
+			collisionPair.m_pProxy1->m_clientObject);
+
+	GameObject *obj0 = static_cast<GameObject *>(colObj0->getUserPointer());
+	GameObject *obj1 = static_cast<GameObject *>(colObj1->getUserPointer());
+
+	if (obj0 && obj1) {
+		dispatcher.defaultNearCallback(collisionPair, dispatcher,
+					       dispatchInfo);
+		obj0->handle_collision(obj1);
+		obj1->handle_collision(obj0);
+	}
+}
+
+World::Scope::Scope(World &world) noexcept
+	: previous(current_world)
+{
+	current_world = &world;
+}
+
+World::Scope::~Scope()
+{
+	current_world = previous;
+}
+
+World::World(uint32_t seed)
+	: rng(seed)
+{
+	// Bullet initialization
+	broadphase = new btDbvtBroadphase();
+	collision_configuration = new btDefaultCollisionConfiguration();
+	dispatcher = new btCollisionDispatcher(collision_configuration);
+	solver = new btSequentialImpulseConstraintSolver();
+
+	dynamics_world = new btDiscreteDynamicsWorld(
+		dispatcher, broadphase, solver, collision_configuration);
+	dynamics_world->setGravity(btVector3(0, 0, -9.81f));
+
+	// Register collision near callback
+	dispatcher->setNearCallback(collision_near_callback);
+}
+
+World::~World()
+{
+	delete root;
+
+	// Shapes may be shared by several bodies, delete each once
+	std::unordered_set<btCollisionShape *> shapes;
+	for (int32_t i = 0; i < collision_shapes.size(); i++) {
+		shapes.insert(collision_shapes[i]);
+	}
+
+	for (int32_t i = dynamics_world->getNumCollisionObjects() - 1; i >= 0;
+	     i--) {
+		btCollisionObject *object =
+			dynamics_world->getCollisionObjectArray()[i];
+		btRigidBody *body = btRigidBody::upcast(object);
+		if (body)
+			delete body->getMotionState();
+		shapes.insert(object->getCollisionShape());
+		dynamics_world->removeCollisionObject(object);
+		delete object;
+	}
+
+	for (btCollisionShape *shape : shapes) {
+		if (shape->getShapeType() == TRIANGLE_MESH_SHAPE_PROXYTYPE) {
+			delete static_cast<btBvhTriangleMeshShape *>(shape)
+				->getMeshInterface();
+		}
+		delete shape;
+	}
+
+	delete dynamics_world;
+	delete solver;
+	delete dispatcher;
+	delete collision_configuration;
+	delete broadphase;
+}
+
+World &World::current()
+{
+	if (current_world == nullptr) {
+		std::cerr << "Error: No World is current on this thread\r\n";
+		throw std::runtime_error("No World is current on this thread");
+	}
+	return *current_world;
+}
+
+GameObject *World::get_root() noexcept
+{
+	if (root == nullptr) {
+		root = new GameObject();
+	}
+	return root;
+}
+
+void World::input(float delta)
+{
+	PROFILE_SCOPE("World::input");
+	get_root()->input(delta);
+}
+
+// delta is always the fixed tick length, so Bullet is stepped exactly once
+// per tick without its own substepping or motion state smoothing
+void World::update(float delta)
+{
+	{
+		PROFILE_SCOPE("stepSimulation");
+		dynamics_world->stepSimulation(delta, 0);
+	}
+	{
+		PROFILE_SCOPE("GameObject::update");
+		get_root()->update(delta);
+	}
+	tick = (tick + 1) % SYNC_TICK;
+}
+
+uint8_t World::get_tick() const noexcept
+{
+	return tick;
+}
+
+void World::save_vector(WorldSnapshot &snapshot, const btVector3 &vector)
+{
+	snapshot.write(vector.x());
+	snapshot.write(vector.y());
+	snapshot.write(vector.z());
+}
+
+btVector3 World::restore_vector(WorldSnapshot::Reader &reader)
+{
+	btScalar x = reader.read<btScalar>();
+	btScalar y = reader.read<btScalar>();
+	btScalar z = reader.read<btScalar>();
+	return btVector3(x, y, z);
+}
+
+// The basis as is, a quaternion round trip would not restore it bit exact
+void World::save_transform(WorldSnapshot &snapshot,
+			   const btTransform &transform)
+{
+	btScalar matrix[16];
+	transform.getOpenGLMatrix(matrix);
+	for (btScalar value : matrix) {
+		snapshot.write(value);
+	}
+}
+
+btTransform World::restore_transform(WorldSnapshot::Reader &reader)
+{
+	btScalar matrix[16];
+	for (btScalar &value : matrix) {
+		reader.read(value);
+	}
+	btTransform transform;
+	transform.setFromOpenGLMatrix(matrix);
+	return transform;
+}
+
+void World::save(WorldSnapshot &snapshot) const
+{
+	PROFILE_FUNCTION();
+	snapshot.clear();
+	snapshot.write(tick);
+	snapshot.write(rng);
+
+	int32_t count = dynamics_world->getNumCollisionObjects();
+	snapshot.write(count);
+	for (int32_t i = 0; i < count; i++) {
+		const btCollisionObject *object =
+			dynamics_world->getCollisionObjectArray()[i];
+		const btRigidBody *body = btRigidBody::upcast(object);
+		if (body == nullptr || object->isStaticObject())
+			continue;
+
+		save_transform(snapshot, body->getWorldTransform());
+		save_transform(snapshot,
+			       body->getInterpolationWorldTransform());
+		save_vector(snapshot, body->getInterpolationLinearVelocity());
+		save_vector(snapshot, body->getInterpolationAngularVelocity());
+		save_vector(snapshot, body->getLinearVelocity());
+		save_vector(snapshot, body->getAngularVelocity());
+		snapshot.write(body->getActivationState());
+		snapshot.write(body->getDeactivationTime());
+	}
+
+	snapshot.write(entities.size());
+	for (const Entity *entity : entities) {
+		entity->save_state(snapshot);
+	}
+}
+
+void World::restore(const WorldSnapshot &snapshot)
+{
+	PROFILE_FUNCTION();
+	WorldSnapshot::Reader reader(snapshot);
+	reader.read(tick);
+	reader.read(rng);
+
+	int32_t count = reader.read<int32_t>();
+	if (count != dynamics_world->getNumCollisionObjects()) {
+		std::cerr << "Error: Snapshot does not match the world\r\n";
+		throw std::runtime_error("Snapshot does not match the world");
+	}
+
+	btOverlappingPairCache *pairs = broadphase->getOverlappingPairCache();
+	for (int32_t i = 0; i < count; i++) {
+		btCollisionObject *object =
+			dynamics_world->getCollisionObjectArray()[i];
+		btRigidBody *body = btRigidBody::upcast(object);
+		if (body == nullptr || object->isStaticObject())
+			continue;
+
+		body->setWorldTransform(restore_transform(reader));
+		body->setInterpolationWorldTransform(restore_transform(reader));
+		body->setInterpolationLinearVelocity(restore_vector(reader));
+		body->setInterpolationAngularVelocity(restore_vector(reader));
+		body->setLinearVelocity(restore_vector(reader));
+		body->setAngularVelocity(restore_vector(reader));
+		body->forceActivationState(reader.read<int>());
+		body->setDeactivationTime(reader.read<btScalar>());
+		body->clearForces();
+		if (body->getMotionState())
+			body->getMotionState()->setWorldTransform(
+				body->getWorldTransform());
+
+		// Cached contacts would carry the old pose into the next step
+		pairs->cleanProxyFromPairs(body->getBroadphaseHandle(),
+					   dispatcher);
+	}
+
+	if (reader.read<size_t>() != entities.size()) {
+		std::cerr << "Error: Snapshot does not match the world\r\n";
+		throw std::runtime_error("Snapshot does not match the world");
+	}
+	for (Entity *entity : entities) {
+		entity->restore_state(reader);
+	}
+
+	dynamics_world->updateAabbs();
+	solver->reset();
+}
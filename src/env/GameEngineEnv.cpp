@@ -0,0 +1,77 @@
+#include <env/GameEngineEnv.h>
+
+#include <core/Environment.h>
+
+#include <exception>
+#include <string>
+
+static_assert(ENV_RESET == Environment::RESET);
+
+struct GameEngineEnv {
+	Environment environment;
+
+	GameEngineEnv(const char *config_file, int32_t argc, const char **argv)
+		: environment(config_file, argc, argv)
+	{
+	}
+};
+
+static thread_local std::string last_error;
+
+// Exceptions must not cross into the caller
+template <typename Function> static int32_t guard(Function function)
+{
+	try {
+		function();
+		return 0;
+	} catch (const std::exception &e) {
+		last_error = e.what();
+	} catch (...) {
+		last_error = "Unknown error";
+	}
+	return -1;
+}
+
+GameEngineEnv *env_create(const char *config_file, int32_t argc,
+			  const char **argv)
+{
+	const char *file = config_file ? config_file : "config.conf";
+	GameEngineEnv *env = nullptr;
+	guard([&] { env = new GameEngineEnv(file, argc, argv); });
+	return env;
+}
+
+void env_destroy(GameEngineEnv *env)
+{
+	delete env;
+}
+
+int32_t env_agent_count(const GameEngineEnv *env)
+{
+	return env->environment.get_agent_count();
+}
+
+int32_t env_step_size(const GameEngineEnv *env)
+{
+	return env->environment.get_step_size();
+}
+
+int32_t env_reset(GameEngineEnv *env, int32_t reward_mode)
+{
+	return guard([&] { env->environment.reset(reward_mode); });
+}
+
+int32_t env_step(GameEngineEnv *env, const int32_t *actions, int32_t n)
+{
+	return guard([&] { env->environment.step(actions, n); });
+}
+
+int32_t env_observe(const GameEngineEnv *env, float *buffer)
+{
+	return guard([&] { env->environment.observe(buffer); });
+}
+
+const char *env_last_error(void)
+{
+	return last_error.c_str();
+}
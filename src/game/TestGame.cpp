@@ -22,8 +22,15 @@
 #include <components/EnemyEntity.h>
 #include <components/Terrain.h>
 #include <components/ArcBall.h>
+#include <components/RaySensor.h>
+#include <components/UtilityBot.h>
+
+#include <core/Config.h>
+#include <core/SharedGlobals.h>
+#include <core/SocketManager.h>
 
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 
 #ifdef MULTIPLAYER
@@ -35,6 +42,10 @@
 
 #define player1_spawn { -2.5f, 5.0f, 10.0f }
 #define player2_spawn { 2.5f, 5.0f, 10.0f }
+// Further enemies line up behind the second spawn, four to a row
+#define enemy_spacing 2.5f
+// Ahead of the enemy's own mesh, so its camera does not look out from inside
+#define enemy_eye_offset { 0.0f, -1.0f, 0.5f }
 
 const std::unordered_map<std::string, std::string> mesh_assets = {
 	{ "skybox", "./assets/Skybox/fskybg/source/skybox.fbx" },
@@ -44,22 +55,113 @@ const std::unordered_map<std::string, std::string> mesh_assets = {
 	{ "mech", "./assets/objects/Main_model.fbx" }
 };
 
-TestGame::TestGame()
+TestGame::TestGame(bool in_process)
 	: Game()
 {
 	for (auto &[_, path] : mesh_assets) {
 		Mesh::pre_load(path);
 	}
 #ifndef MULTIPLAYER
-	SocketManager::get_instance().initialize("config.conf");
+	this->in_process = in_process;
+	Config &config = Config::get_instance();
+	enemy_count = std::max(1, config.get_int("Agent", "enemies", 1));
+	action_repeat =
+		std::max(1, config.get_int("Agent", "action_repeat", 1));
+	blocking = config.get_bool("Agent", "blocking", true);
+	features = config.get_bool("Agent", "features", false);
+	sensor_rays = std::max(0, config.get_int("Sensor", "rays", 0));
+	sensor_fov = config.get_double("Sensor", "fov", 120.0);
+	sensor_range = config.get_double("Sensor", "range", 30.0);
+	if (in_process) {
+		features = true;
+		return;
+	}
+	bot = config.get_bool("Bot", "enabled", false);
+	if (bot) {
+		double tick_rate =
+			config.get_double("Engine", "tick_rate", 60.0);
+		double decision_rate =
+			config.get_double("Bot", "decision_rate", 10.0);
+		bot_decision_ticks =
+			std::lround(tick_rate / std::max(decision_rate, 1e-3));
+		bot_range = config.get_double("Bot", "range", 7.5);
+		bot_strafe_flip = config.get_double("Bot", "strafe_flip", 0.2);
+
+		std::string nav_path = config.get_string("NavMesh", "file", "");
+		if (nav_path.empty())
+			return;
+		NavMesh::Settings settings;
+		settings.cell_size =
+			config.get_double("NavMesh", "cell_size", 0.25);
+		settings.agent_radius =
+			config.get_double("NavMesh", "agent_radius", 0.5);
+		settings.agent_height =
+			config.get_double("NavMesh", "agent_height", 2.0);
+		settings.max_slope =
+			config.get_double("NavMesh", "max_slope", 45.0);
+		settings.max_climb =
+			config.get_double("NavMesh", "max_climb", 0.4);
+		std::vector<float> positions;
+		std::vector<int32_t> indices;
+		Mesh::get_triangles(mesh_assets.at("arena"), positions,
+				    indices);
+		navmesh = std::make_unique<NavMesh>(NavMesh::bake(
+			positions, indices, settings, nav_path));
+		return;
+	}
+	std::string policy_path = config.get_string("Agent", "policy", "");
+	if (!policy_path.empty()) {
+		policy = std::make_unique<MLP>(MLP::load(policy_path));
+		int32_t inputs = ObservationBuilder::SIZE + 2 * sensor_rays;
+		if (policy->get_input_size() != inputs &&
+		    policy->get_input_size() != ObservationBuilder::LEGACY_SIZE) {
+			std::cerr << "Error: Policy takes "
+				  << policy->get_input_size()
+				  << " inputs, no observation has as many\r\n";
+			throw std::runtime_error("Policy input size mismatch");
+		}
+		sample = config.get_bool("Agent", "sample", false);
+		std::cout << "Enemy policy " << policy_path << " ("
+			  << MLP::get_kernel_name() << ")\r\n";
+		return;
+	}
+	SocketManager &sock_manager = SocketManager::get_instance();
+	sock_manager.initialize("config.conf");
+
+	// The engine sets up an offscreen context for [Vision] enabled
+	vision = SharedGlobals::get_instance().offscreen;
+	if (!vision)
+		return;
+	vision_width = config.get_int("Vision", "width", 84);
+	vision_height = config.get_int("Vision", "height", 84);
+	vision_channels = config.get_int("Vision", "channels", 3);
+	vision_ring = std::max(1, config.get_int("Vision", "pbo_ring", 2));
+	vision_fov = config.get_double("Vision", "fov", 90.0);
+	if (!features ||
+	    sock_manager.get_protocol() == SocketManager::Protocol::TEXT) {
+		std::cerr << "Error: [Vision] needs [Agent] features and the "
+			     "binary protocol\r\n";
+		throw std::runtime_error("Vision needs binary features");
+	}
+
+	RLProtocol::AgentFrame frame;
+	frame.width = vision_width;
+	frame.height = vision_height;
+	frame.channels = vision_channels;
+	if (sock_manager.get_transport() == SocketManager::Transport::SHM &&
+	    RLProtocol::encoded_size(frame) > SharedMemoryChannel::SLOT_SIZE) {
+		std::cerr << "Error: " << vision_width << "x" << vision_height
+			  << " frames do not fit a shared memory slot\r\n";
+		throw std::runtime_error("Frame too large for shared memory");
+	}
 #endif
 }
 
-void TestGame::init()
+void TestGame::init(World &world)
 {
-	auto &transform = get_root_object()->transform;
+	GameObject *root = world.get_root();
 
-	GameObject *skybox = new Skybox(
+	Skybox *skybox = new Skybox(
 		mesh_assets.at("skybox"),
 		"./assets/Skybox/fskybg/textures/background.jpg", { .5 });
 
@@ -74,7 +176,7 @@ void TestGame::init()
 		Quaternion::Rotation_Quaternion({ 1, 0, 0 },
 						to_radians(90.0f)));
 
-	get_root_object()->add_child(lighting_object2);
+	root->add_child(lighting_object2)->add_child(skybox)->add_child(floor);
 
 #ifdef MULTIPLAYER
 	Entity *player_entity, *enemy_entity;
@@ -85,29 +187,380 @@ void TestGame::init()
 		player_entity = new PlayerEntity(player2_spawn);
 		enemy_entity = new EnemyPlayerEntity(player1_spawn);
 	}
+	root->add_child(player_entity)->add_child(enemy_entity);
 #else
 	Entity *player_entity = new PlayerEntity(player1_spawn);
 
-	Entity *enemy_entity = new EnemyEntity(player2_spawn);
+	root->add_child(player_entity);
+
+	// Worlds are built in order, so sensors and eyes are in agent order
+	for (int32_t k = 0; k < enemy_count; k++) {
+		Entity *enemy_entity = new EnemyEntity(
+			Vector3f(player2_spawn) +
+			Vector3f{ enemy_spacing * (k / 4),
+				  -enemy_spacing * (k % 4), 0.0f });
+		if (bot) {
+			enemy_entity->add_component(new UtilityBot(
+				*enemy_entity, bot_decision_ticks, bot_range,
+				bot_strafe_flip, navmesh.get()));
+		}
+		if (sensor_rays > 0) {
+			sensors.push_back(new RaySensor(*enemy_entity,
+							sensor_rays, sensor_fov,
+							sensor_range));
+			enemy_entity->add_component(sensors.back());
+		}
+		if (vision) {
+			eyes.push_back(new Camera());
+			eyes.back()->set_projection(
+				to_radians(vision_fov),
+				float(vision_width) / vision_height, .1f,
+				1000.0f);
+
+			// Cameras look along local -y like the entities, z up
+			GameObject *eye = new GameObject();
+			eye->transform.set_translation(enemy_eye_offset);
+			eye->transform.look_at(
+				eye->transform.get_translation() +
+					Vector3f{ 0, -1, 0 },
+				Vector3f::z_axis);
+			enemy_entity->add_child(
+				eye->add_component(eyes.back()));
+		}
+		root->add_child(enemy_entity);
+	}
 #endif
 	CameraObject *camera_object = new CameraObject(85.0f);
 
 	camera_object->add_component(
 		new ArcBall(&player_entity->transform, 6.5f));
 
+	root->add_child(camera_object);
+	skybox->follow(&camera_object->transform);
+
+	// Only the first world is presented
+	if (get_world_count() > 1)
+		return;
+
+	camera_object->set_presented(true);
 	SharedGlobals::get_instance().main_camera =
 		static_cast<void *>(camera_object->camera);
+	SharedGlobals::get_instance().active_ambient_light = .2;
 
-	get_root_object()
-		->add_child(skybox)
-		->add_child(floor)
-		->add_child(player_entity)
-		->add_child(enemy_entity)
-		->add_child(camera_object);
+	root->add_to_rendering_engine();
+}
 
-	SharedGlobals::get_instance().active_ambient_light = .2;
+#ifndef MULTIPLAYER
+size_t TestGame::get_agent_count() const noexcept
+{
+	return get_world_count() * enemy_count;
+}
+
+size_t TestGame::get_enemy_count() const noexcept
+{
+	return enemy_count;
+}
+
+World &TestGame::get_agent_world(size_t agent)
+{
+	return get_world(agent / enemy_count);
+}
+
+EnemyEntity *TestGame::get_enemy(size_t agent)
+{
+	return static_cast<EnemyEntity *>(
+		get_agent_world(agent).enemies[agent % enemy_count]);
+}
+
+/*
+ * Every agent command starts a step of action_repeat ticks and is answered
+ * with the state after its last tick. Agents are numbered in agent order,
+ * the enemies of the first world, then of the next, and commands and
+ * states carry that number. A command without one goes to the agent after
+ * the one the previous command was for.
+ *
+ * Blocking, the agents step together and every step waits for as many
+ * commands as there are agents. Otherwise commands are taken as they
+ * arrive and an agent without one keeps simulating with its last action.
+ */
+void TestGame::begin_tick(float delta)
+{
+	static SocketManager &sock_manager = SocketManager::get_instance();
+	size_t count = get_agent_count();
+	prepare();
+
+	if (in_process || bot)
+		return;
+
+	if (policy) {
+		act_with_policy();
+		return;
+	}
+
+	if (blocking) {
+		if (ticks_left.front() > 0)
+			return;
+
+		for (size_t i = 0; i < count; i++) {
+			receive_command(sock_manager.receive_command());
+		}
+		return;
+	}
+
+	RLProtocol::Command command;
+	while (sock_manager.try_receive_command(command)) {
+		receive_command(command);
+	}
+}
+
+void TestGame::receive_command(const RLProtocol::Command &command)
+{
+	size_t count = get_agent_count();
+	size_t agent = command.agent < 0 ? next_agent : command.agent;
+	if (agent >= count) {
+		std::cerr << "Error: Command for agent " << command.agent
+			  << " of " << count << "\r\n";
+		throw std::runtime_error("Command for an unknown agent");
+	}
+
+	apply_command(agent, command);
+	ticks_left[agent] = action_repeat;
+	next_agent = (agent + 1) % count;
+}
+
+void TestGame::prepare()
+{
+	size_t count = get_agent_count();
+	ticks_left.resize(count, 0);
+	if (spawn_states.size() == get_world_count())
+		return;
+
+	spawn_states.resize(get_world_count());
+	for (size_t i = 0; i < get_world_count(); i++) {
+		get_world(i).save(spawn_states[i]);
+	}
+
+	observers.resize(count);
+	rewards.resize(count);
+	last_actions.resize(count, -1);
+	last_steps.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		observers[i].reset(*get_enemy(i),
+				   *get_agent_world(i).player_entity);
+	}
+}
 
-	get_root_object()->add_to_rendering_engine();
+void TestGame::submit(size_t agent, const RLProtocol::Command &command)
+{
+	prepare();
+	apply_command(agent, command);
+	ticks_left.at(agent) = action_repeat;
+}
+
+bool TestGame::steps_done() const noexcept
+{
+	return std::all_of(ticks_left.begin(), ticks_left.end(),
+			   [](int32_t left) { return left == 0; });
+}
+
+const RLProtocol::AgentStep &TestGame::get_step(size_t agent) const
+{
+	return last_steps.at(agent);
+}
+
+size_t TestGame::get_observation_size() const noexcept
+{
+	return ObservationBuilder::SIZE + 2 * sensor_rays;
+}
+
+// The enemies of a world share it, so the episodes of all of them start
+// over, and their steps in flight go on from the restored state. Restoring
+// also brings back the commands the enemies were built with, so those of
+// the steps in flight are applied again, and an action given earlier in
+// the same batch is not lost to a later reset
+void TestGame::reset_world(size_t agent, int32_t reward_mode)
+{
+	size_t first = agent - agent % enemy_count;
+	in_flight.clear();
+	for (size_t i = first; i < first + enemy_count; i++) {
+		if (i == agent || ticks_left[i] == 0)
+			continue;
+		in_flight.push_back(
+			{ i, get_enemy(i)->get_command(), last_actions[i] });
+	}
+
+	get_agent_world(agent).restore(spawn_states[agent / enemy_count]);
+	for (size_t i = first; i < first + enemy_count; i++) {
+		observers[i].reset(*get_enemy(i),
+				   *get_agent_world(i).player_entity);
+		rewards[i].reset();
+		last_actions[i] = -1;
+		if (reward_mode < 0 ||
+		    reward_mode >
+			    static_cast<int32_t>(RewardEvaluator::Mode::FINAL))
+			continue;
+		rewards[i].set_mode(
+			static_cast<RewardEvaluator::Mode>(reward_mode));
+	}
+
+	for (const InFlight &step : in_flight) {
+		get_enemy(step.agent)->set_command(step.command);
+		last_actions[step.agent] = step.action;
+	}
+}
+
+// A reset restores the world as it was built, so every episode starts from
+// the same simulation state, and may switch the reward mode
+void TestGame::apply_command(size_t agent, const RLProtocol::Command &command)
+{
+	if (command.type == RLProtocol::Command::Type::RESET) {
+		reset_world(agent, command.action);
+		return;
+	}
+	last_actions[agent] = command.action;
+	get_enemy(agent)->set_command(command);
+}
+
+// A new action for every agent whose step ended, observed the way the
+// policy was trained, by its input size. The observations are stacked and
+// run through the policy as one batch, then the actions handed back out
+void TestGame::act_with_policy()
+{
+	int32_t inputs = policy->get_input_size();
+	int32_t outputs = policy->get_output_size();
+	stepped.clear();
+	batch_inputs.clear();
+	for (size_t i = 0; i < ticks_left.size(); i++) {
+		if (ticks_left[i] > 0)
+			continue;
+
+		stepped.push_back(i);
+		batch_inputs.resize(stepped.size() * inputs);
+		float *row = batch_inputs.data() + batch_inputs.size() - inputs;
+		if (inputs != ObservationBuilder::LEGACY_SIZE) {
+			RLProtocol::AgentStep step = observe(i);
+			std::copy(step.observation.begin(),
+				  step.observation.end(), row);
+		} else {
+			ObservationBuilder::build_legacy(
+				get_enemy(i)->get_state(), row);
+		}
+	}
+	if (stepped.empty())
+		return;
+
+	batch_logits.resize(stepped.size() * outputs);
+	policy->forward_batch(batch_inputs.data(), stepped.size(),
+			      batch_logits.data());
+
+	for (size_t b = 0; b < stepped.size(); b++) {
+		size_t i = stepped[b];
+		const float *logits = batch_logits.data() + b * outputs;
+		RLProtocol::Command command;
+		command.type = RLProtocol::Command::Type::ACTION;
+		command.action =
+			sample ? MLP::sample_logits(logits, outputs,
+						    get_agent_world(i).rng) :
+				 MLP::argmax_logits(logits, outputs);
+		last_actions[i] = command.action;
+		get_enemy(i)->set_command(command);
+		ticks_left[i] = action_repeat;
+	}
+}
+
+RLProtocol::AgentStep TestGame::observe(size_t agent)
+{
+	EnemyEntity *enemy = get_enemy(agent);
+	Entity &player = *get_agent_world(agent).player_entity;
+	ObservationBuilder::Observation observation =
+		observers[agent].build(*enemy, player, enemy->get_shot_hit());
+	RewardEvaluator::Result result =
+		rewards[agent].evaluate(observation, last_actions[agent]);
+
+	RLProtocol::AgentStep step;
+	step.agent = agent;
+	step.observation.assign(std::begin(observation.features),
+				std::end(observation.features));
+	if (!sensors.empty()) {
+		const std::vector<float> &readings =
+			sensors[agent]->get_readings();
+		step.observation.insert(step.observation.end(),
+					readings.begin(), readings.end());
+	}
+	step.reward = result.reward;
+	step.terminated = result.terminated ? 1.0f : 0.0f;
+	step.truncated = result.truncated ? 1.0f : 0.0f;
+	return step;
+}
+
+// States of the steps that ended this tick, sent together
+void TestGame::end_tick(float delta)
+{
+	static SocketManager &sock_manager = SocketManager::get_instance();
+	if (bot)
+		return;
+	if (policy) {
+		for (int32_t &left : ticks_left) {
+			left = std::max(0, left - 1);
+		}
+		return;
+	}
+
+	states.clear();
+	steps.clear();
+	stepped.clear();
+	for (size_t i = 0; i < ticks_left.size(); i++) {
+		if (ticks_left[i] == 0 || --ticks_left[i] > 0)
+			continue;
+
+		if (in_process) {
+			last_steps[i] = observe(i);
+		} else if (features) {
+			steps.push_back(observe(i));
+			stepped.push_back(i);
+		} else {
+			states.push_back(get_enemy(i)->get_state());
+			states.back().agent = i;
+		}
+	}
+
+	if (in_process)
+		return;
+	if (!states.empty())
+		sock_manager.send_states(states);
+	if (!steps.empty())
+		sock_manager.send_states(steps);
+	if (vision && !stepped.empty())
+		send_frames();
 }
-#undef player1_spawn
-#undef player2_spawn
\ No newline at end of file
+
+// Draws what the enemies whose step ended see and sends the frames read
+// back, which trail the steps by the latency of the readback ring
+void TestGame::send_frames()
+{
+	static SocketManager &sock_manager = SocketManager::get_instance();
+	if (!pixels) {
+		pixels = std::make_unique<PixelObserver>(
+			get_agent_count(), vision_width, vision_height,
+			vision_channels, vision_ring);
+	}
+
+	for (size_t i : stepped) {
+		snapshot(view, get_agent_world(i), *eyes[i]);
+		pixels->render(i, view);
+	}
+	pixels->read();
+
+	frames.clear();
+	for (size_t i : stepped) {
+		RLProtocol::AgentFrame frame;
+		frame.width = vision_width;
+		frame.height = vision_height;
+		frame.channels = vision_channels;
+		frame.latency = pixels->get_latency();
+		frame.pixels = pixels->get_pixels(i);
+		frames.push_back(frame);
+	}
+	sock_manager.send_states(frames);
+}
+#endif
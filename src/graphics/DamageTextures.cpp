@@ -0,0 +1,50 @@
+#include <graphics/DamageTextures.h>
+
+#include <graphics/Texture.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+DamageTextures &DamageTextures::get_instance()
+{
+	static DamageTextures instance;
+	return instance;
+}
+
+DamageTextures::DamageTextures()
+{
+}
+
+int32_t DamageTextures::get_stage(float hp, float max_hp) noexcept
+{
+	float percent = hp * 100.0f / max_hp;
+	return 4 - (percent <= 75) - (percent <= 50) - (percent <= 25) -
+	       (percent <= 0);
+}
+
+const std::shared_ptr<void> &DamageTextures::get(int32_t stage)
+{
+	if (stage < 0 || stage >= STAGES) {
+		std::cerr << "Error: Invalid Damage Stage " << stage << "\r\n";
+		throw std::runtime_error("Invalid Damage Stage\r\n");
+	}
+
+	if (!loaded) {
+		for (int32_t i = 0; i < STAGES; i++) {
+			diffuses[i] = Texture::load_texture(
+				"./assets/objects/Main_model_" +
+				std::to_string(i * 25) + ".png");
+		}
+		loaded = true;
+	}
+	return diffuses[stage];
+}
+
+void DamageTextures::release() noexcept
+{
+	for (std::shared_ptr<void> &diffuse : diffuses) {
+		diffuse.reset();
+	}
+	loaded = false;
+}
@@ -44,3 +44,19 @@ void ForwardAmbient::update_uniforms(Transform *transform,
 	this->set_uniform("ambient_intensity",
 			  SharedGlobals::get_instance().active_ambient_light);
 }
+
+void ForwardAmbient::update_uniforms(const RenderSnapshot &snapshot,
+				     const RenderSnapshot::Draw &draw,
+				     const RenderLight *light)
+{
+	Matrix4f projected_matrix =
+		Matrix4f::flip_matrix(snapshot.view_projection * draw.world);
+
+	if (draw.diffuse)
+		static_cast<Texture *>(draw.diffuse.get())->bind();
+
+	this->set_uniform("MVP", projected_matrix);
+	this->set_uniform("ambient_intensity", draw.full_ambient ?
+						       Vector3f(1) :
+						       snapshot.ambient_light);
+}
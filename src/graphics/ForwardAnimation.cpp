@@ -57,3 +57,17 @@ void ForwardAnimation::update_uniforms(Transform *transform,
 		}
 	}
 }
+
+// Snapshots carry no skeleton, the mesh is drawn in its bind pose
+void ForwardAnimation::update_uniforms(const RenderSnapshot &snapshot,
+				       const RenderSnapshot::Draw &draw,
+				       const RenderLight *light)
+{
+	Matrix4f projected_matrix =
+		Matrix4f::flip_matrix(snapshot.view_projection * draw.world);
+
+	if (draw.diffuse)
+		static_cast<Texture *>(draw.diffuse.get())->bind();
+
+	this->set_uniform("MVP", projected_matrix);
+}
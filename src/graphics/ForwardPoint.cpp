@@ -69,20 +69,42 @@ void ForwardPoint::update_uniforms(Transform *transform,
 				  SharedGlobals::get_instance().active_light));
 }
 
+void ForwardPoint::update_uniforms(const RenderSnapshot &snapshot,
+				   const RenderSnapshot::Draw &draw,
+				   const RenderLight *light)
+{
+	Matrix4f projected_matrix =
+		Matrix4f::flip_matrix(snapshot.view_projection * draw.world);
+
+	if (draw.diffuse)
+		static_cast<Texture *>(draw.diffuse.get())->bind();
+
+	this->set_uniform("model", Matrix4f::flip_matrix(draw.world));
+	this->set_uniform("MVP", projected_matrix);
+
+	this->set_uniform("specular", draw.specular);
+	this->set_uniform("eyePos", snapshot.eye_position);
+
+	this->set_uniform("point_light", *light);
+}
+
 void ForwardPoint::set_uniform(const std::string &uniform,
 			       const BaseLight &base_light) noexcept
 {
-	this->set_uniform(uniform + ".base_light.color", base_light.color);
-	this->set_uniform(uniform + ".base_light.intensity",
-			  base_light.intensity);
+	this->set_uniform(uniform, RenderLight(base_light));
+}
+
+void ForwardPoint::set_uniform(const std::string &uniform,
+			       const RenderLight &light) noexcept
+{
+	this->set_uniform(uniform + ".base_light.color", light.color);
+	this->set_uniform(uniform + ".base_light.intensity", light.intensity);
 	this->set_uniform(uniform + ".attenuation.constant",
-			  base_light.attenuation.get_constant());
+			  light.attenuation.get_constant());
 	this->set_uniform(uniform + ".attenuation.linear",
-			  base_light.attenuation.get_linear());
+			  light.attenuation.get_linear());
 	this->set_uniform(uniform + ".attenuation.exponent",
-			  base_light.attenuation.get_exponent());
-	this->set_uniform(
-		uniform + ".position",
-		base_light.get_parent_transform()->get_transformed_position());
-	this->set_uniform(uniform + ".range", base_light.range);
+			  light.attenuation.get_exponent());
+	this->set_uniform(uniform + ".position", light.position);
+	this->set_uniform(uniform + ".range", light.range);
 }
@@ -74,26 +74,46 @@ void ForwardSpot::update_uniforms(Transform *transform,
 				  SharedGlobals::get_instance().active_light));
 }
 
+void ForwardSpot::update_uniforms(const RenderSnapshot &snapshot,
+				  const RenderSnapshot::Draw &draw,
+				  const RenderLight *light)
+{
+	Matrix4f projected_matrix =
+		Matrix4f::flip_matrix(snapshot.view_projection * draw.world);
+
+	if (draw.diffuse)
+		static_cast<Texture *>(draw.diffuse.get())->bind();
+
+	this->set_uniform("model", Matrix4f::flip_matrix(draw.world));
+	this->set_uniform("MVP", projected_matrix);
+
+	this->set_uniform("specular", draw.specular);
+	this->set_uniform("eyePos", snapshot.eye_position);
+
+	this->set_uniform("spot_light", *light);
+}
+
 void ForwardSpot::set_uniform(const std::string &uniform,
 			      const BaseLight &base_light) noexcept
+{
+	this->set_uniform(uniform, RenderLight(base_light));
+}
+
+void ForwardSpot::set_uniform(const std::string &uniform,
+			      const RenderLight &light) noexcept
 {
 	this->set_uniform(uniform + ".point_light.base_light.color",
-			  base_light.color);
+			  light.color);
 	this->set_uniform(uniform + ".point_light.base_light.intensity",
-			  base_light.intensity);
+			  light.intensity);
 	this->set_uniform(uniform + ".point_light.attenuation.constant",
-			  base_light.attenuation.get_constant());
+			  light.attenuation.get_constant());
 	this->set_uniform(uniform + ".point_light.attenuation.linear",
-			  base_light.attenuation.get_linear());
+			  light.attenuation.get_linear());
 	this->set_uniform(uniform + ".point_light.attenuation.exponent",
-			  base_light.attenuation.get_exponent());
-	this->set_uniform(
-		uniform + ".point_light.position",
-		base_light.get_parent_transform()->get_transformed_position());
-	this->set_uniform(uniform + ".point_light.range", base_light.range);
-	this->set_uniform(uniform + ".direction",
-			  base_light.get_parent_transform()
-				  ->get_transformed_rotation()
-				  .get_forward());
-	this->set_uniform(uniform + ".cutoff", base_light.cutoff);
+			  light.attenuation.get_exponent());
+	this->set_uniform(uniform + ".point_light.position", light.position);
+	this->set_uniform(uniform + ".point_light.range", light.range);
+	this->set_uniform(uniform + ".direction", light.direction);
+	this->set_uniform(uniform + ".cutoff", light.cutoff);
 }
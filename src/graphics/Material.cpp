@@ -34,6 +34,16 @@ void *Material::get_property(const std::string &name) const noexcept
 	return property.at(name).get();
 }
 
+std::shared_ptr<void>
+Material::get_shared_property(const std::string &name) const noexcept
+{
+	auto it = property.find(name);
+	if (it == property.end())
+		return nullptr;
+
+	return it->second;
+}
+
 void Material::delete_property(const std::string &name) noexcept
 {
 	if (property.count(name))
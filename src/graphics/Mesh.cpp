@@ -10,6 +10,9 @@
 #include <graphics/resource_management/MeshResource.h>
 
 #include <core/SharedGlobals.h>
+#include <core/World.h>
+
+#include <misc/Profiler.h>
 
 #include <iostream>
 #include <fstream>
@@ -30,6 +33,7 @@ std::unordered_map<int32_t, std::vector<Vertex> > all_vertices{};
 
 void Mesh::pre_load(const std::string &file_path)
 {
+	PROFILE_FUNCTION();
 	if (loaded_file_ids.count(file_path))
 		return;
 
@@ -81,14 +85,33 @@ void Mesh::pre_load(const std::string &file_path)
 	std::cout << "Preloading (" << id << "): Done\r\n";
 }
 
+void Mesh::get_triangles(const std::string &file_path,
+			 std::vector<float> &positions,
+			 std::vector<int32_t> &indices)
+{
+	pre_load(file_path);
+	auto &[bullet_vertices, bullet_indices] =
+		all_bullet_vertices.at(loaded_file_ids[file_path]);
+	positions.assign(bullet_vertices.begin(), bullet_vertices.end());
+	indices.assign(bullet_indices.begin(), bullet_indices.end());
+}
+
 Mesh Mesh::load_mesh(const std::string &file_path,
 		     MeshPhysicsType mesh_physics_type)
 {
+	PROFILE_FUNCTION();
 	pre_load(file_path);
 	int32_t id = loaded_file_ids[file_path];
 
 	Mesh mesh;
 	mesh.mesh_physics_type = mesh_physics_type;
+
+	// Without a GL context only the Bullet shapes are needed
+	if (SharedGlobals::get_instance().headless) {
+		mesh.update_physics(id);
+		return mesh;
+	}
+
 	if (mesh_cache.count(id)) {
 		std::shared_ptr<MeshResource> resource = mesh_cache[id].lock();
 		if (resource) {
@@ -114,7 +137,7 @@ Mesh Mesh::load_mesh(const std::string &file_path,
 void Mesh::update_physics(int32_t id)
 {
 	btRigidBody *rigid_body = nullptr;
-	SharedGlobals &globals = SharedGlobals::get_instance();
+	World &world = World::current();
 	auto &[bullet_vertices, indices] = all_bullet_vertices.at(id);
 
 	switch (mesh_physics_type) {
@@ -147,7 +170,7 @@ void Mesh::update_physics(int32_t id)
 		btBvhTriangleMeshShape *shape =
 			new btBvhTriangleMeshShape(index_vertex_array, true);
 		shape->setMargin(5e-5);
-		globals.collision_shapes.push_back(shape);
+		world.collision_shapes.push_back(shape);
 
 		btDefaultMotionState *motion_state = new btDefaultMotionState();
 		btRigidBody::btRigidBodyConstructionInfo rigid_body_info(
@@ -161,9 +184,9 @@ void Mesh::update_physics(int32_t id)
 		break;
 	}
 	if (rigid_body != nullptr) {
-		globals.dynamics_world->addRigidBody(rigid_body);
+		world.dynamics_world->addRigidBody(rigid_body);
 	}
-	globals.current_rigid_body = rigid_body;
+	world.current_rigid_body = rigid_body;
 }
 
 void Mesh::add_vertices(std::vector<Vertex> vertices,
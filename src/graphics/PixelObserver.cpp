@@ -0,0 +1,192 @@
+#include <graphics/PixelObserver.h>
+
+#include <misc/glad.h>
+
+#include <graphics/RenderingEngine.h>
+
+#include <misc/Profiler.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+PixelObserver::PixelObserver(int32_t views, int32_t width, int32_t height,
+			     int32_t channels, int32_t ring_size)
+	: views(std::max(1, views))
+	, width(width)
+	, height(height)
+	, channels(channels)
+{
+	if (channels != 1 && channels != 3) {
+		std::cerr << "Error: Pixel observations have 1 or 3 channels, "
+			  << "not " << channels << "\r\n";
+		throw std::runtime_error("Unsupported pixel channels");
+	}
+	GLint max_size = 0;
+	glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_size);
+	if (width <= 0 || height <= 0 || width > max_size ||
+	    height * this->views > max_size) {
+		std::cerr << "Error: " << this->views << " views of " << width
+			  << "x" << height << " do not fit a " << max_size
+			  << " pixel framebuffer\r\n";
+		throw std::runtime_error("Unsupported pixel observation size");
+	}
+
+	// Sets up the fixed GL state the views are drawn with
+	RenderingEngine::get_instance();
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glGenRenderbuffers(1, &color);
+	glBindRenderbuffer(GL_RENDERBUFFER, color);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width,
+			      height * this->views);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+				  GL_RENDERBUFFER, color);
+	glGenRenderbuffers(1, &depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width,
+			      height * this->views);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+				  GL_RENDERBUFFER, depth);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "Error: Incomplete pixel observation framebuffer: "
+			  << status << "\r\n";
+		throw std::runtime_error("Incomplete framebuffer");
+	}
+
+	// RGBA is the format drivers read back without converting
+	ring.resize(std::max(1, ring_size));
+	for (Readback &readback : ring) {
+		glGenBuffers(1, &readback.buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER,
+			     4 * size_t(width) * height * this->views, nullptr,
+			     GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	frames.resize(this->views * get_frame_size());
+}
+
+PixelObserver::~PixelObserver()
+{
+	for (Readback &readback : ring) {
+		if (readback.fence != nullptr)
+			glDeleteSync(readback.fence);
+		glDeleteBuffers(1, &readback.buffer);
+	}
+	glDeleteRenderbuffers(1, &depth);
+	glDeleteRenderbuffers(1, &color);
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+void PixelObserver::render(int32_t view, const RenderSnapshot &snapshot)
+{
+	PROFILE_FUNCTION();
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	RenderingEngine::get_instance().render(snapshot, 0, view * height,
+					       width, height);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PixelObserver::read()
+{
+	PROFILE_FUNCTION();
+	size_t size = 4 * size_t(width) * height * views;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, ring[next].buffer);
+	glReadPixels(0, 0, width, height * views, GL_RGBA, GL_UNSIGNED_BYTE,
+		     nullptr);
+	ring[next].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	next = (next + 1) % ring.size();
+
+	// With a ring of 1 this is the copy just started
+	Readback &oldest = ring[next];
+	if (oldest.fence == nullptr) {
+		// The ring is still filling up
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		return;
+	}
+
+	GLenum status;
+	do {
+		status = glClientWaitSync(oldest.fence,
+					  GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+	} while (status == GL_TIMEOUT_EXPIRED);
+	glDeleteSync(oldest.fence);
+	oldest.fence = nullptr;
+	if (status == GL_WAIT_FAILED) {
+		std::cerr << "Error: Waiting for a pixel readback failed\r\n";
+		throw std::runtime_error("Pixel readback failed");
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, oldest.buffer);
+	const uint8_t *pixels = static_cast<const uint8_t *>(glMapBufferRange(
+		GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+	if (pixels != nullptr) {
+		unpack(pixels);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+// GL rows run bottom to top, frames top to bottom
+void PixelObserver::unpack(const uint8_t *pixels)
+{
+	size_t stride = 4 * size_t(width);
+	uint8_t *out = frames.data();
+	for (int32_t view = 0; view < views; view++) {
+		for (int32_t y = height - 1; y >= 0; y--) {
+			const uint8_t *in =
+				pixels + (size_t(view) * height + y) * stride;
+			for (int32_t x = 0; x < width; x++, in += 4) {
+				if (channels == 3) {
+					*out++ = in[0];
+					*out++ = in[1];
+					*out++ = in[2];
+				} else {
+					// Rec. 601 luma
+					*out++ = (77 * in[0] + 150 * in[1] +
+						  29 * in[2]) >>
+						 8;
+				}
+			}
+		}
+	}
+}
+
+const uint8_t *PixelObserver::get_pixels(int32_t view) const noexcept
+{
+	return frames.data() + view * get_frame_size();
+}
+
+size_t PixelObserver::get_frame_size() const noexcept
+{
+	return size_t(width) * height * channels;
+}
+
+int32_t PixelObserver::get_latency() const noexcept
+{
+	return ring.size() - 1;
+}
+
+int32_t PixelObserver::get_width() const noexcept
+{
+	return width;
+}
+
+int32_t PixelObserver::get_height() const noexcept
+{
+	return height;
+}
+
+int32_t PixelObserver::get_channels() const noexcept
+{
+	return channels;
+}
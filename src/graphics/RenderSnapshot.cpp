@@ -0,0 +1,18 @@
+#include <graphics/RenderSnapshot.h>
+
+#include <math/Transform.h>
+
+#include <components/BaseLight.h>
+
+RenderLight::RenderLight(const BaseLight &light)
+	: shader(light.shader)
+	, color(light.color)
+	, intensity(light.intensity)
+	, attenuation(light.attenuation)
+	, range(light.range)
+	, cutoff(light.cutoff)
+{
+	Transform *transform = light.get_parent_transform();
+	position = transform->get_transformed_position();
+	direction = transform->get_transformed_rotation().get_forward();
+}
@@ -17,8 +17,14 @@
 #include <components/GameObject.h>
 #include <core/SharedGlobals.h>
 
+#include <misc/Profiler.h>
+
 #include <cmath>
 
+std::atomic<bool> RenderingEngine::viewport_changed = false;
+std::atomic<int32_t> RenderingEngine::viewport_width = 0;
+std::atomic<int32_t> RenderingEngine::viewport_height = 0;
+
 void RenderingEngine::clear_screen()
 {
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -64,17 +70,35 @@ RenderingEngine &RenderingEngine::get_instance()
 	return instance;
 }
 
+void RenderingEngine::set_viewport(int32_t width, int32_t height) noexcept
+{
+	viewport_width = width;
+	viewport_height = height;
+	viewport_changed = true;
+}
+
+void RenderingEngine::apply_viewport()
+{
+	if (viewport_changed.exchange(false))
+		glViewport(0, 0, viewport_width, viewport_height);
+}
+
 void RenderingEngine::input()
 {
 }
 
 void RenderingEngine::render(GameObject *object)
 {
+	PROFILE_FUNCTION();
+	apply_viewport();
 	clear_screen();
 
 	SharedGlobals &light_sources = SharedGlobals::get_instance();
 
-	object->render(ForwardAmbient::get_instance());
+	{
+		PROFILE_SCOPE("ambient_pass");
+		object->render(ForwardAmbient::get_instance());
+	}
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_ONE, GL_ONE);
@@ -82,6 +106,7 @@ void RenderingEngine::render(GameObject *object)
 	glDepthFunc(GL_EQUAL);
 
 	for (void *light : light_sources.get_lights()) {
+		PROFILE_SCOPE("light_pass");
 		light_sources.active_light = light;
 		object->render(*(static_cast<BaseLight *>(light)->shader));
 	}
@@ -89,4 +114,56 @@ void RenderingEngine::render(GameObject *object)
 	glDepthFunc(GL_LESS);
 	glDepthMask(GL_TRUE);
 	glDisable(GL_BLEND);
-}
\ No newline at end of file
+}
+
+void RenderingEngine::render(const RenderSnapshot &snapshot)
+{
+	PROFILE_FUNCTION();
+	apply_viewport();
+	clear_screen();
+	draw(snapshot);
+}
+
+void RenderingEngine::render(const RenderSnapshot &snapshot, int32_t x,
+			     int32_t y, int32_t width, int32_t height)
+{
+	PROFILE_FUNCTION();
+	glViewport(x, y, width, height);
+	glScissor(x, y, width, height);
+	glEnable(GL_SCISSOR_TEST);
+	clear_screen();
+	draw(snapshot);
+	glDisable(GL_SCISSOR_TEST);
+	viewport_changed = viewport_width > 0;
+}
+
+void RenderingEngine::draw(const RenderSnapshot &snapshot)
+{
+	{
+		PROFILE_SCOPE("ambient_pass");
+		ForwardAmbient &ambient = ForwardAmbient::get_instance();
+		ambient.use_program();
+		for (const RenderSnapshot::Draw &draw : snapshot.draws) {
+			ambient.update_uniforms(snapshot, draw, nullptr);
+			draw.mesh.draw();
+		}
+	}
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	glDepthMask(GL_FALSE);
+	glDepthFunc(GL_EQUAL);
+
+	for (const RenderLight &light : snapshot.lights) {
+		PROFILE_SCOPE("light_pass");
+		light.shader->use_program();
+		for (const RenderSnapshot::Draw &draw : snapshot.draws) {
+			light.shader->update_uniforms(snapshot, draw, &light);
+			draw.mesh.draw();
+		}
+	}
+
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+}
@@ -10,9 +10,13 @@
 #include <components/BaseCamera.h>
 
 #include <graphics/Material.h>
+
+#include <misc/Profiler.h>
 #include <graphics/Specular.h>
 #include <graphics/resource_management/ShaderResource.h>
 
+#include <core/SharedGlobals.h>
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -77,6 +81,11 @@ GLuint Shader::create_shader_module(const std::string &shader_source,
 void Shader::load(const std::string &vertex_filepath,
 		  const std::string &fragment_filepath)
 {
+	PROFILE_SCOPE("Shader::load");
+	// No GL context to compile against in headless mode
+	if (SharedGlobals::get_instance().headless)
+		return;
+
 	if (shader_cache.count({ vertex_filepath, fragment_filepath })) {
 		std::shared_ptr<ShaderResource> resource =
 			shader_cache.at({ vertex_filepath, fragment_filepath })
@@ -139,6 +148,9 @@ void Shader::use_program() const noexcept
 
 void Shader::add_uniform(const std::string &uniform)
 {
+	if (shader_resource == nullptr)
+		return;
+
 	use_program();
 #ifdef _DEBUG_DISPLAY_ALL_UNIFORMS_ON
 	GLint numUniforms = 0;
@@ -5,6 +5,10 @@
 
 #include <graphics/Specular.h>
 
+#include <core/SharedGlobals.h>
+
+#include <misc/Profiler.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <misc/stb_image.h>
 
@@ -46,8 +50,14 @@ GLuint Texture::get_id() const noexcept
 
 std::shared_ptr<void> Texture::load_texture(const std::string &file_path)
 {
+	PROFILE_SCOPE("Texture::load_texture");
 	Texture *texture = new Texture();
 
+	// Headless runs never bind textures, skip decoding and uploading
+	if (SharedGlobals::get_instance().headless) {
+		return std::shared_ptr<void>(texture, Texture::deleter);
+	}
+
 	// Check cache for already loaded textures
 	if (Texture::texture_cache.count(file_path)) {
 		std::shared_ptr<TextureResource> resource =
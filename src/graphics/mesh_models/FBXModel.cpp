@@ -9,6 +9,8 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <misc/Profiler.h>
+
 #include <vector>
 #include <string>
 #include <array>
@@ -89,6 +91,7 @@ void FBXModel::process_mesh(aiMesh *mesh, const aiScene *scene,
 
 FBXModel::FBXModel(const std::string &file_path)
 {
+	PROFILE_SCOPE("FBXModel::FBXModel");
 	Assimp::Importer importer;
 	const aiScene *scene = importer.ReadFile(
 		file_path, aiProcess_Triangulate | aiProcess_FlipUVs |
@@ -92,8 +92,12 @@ bool Transform::has_changed() noexcept
 		 rotation == prev_rotation);
 }
 
+// Like the rotation, read through the parents every time. The cached
+// parent matrix misses a parent that moved in a tick nothing drew
 Vector3f Transform::get_transformed_position() noexcept
 {
+	if (parent != nullptr)
+		parent_matrix = parent->get_transformation();
 	return parent_matrix.transform(translation);
 }
 
@@ -0,0 +1,183 @@
+#include <misc/Profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+thread_local Profiler::ThreadBuffer *Profiler::thread_buffer = nullptr;
+
+static void write_json_string(std::ostream &out, const std::string &str)
+{
+	out << '"';
+	for (char c : str) {
+		if (c == '"' || c == '\\')
+			out << '\\';
+		if (static_cast<unsigned char>(c) >= 0x20)
+			out << c;
+	}
+	out << '"';
+}
+
+Profiler::Scope::Scope(const char *name) noexcept
+	: name(name)
+	, start(-1)
+{
+	Profiler &profiler = Profiler::get_instance();
+	if (profiler.is_enabled())
+		start = profiler.now();
+}
+
+Profiler::Scope::~Scope()
+{
+	if (start < 0)
+		return;
+
+	Profiler &profiler = Profiler::get_instance();
+	profiler.record(name, start, profiler.now());
+}
+
+Profiler &Profiler::get_instance()
+{
+	static Profiler instance;
+	return instance;
+}
+
+Profiler::Profiler()
+	: epoch(std::chrono::steady_clock::now())
+	, frames(1)
+{
+}
+
+void Profiler::configure(bool enabled, size_t frame_capacity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	frames.assign(std::max<size_t>(1, frame_capacity), {});
+	frame_index = 0;
+	this->enabled = enabled;
+}
+
+bool Profiler::is_enabled() const noexcept
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+int64_t Profiler::now() const noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now() - epoch)
+		.count();
+}
+
+Profiler::ThreadBuffer &Profiler::get_thread_buffer()
+{
+	if (thread_buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(mutex);
+		threads.push_back(std::make_unique<ThreadBuffer>());
+		thread_buffer = threads.back().get();
+		thread_buffer->id = static_cast<uint32_t>(threads.size());
+		thread_buffer->name =
+			"Thread " + std::to_string(thread_buffer->id);
+	}
+	return *thread_buffer;
+}
+
+void Profiler::record(const char *name, int64_t start, int64_t end)
+{
+	ThreadBuffer &buffer = get_thread_buffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.events.push_back({ name, start, end, buffer.id });
+}
+
+void Profiler::set_thread_name(const std::string &name)
+{
+	ThreadBuffer &buffer = get_thread_buffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.name = name;
+}
+
+// Caller holds mutex
+void Profiler::collect(std::vector<Event> &out)
+{
+	for (std::unique_ptr<ThreadBuffer> &buffer : threads) {
+		std::lock_guard<std::mutex> lock(buffer->mutex);
+		out.insert(out.end(), buffer->events.begin(),
+			   buffer->events.end());
+		buffer->events.clear();
+	}
+}
+
+void Profiler::end_startup()
+{
+	if (!is_enabled())
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	collect(startup);
+}
+
+void Profiler::end_frame()
+{
+	if (!is_enabled())
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<Event> &frame = frames[frame_index % frames.size()];
+	frame.clear();
+	collect(frame);
+	frame_index++;
+}
+
+bool Profiler::dump(const std::string &file_path)
+{
+	std::ofstream file(file_path);
+	if (!file.is_open()) {
+		std::cerr << "Warning: Unable to open profile output: "
+			  << file_path << "\r\n";
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[";
+
+	bool first = true;
+	for (std::unique_ptr<ThreadBuffer> &buffer : threads) {
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+		file << (first ? "" : ",") << "\n{\"name\":\"thread_name\","
+		     << "\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+		     << ",\"args\":{\"name\":";
+		write_json_string(file, buffer->name);
+		file << "}}";
+		first = false;
+	}
+
+	auto write_events = [&](const std::vector<Event> &events,
+				const char *category) {
+		for (const Event &event : events) {
+			file << (first ? "" : ",") << "\n{\"name\":";
+			write_json_string(file, event.name);
+			file << ",\"cat\":\"" << category
+			     << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+			     << event.thread << ",\"ts\":" << event.start / 1e3
+			     << ",\"dur\":" << (event.end - event.start) / 1e3
+			     << "}";
+			first = false;
+		}
+	};
+
+	write_events(startup, "startup");
+	// Oldest frame first once the ring has wrapped around
+	size_t count = std::min(frame_index, frames.size());
+	for (size_t i = frame_index - count; i < frame_index; i++) {
+		write_events(frames[i % frames.size()], "frame");
+	}
+
+	file << "\n]}\n";
+	return true;
+}
@@ -0,0 +1,88 @@
+#include <multiplayer/BitPacker.h>
+
+BitWriter::BitWriter(uint8_t *buffer, size_t capacity)
+	: buffer(buffer)
+	, capacity(capacity)
+{
+}
+
+void BitWriter::write(uint32_t value, int32_t bits)
+{
+	if (bits <= 0)
+		return;
+	if (bit_count + bits > capacity * 8) {
+		overflowed = true;
+		return;
+	}
+	if (bits < 32)
+		value &= (uint32_t(1) << bits) - 1;
+
+	while (bits > 0) {
+		size_t byte = bit_count / 8;
+		int32_t offset = bit_count % 8;
+		int32_t count = 8 - offset < bits ? 8 - offset : bits;
+		if (!offset)
+			buffer[byte] = 0;
+		buffer[byte] |= static_cast<uint8_t>(
+			(value & ((1u << count) - 1)) << offset);
+		value >>= count;
+		bits -= count;
+		bit_count += count;
+	}
+}
+
+void BitWriter::write_bool(bool value)
+{
+	write(value, 1);
+}
+
+size_t BitWriter::get_size() const noexcept
+{
+	return (bit_count + 7) / 8;
+}
+
+bool BitWriter::is_overflowed() const noexcept
+{
+	return overflowed;
+}
+
+BitReader::BitReader(const uint8_t *buffer, size_t size)
+	: buffer(buffer)
+	, size(size)
+{
+}
+
+uint32_t BitReader::read(int32_t bits)
+{
+	if (bits <= 0)
+		return 0;
+	if (bit_count + bits > size * 8) {
+		overflowed = true;
+		bit_count = size * 8;
+		return 0;
+	}
+
+	uint32_t value = 0;
+	int32_t shift = 0;
+	while (bits > 0) {
+		size_t byte = bit_count / 8;
+		int32_t offset = bit_count % 8;
+		int32_t count = 8 - offset < bits ? 8 - offset : bits;
+		uint32_t chunk = (buffer[byte] >> offset) & ((1u << count) - 1);
+		value |= chunk << shift;
+		shift += count;
+		bits -= count;
+		bit_count += count;
+	}
+	return value;
+}
+
+bool BitReader::read_bool()
+{
+	return read(1);
+}
+
+bool BitReader::is_overflowed() const noexcept
+{
+	return overflowed;
+}
@@ -0,0 +1,149 @@
+#include <multiplayer/InterpolationBuffer.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define CLOCK_SMOOTHING 0.05 // Of the offset towards each arrival
+#define CLOCK_RESYNC 1.0 // Seconds off, as after a pause, to start over
+
+InterpolationBuffer::InterpolationBuffer(const Settings &settings)
+	: settings(settings)
+{
+}
+
+const InterpolationBuffer::Entry &InterpolationBuffer::at(int32_t index) const
+{
+	return entries[(first + index) % CAPACITY];
+}
+
+InterpolationBuffer::State InterpolationBuffer::sample(double time) const
+{
+	if (time <= at(0).time)
+		return at(0).state;
+
+	const Entry &newest = at(count - 1);
+	if (time >= newest.time) {
+		float ahead = std::min(time - newest.time,
+				       double(settings.max_extrapolation));
+		return extrapolate(newest.state, ahead);
+	}
+
+	int32_t next = 1;
+	while (at(next).time <= time)
+		next++;
+	const Entry &a = at(next - 1);
+	const Entry &b = at(next);
+	float alpha = (time - a.time) / (b.time - a.time);
+
+	State state;
+	Quaternion orientation = a.state.orientation; // nlerp is not const
+	state.position = a.state.position.lerp(b.state.position, alpha);
+	state.orientation = orientation.nlerp(b.state.orientation, alpha, true);
+	state.velocity = a.state.velocity.lerp(b.state.velocity, alpha);
+	state.angular_velocity = a.state.angular_velocity.lerp(
+		b.state.angular_velocity, alpha);
+	return state;
+}
+
+void InterpolationBuffer::trim(double time)
+{
+	// The one before time stays, to interpolate from
+	while (count > 1 && at(1).time <= time) {
+		first = (first + 1) % CAPACITY;
+		count--;
+	}
+}
+
+void InterpolationBuffer::push(double time, const State &state)
+{
+	if (count && time <= at(count - 1).time)
+		return;
+
+	double arrival = time - clock;
+	if (!synced || std::fabs(arrival - offset) > CLOCK_RESYNC) {
+		offset = arrival;
+		synced = true;
+		count = 0;
+		has_shown = false;
+	} else {
+		offset += (arrival - offset) * CLOCK_SMOOTHING;
+	}
+
+	// What was shown came from extrapolating past the newest, which this
+	// state changes
+	bool extrapolated =
+		has_shown && count && at(count - 1).time < shown_time;
+
+	if (count == CAPACITY) {
+		first = (first + 1) % CAPACITY;
+		count--;
+	}
+	entries[(first + count) % CAPACITY] = { time, state };
+	count++;
+
+	if (!extrapolated)
+		return;
+	State corrected = sample(shown_time);
+	Vector3f jump = shown_target.position - corrected.position;
+	position_error += jump;
+	rotation_error = (rotation_error * shown_target.orientation *
+			  corrected.orientation.conjugate())
+				 .normalize();
+	shown_target = corrected;
+
+	if (position_error.length() > settings.snap_distance) {
+		position_error = Vector3f();
+		rotation_error = Quaternion();
+	}
+}
+
+bool InterpolationBuffer::update(float delta, State &state)
+{
+	clock += delta;
+	if (!count)
+		return false;
+
+	double time = clock + offset - settings.delay;
+	trim(time);
+	State target = sample(time);
+
+	if (has_shown && settings.correction_time > 0) {
+		float decay = std::exp(-delta / settings.correction_time);
+		position_error *= decay;
+		rotation_error =
+			Quaternion().nlerp(rotation_error, decay, true);
+	} else {
+		position_error = Vector3f();
+		rotation_error = Quaternion();
+	}
+
+	has_shown = true;
+	shown_time = time;
+	shown_target = target;
+
+	state = target;
+	state.position += position_error;
+	state.orientation = (rotation_error * target.orientation).normalize();
+	return true;
+}
+
+InterpolationBuffer::State InterpolationBuffer::extrapolate(const State &state,
+							float time)
+{
+	State extrapolated = state;
+	extrapolated.position += state.velocity * time;
+
+	float speed = state.angular_velocity.length();
+	if (speed < 1e-6f)
+		return extrapolated;
+	// Applied in world space, as Bullet integrates it
+	Quaternion rotation = Quaternion::Rotation_Quaternion(
+		state.angular_velocity / speed, speed * time);
+	extrapolated.orientation = (rotation * state.orientation).normalize();
+	return extrapolated;
+}
+
+int32_t InterpolationBuffer::size() const noexcept
+{
+	return count;
+}
@@ -1,11 +1,15 @@
 #include <multiplayer/MM.h>
 #ifdef MULTIPLAYER
+#include <core/Config.h>
 #include <core/SharedGlobals.h>
 
-#include <misc/SafeQueue.h>
 #include <misc/Log.h>
 
 #include <multiplayer/AWS.h>
+#include <multiplayer/Moves.h>
+#include <multiplayer/NetChannel.h>
+#include <multiplayer/SnapshotCodec.h>
+#include <multiplayer/Wire.h>
 #include <json/json.h>
 #include <ncurses.h>
 
@@ -13,18 +17,32 @@
 #include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <thread>
 #include <chrono>
 #include <random>
-#include <iomanip>
-#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <poll.h>
 #include <exception>
 
-constexpr int32_t INSTR_BUFFER_SIZE = 129;
+// Moves sent at once, when the game thread queued up several
+constexpr size_t SEND_BATCH_SIZE = 16;
+constexpr size_t RECV_BUFFER_SIZE = 2048;
+
+// Registers the datagram address with the relay, followed by the player id
+constexpr char DATAGRAM_HELLO[] = "HELLO";
+// Of the match end, before giving up on an answer
+constexpr int32_t DATAGRAM_TRIES = 20;
+constexpr int32_t DATAGRAM_RETRY_MS = 100;
+// Of the hello while waiting on the relay to pick the transport, it waits
+// a few seconds for both hellos before settling on the stream
+constexpr int32_t TRANSPORT_TRIES = 100;
 
 MatchMaking &MatchMaking::get_instance()
 {
@@ -110,21 +128,30 @@ void MatchMaking::sync_player_queue()
 		error = true;
 		return;
 	}
+	// State over datagrams when both players can reach the relay with
+	// them, the connection stays open either way to tell when the match
+	// ends
+	Config &config = Config::get_instance();
+	if (config.get_string("Match", "transport", "udp") == "udp")
+		open_datagrams(server_addr);
+	if (!agree_transport()) {
+		perror("Handshaking failed");
+		if (datagram_sock >= 0)
+			close(datagram_sock);
+		datagram_sock = -1;
+		close(sock);
+		error = true;
+		return;
+	}
 	handshaked = true;
 
 	static SharedGlobals &globals = SharedGlobals::get_instance();
-	SafeQueue<std::pair<int32_t, std::vector<float> > > *player_queue =
-		nullptr;
-	SafeQueue<std::pair<int32_t, std::vector<float> > > *enemy_queue =
-		nullptr;
+	MoveQueue *player_queue = nullptr;
+	MoveQueue *enemy_queue = nullptr;
 
 	while (!player_queue || !enemy_queue) {
-		player_queue = static_cast<
-			SafeQueue<std::pair<int32_t, std::vector<float> > > *>(
-			globals.player_moves);
-		enemy_queue = static_cast<
-			SafeQueue<std::pair<int32_t, std::vector<float> > > *>(
-			globals.enemy_moves);
+		player_queue = static_cast<MoveQueue *>(globals.player_moves);
+		enemy_queue = static_cast<MoveQueue *>(globals.enemy_moves);
 
 		if (!player_queue || !enemy_queue) {
 			std::this_thread::sleep_for(
@@ -132,30 +159,87 @@ void MatchMaking::sync_player_queue()
 		}
 	}
 
+	// Both peers read the same settings, as the codec requires
+	bool compress = config.get_bool("Snapshot", "compress", true);
+	snapshot_settings.position_min =
+		config.get_double("Snapshot", "position_min", -64.0);
+	snapshot_settings.position_max =
+		config.get_double("Snapshot", "position_max", 64.0);
+	snapshot_settings.position_bits =
+		config.get_int("Snapshot", "position_bits", 16);
+	snapshot_settings.rotation_bits =
+		config.get_int("Snapshot", "rotation_bits", 12);
+	snapshot_settings.max_velocity =
+		config.get_double("Snapshot", "max_velocity", 32.0);
+	snapshot_settings.velocity_bits =
+		config.get_int("Snapshot", "velocity_bits", 12);
+	snapshot_settings.max_angular_velocity =
+		config.get_double("Snapshot", "max_angular_velocity", 32.0);
+	snapshot_settings.angular_bits =
+		config.get_int("Snapshot", "angular_bits", 12);
+	snapshot_received = -1;
+	snapshot_acked = -1;
+	peer_left = false;
+
+	SnapshotCodec encoder(snapshot_settings);
 	std::thread enemy_thread(&MatchMaking::sync_enemy_queue, this,
 				 enemy_queue);
 
+	auto encode = [&](const Move &move, uint8_t *buffer) -> size_t {
+		if (!compress || move.action != Move::SYNC ||
+		    move.count < Move::MAX_VALUES) {
+			return Wire::encode(move, buffer);
+		}
+		int32_t acked = snapshot_acked.exchange(-1);
+		if (acked >= 0)
+			encoder.acknowledge(acked);
+		size_t size = encoder.encode(move, buffer + Wire::HEADER_SIZE,
+					     SnapshotCodec::MAX_SIZE);
+		return size ? Wire::write_header(Wire::MessageType::SNAPSHOT,
+						 size, buffer) :
+			      0;
+	};
+
+	// Room for an ack ahead of the batch
+	uint8_t message[(SEND_BATCH_SIZE + 1) * Wire::MAX_MESSAGE_SIZE];
+	int32_t ack_sent = -1;
+	Move move;
 	while (match_running) {
-		if (!player_queue->size())
+		// Sleeps while the game thread has nothing to send, waking
+		// now and then to notice the match ending. The player's state
+		// is queued every tick, so acks ride along with it
+		if (!player_queue->wait_pop(move,
+					    std::chrono::milliseconds(100))) {
+			// Shots still waiting for an ack go out again
+			if (datagrams && !send_packet(nullptr, 0))
+				break;
 			continue;
+		}
 
-		auto [x, y] = player_queue->pop();
-		if (x == -1)
-			continue;
-		std::ostringstream oss;
-		oss << x << std::fixed << std::setprecision(6);
-		for (auto &c : y)
-			oss << ',' << c;
-
-		std::string message = oss.str();
-		if (message.size() < INSTR_BUFFER_SIZE) {
-			message.append(INSTR_BUFFER_SIZE - message.size(),
-				       '\0');
-		} else if (message.size() > INSTR_BUFFER_SIZE) {
-			message = message.substr(0, 128) + "\0";
+		size_t length = 0;
+		int32_t received = snapshot_received;
+		if (received >= 0 && received != ack_sent) {
+			length += Wire::encode_ack(received, message);
+			ack_sent = received;
+		}
+		for (size_t i = 0; i < SEND_BATCH_SIZE; i++) {
+			if (i && !player_queue->try_pop(move))
+				break;
+			size_t size = encode(move, message + length);
+			// Over datagrams, shots have to arrive and state only
+			// has to be recent
+			if (datagrams && size &&
+			    Wire::get_type(message + length) ==
+				    Wire::MessageType::SHOT) {
+				std::lock_guard<std::mutex> lock(channel_mutex);
+				channel.send_reliable(message + length, size);
+				continue;
+			}
+			length += size;
 		}
 
-		if (send(sock, message.c_str(), message.size(), 0) < 0) {
+		if (datagrams ? !send_packet(message, length) :
+				!send_stream(message, length)) {
 			perror("Send failed");
 			break;
 		}
@@ -164,21 +248,182 @@ void MatchMaking::sync_player_queue()
 	if (enemy_thread.joinable()) {
 		enemy_thread.join();
 	}
+	if (datagrams) {
+		if (!peer_left)
+			send_match_end();
+		close(datagram_sock);
+		datagram_sock = -1;
+	}
 
 	close(sock);
 	sock = -1;
 }
 
-void MatchMaking::sync_enemy_queue(
-	SafeQueue<std::pair<int32_t, std::vector<float> > > *enemy_queue)
+bool MatchMaking::open_datagrams(const sockaddr_in &server_addr)
+{
+	datagram_sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if (datagram_sock < 0) {
+		perror("Datagram socket creation failed");
+		return false;
+	}
+	// Only the relay's datagrams are received from here on
+	if (connect(datagram_sock, (const struct sockaddr *)&server_addr,
+		    sizeof(server_addr)) < 0) {
+		perror("Datagram connection failed");
+		close(datagram_sock);
+		datagram_sock = -1;
+		return false;
+	}
+	return true;
+}
+
+bool MatchMaking::agree_transport()
+{
+	uint8_t message[Wire::MAX_MESSAGE_SIZE];
+	size_t size = Wire::encode_transport(datagram_sock >= 0, message);
+	if (!send_stream(message, size))
+		return false;
+
+	// The relay learns the datagram address from the same player id the
+	// stream handshake sent. It answers both players alike, datagrams
+	// only once it has the hellos of both, so neither ends up listening
+	// where the other does not send
+	std::string hello(DATAGRAM_HELLO, sizeof(DATAGRAM_HELLO));
+	hello += AWS::get_player_id();
+	uint8_t answer[Wire::HEADER_SIZE + 1];
+	size_t received = 0;
+	for (int32_t i = 0; i < TRANSPORT_TRIES && received < sizeof(answer);
+	     i++) {
+		if (datagram_sock >= 0)
+			send(datagram_sock, hello.data(), hello.size(), 0);
+		pollfd fd = { sock, POLLIN, 0 };
+		if (poll(&fd, 1, DATAGRAM_RETRY_MS) <= 0)
+			continue;
+		// Nothing else is sent on the stream before the answer
+		ssize_t count = recv(sock, answer + received,
+				     sizeof(answer) - received, 0);
+		if (count <= 0)
+			return false;
+		received += count;
+	}
+	if (received < sizeof(answer) ||
+	    !Wire::decode_transport(answer, received, datagrams)) {
+		return false;
+	}
+
+	if (!datagrams && datagram_sock >= 0) {
+		Logger::get_instance()
+			<< "(MM):\t\t No datagrams for both players, "
+			   "falling back to the stream\n";
+		close(datagram_sock);
+		datagram_sock = -1;
+	}
+	return true;
+}
+
+bool MatchMaking::send_stream(const uint8_t *messages, size_t size)
+{
+	size_t sent = 0;
+	while (sent < size) {
+		ssize_t count =
+			send(sock, messages + sent, size - sent, MSG_NOSIGNAL);
+		if (count < 0)
+			return false;
+		sent += count;
+	}
+	return true;
+}
+
+bool MatchMaking::send_packet(const uint8_t *unreliable, size_t size)
+{
+	uint8_t packet[NetChannel::MAX_PACKET_SIZE];
+	size_t packet_size;
+	{
+		std::lock_guard<std::mutex> lock(channel_mutex);
+		if (!size && !channel.has_unacknowledged())
+			return true;
+		packet_size = channel.write_packet(unreliable, size, packet);
+	}
+	// A full socket buffer or an unreachable relay loses the packet,
+	// like the network would
+	return send(datagram_sock, packet, packet_size, 0) >= 0 ||
+	       errno == EAGAIN || errno == EWOULDBLOCK ||
+	       errno == ECONNREFUSED;
+}
+
+void MatchMaking::send_match_end()
 {
-	static char buffer[INSTR_BUFFER_SIZE];
+	uint8_t message[Wire::HEADER_SIZE];
+	Wire::write_header(Wire::MessageType::MATCH_END, 0, message);
+	{
+		std::lock_guard<std::mutex> lock(channel_mutex);
+		channel.send_reliable(message, sizeof(message));
+	}
+
+	// The receiving thread is gone, so acks are read here
+	uint8_t buffer[RECV_BUFFER_SIZE];
+	for (int32_t i = 0; i < DATAGRAM_TRIES; i++) {
+		if (!send_packet(nullptr, 0))
+			return;
+		pollfd fd = { datagram_sock, POLLIN, 0 };
+		if (poll(&fd, 1, DATAGRAM_RETRY_MS) <= 0)
+			continue;
+		ssize_t size = recv(datagram_sock, buffer, sizeof(buffer), 0);
+		std::lock_guard<std::mutex> lock(channel_mutex);
+		if (size > 0)
+			channel.read_packet(buffer, size,
+					    [](const uint8_t *, size_t) {});
+		if (!channel.has_unacknowledged())
+			return;
+	}
+}
+
+void MatchMaking::sync_enemy_queue(MoveQueue *enemy_queue)
+{
+	static uint8_t buffer[RECV_BUFFER_SIZE];
+	Wire::Reader reader;
+	SnapshotCodec decoder(snapshot_settings);
+	auto push = [this, enemy_queue, &decoder](const uint8_t *message,
+						  size_t size) {
+		Move move;
+		uint16_t sequence;
+		switch (Wire::get_type(message)) {
+		case Wire::MessageType::SNAPSHOT:
+			if (!decoder.decode(message + Wire::HEADER_SIZE,
+					    size - Wire::HEADER_SIZE, move,
+					    sequence)) {
+				return;
+			}
+			snapshot_received = sequence;
+			break;
+		case Wire::MessageType::ACK:
+			if (Wire::decode_ack(message, size, sequence))
+				snapshot_acked = sequence;
+			return;
+		case Wire::MessageType::MATCH_END:
+			this->peer_left = true;
+			this->match_outcome = -1;
+			this->match_running = false;
+			return;
+		default:
+			if (!Wire::decode(message, size, move))
+				return;
+			break;
+		}
+		enemy_queue->try_push(move);
+	};
+
+	if (datagrams) {
+		receive_datagrams(buffer, sizeof(buffer), reader, push);
+		return;
+	}
+
 	while (match_running) {
 		struct timeval timeout = { 60, 0 };
 		setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO,
 			   (const char *)&timeout, sizeof timeout);
 
-		int recv_size = recv(sock, buffer, sizeof(buffer) - 1, 0);
+		int recv_size = recv(sock, buffer, sizeof(buffer), 0);
 		if (recv_size <= 0) {
 			if (recv_size == 0 || errno == EWOULDBLOCK ||
 			    errno == EAGAIN) {
@@ -192,31 +437,63 @@ void MatchMaking::sync_enemy_queue(
 			break;
 		}
 
-		buffer[recv_size] = '\0';
-		std::string received_data(buffer);
+		if (!reader.feed(buffer, recv_size, push)) {
+			Logger::get_instance()
+				<< "(MM):\t\t Malformed message received\n";
+			break;
+		}
+	}
+}
 
-		if (recv_size < 1)
+template <typename Callback>
+void MatchMaking::receive_datagrams(uint8_t *buffer, size_t capacity,
+				    Wire::Reader &reader, Callback &push)
+{
+	auto last_received = std::chrono::steady_clock::now();
+	pollfd fds[2] = { { datagram_sock, POLLIN, 0 }, { sock, POLLIN, 0 } };
+	while (match_running) {
+		if (std::chrono::steady_clock::now() - last_received >=
+		    std::chrono::seconds(60)) {
+#ifdef AWS_DEBUG
+			std::cout
+				<< "(AWS) No data received in 60 seconds. Ending match.\n";
+#endif
+			this->match_outcome = -1;
+			this->match_running = false;
+			break;
+		}
+		// Wakes now and then to notice the match ending
+		if (poll(fds, 2, 100) <= 0)
 			continue;
-		size_t comma_pos = received_data.find(',');
-		if (comma_pos != std::string::npos) {
-			try {
-				int32_t x = std::stoi(
-					received_data.substr(0, comma_pos));
-
-				std::vector<float> y;
-				std::string floats_part =
-					received_data.substr(comma_pos + 1);
-				std::istringstream ss(floats_part);
-				std::string token;
-				while (std::getline(ss, token, ',')) {
-					y.push_back(std::stof(token));
-				}
-				enemy_queue->push({ x, y });
-			} catch (const std::invalid_argument &e) {
-				// std::cerr << "MM:\t\tMalformed state received: "
-				// 	  << received_data << '\n';
+
+		// The relay still passes on whatever the peer sends over the
+		// stream, and its closing ends the match
+		if (fds[1].revents) {
+			ssize_t size =
+				recv(sock, buffer, capacity, MSG_DONTWAIT);
+			if (size == 0 || (size < 0 && errno != EAGAIN &&
+					  errno != EWOULDBLOCK)) {
+				this->match_outcome = -1;
+				this->match_running = false;
+				break;
+			}
+			if (size > 0 && !reader.feed(buffer, size, push)) {
+				Logger::get_instance()
+					<< "(MM):\t\t Malformed message "
+					   "received\n";
+				break;
 			}
 		}
+
+		if (!(fds[0].revents & POLLIN))
+			continue;
+		ssize_t size = recv(datagram_sock, buffer, capacity, 0);
+		if (size <= 0)
+			continue;
+
+		std::lock_guard<std::mutex> lock(channel_mutex);
+		if (channel.read_packet(buffer, size, push))
+			last_received = std::chrono::steady_clock::now();
 	}
 }
 
@@ -0,0 +1,168 @@
+#include <multiplayer/NetChannel.h>
+
+#include <cstring>
+
+#define ACK_VALID 0x80
+#define RELIABLE_COUNT_MASK 0x7f
+#define ACK_BITS 32
+
+static void write_u16(uint8_t *buffer, uint16_t value)
+{
+	buffer[0] = static_cast<uint8_t>(value);
+	buffer[1] = static_cast<uint8_t>(value >> 8);
+}
+
+static uint16_t read_u16(const uint8_t *buffer)
+{
+	return buffer[0] | (buffer[1] << 8);
+}
+
+// Whether a is after b, as far as 16 bit sequences wrap around
+static bool is_newer(uint16_t a, uint16_t b)
+{
+	return static_cast<int16_t>(a - b) > 0;
+}
+
+size_t NetChannel::message_size(const uint8_t *buffer, size_t size,
+				size_t offset)
+{
+	if (size - offset < Wire::HEADER_SIZE)
+		return 0;
+	size_t length = Wire::LENGTH_SIZE + read_u16(buffer + offset);
+	if (length < Wire::HEADER_SIZE || length > size - offset)
+		return 0;
+	return length;
+}
+
+bool NetChannel::send_reliable(const uint8_t *message, size_t size)
+{
+	if (static_cast<uint16_t>(next_reliable - oldest_reliable) >=
+		    MAX_RELIABLE ||
+	    size > Wire::MAX_MESSAGE_SIZE) {
+		return false;
+	}
+	Reliable &entry = reliable[next_reliable % MAX_RELIABLE];
+	std::memcpy(entry.message, message, size);
+	entry.size = size;
+	next_reliable++;
+	return true;
+}
+
+bool NetChannel::has_unacknowledged() const noexcept
+{
+	return oldest_reliable != next_reliable;
+}
+
+size_t NetChannel::write_packet(const uint8_t *unreliable,
+				size_t unreliable_size, uint8_t *packet)
+{
+	uint16_t sequence = next_sequence++;
+
+	// As many waiting reliable messages as fit, oldest first
+	int32_t reliable_count = 0;
+	size_t offset = HEADER_SIZE + 2;
+	uint16_t id = oldest_reliable;
+	while (id != next_reliable && reliable_count < RELIABLE_COUNT_MASK) {
+		const Reliable &entry = reliable[id % MAX_RELIABLE];
+		if (offset + entry.size > MAX_PACKET_SIZE)
+			break;
+		std::memcpy(packet + offset, entry.message, entry.size);
+		offset += entry.size;
+		reliable_count++;
+		id++;
+	}
+	if (!reliable_count)
+		offset = HEADER_SIZE;
+
+	write_u16(packet, sequence);
+	write_u16(packet + 2, newest_received);
+	for (int32_t i = 0; i < 4; i++) {
+		packet[4 + i] = static_cast<uint8_t>(received_bits >> (8 * i));
+	}
+	packet[8] = (has_received ? ACK_VALID : 0) | reliable_count;
+	if (reliable_count)
+		write_u16(packet + HEADER_SIZE, oldest_reliable);
+
+	Sent &record = sent[sequence % SENT_HISTORY];
+	record.sequence = sequence;
+	record.reliable_end = oldest_reliable + reliable_count;
+	record.valid = reliable_count > 0;
+
+	size_t read = 0;
+	while (read < unreliable_size) {
+		size_t length = message_size(unreliable, unreliable_size, read);
+		if (!length || offset + length > MAX_PACKET_SIZE)
+			break;
+		std::memcpy(packet + offset, unreliable + read, length);
+		offset += length;
+		read += length;
+	}
+	return offset;
+}
+
+void NetChannel::acknowledge(uint16_t sequence)
+{
+	Sent &record = sent[sequence % SENT_HISTORY];
+	if (!record.valid || record.sequence != sequence)
+		return;
+	record.valid = false;
+	// The peer delivers in order, so everything before the end arrived
+	if (is_newer(record.reliable_end, oldest_reliable))
+		oldest_reliable = record.reliable_end;
+}
+
+bool NetChannel::accept(const uint8_t *packet, size_t size, size_t &offset,
+			int32_t &reliable_count, uint16_t &first_reliable)
+{
+	if (size < HEADER_SIZE || size > MAX_PACKET_SIZE)
+		return false;
+
+	uint16_t sequence = read_u16(packet);
+	if (has_received && !is_newer(sequence, newest_received))
+		return false;
+
+	uint8_t flags = packet[8];
+	reliable_count = flags & RELIABLE_COUNT_MASK;
+	offset = HEADER_SIZE;
+	if (reliable_count) {
+		if (size < HEADER_SIZE + 2)
+			return false;
+		first_reliable = read_u16(packet + HEADER_SIZE);
+		offset += 2;
+	}
+	for (size_t walk = offset; walk < size;) {
+		size_t length = message_size(packet, size, walk);
+		if (!length)
+			return false;
+		walk += length;
+	}
+
+	if (flags & ACK_VALID) {
+		uint16_t ack = read_u16(packet + 2);
+		uint32_t bits = 0;
+		for (int32_t i = 0; i < 4; i++) {
+			bits |= static_cast<uint32_t>(packet[4 + i]) << (8 * i);
+		}
+		acknowledge(ack);
+		for (int32_t i = 0; i < ACK_BITS; i++) {
+			if (bits >> i & 1)
+				acknowledge(ack - 1 - i);
+		}
+	}
+
+	if (has_received) {
+		// The previous newest joins the bits, gap - 1 behind this one
+		uint16_t gap = sequence - newest_received;
+		if (gap > ACK_BITS) {
+			received_bits = 0;
+		} else if (gap == ACK_BITS) {
+			received_bits = 1u << (ACK_BITS - 1);
+		} else {
+			received_bits = received_bits << gap |
+					1u << (gap - 1);
+		}
+	}
+	has_received = true;
+	newest_received = sequence;
+	return true;
+}
@@ -0,0 +1,327 @@
+#include <multiplayer/SnapshotCodec.h>
+
+#include <multiplayer/BitPacker.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#define SEQUENCE_BITS 16
+#define TICK_BITS 32
+#define TICK_DELTA_BITS 10 // Ticks after the baseline, when fewer
+#define OFFSET_BITS 6 // Baseline distance, below HISTORY
+#define DELTA_BITS 7
+#define LARGEST_BITS 2
+
+static_assert((1 << OFFSET_BITS) == SnapshotCodec::HISTORY);
+static_assert(SnapshotCodec::MAX_SIZE <=
+	      Move::MAX_VALUES * sizeof(float)); // Fits a Wire message
+static_assert(SnapshotCodec::MAX_SIZE * 8 >=
+	      SEQUENCE_BITS + 1 + OFFSET_BITS + 1 + TICK_BITS + 4 +
+		      3 * (1 + SnapshotCodec::MAX_BITS) * 4 + 1 +
+		      LARGEST_BITS); // The largest snapshot
+
+static const float ROTATION_BOUND = 1.0f / std::sqrt(2.0f);
+
+static uint32_t quantize_value(float value, float min, float max,
+			       int32_t bits)
+{
+	uint32_t steps = (1u << bits) - 1;
+	if (!(value > min)) // NaN too
+		return 0;
+	if (value >= max)
+		return steps;
+	return static_cast<uint32_t>(
+		std::lround((value - min) / (max - min) * steps));
+}
+
+static float dequantize_value(uint32_t value, float min, float max,
+			      int32_t bits)
+{
+	uint32_t steps = (1u << bits) - 1;
+	return min + (max - min) * value / steps;
+}
+
+// Components of one group, against the baseline's when there is one
+static void write_group(BitWriter &writer, const uint32_t *values,
+			const uint32_t *base, int32_t count, int32_t bits)
+{
+	if (!base) {
+		for (int32_t i = 0; i < count; i++) {
+			writer.write(values[i], bits);
+		}
+		return;
+	}
+
+	bool changed = !std::equal(values, values + count, base);
+	writer.write_bool(changed);
+	if (!changed)
+		return;
+
+	const int32_t limit = 1 << (DELTA_BITS - 1);
+	for (int32_t i = 0; i < count; i++) {
+		int32_t delta = static_cast<int32_t>(values[i] - base[i]);
+		if (delta >= -limit && delta < limit) {
+			writer.write_bool(false);
+			// Zigzag, small deltas of either sign in few bits
+			writer.write((delta << 1) ^ (delta >> 31), DELTA_BITS);
+		} else {
+			writer.write_bool(true);
+			writer.write(values[i], bits);
+		}
+	}
+}
+
+static void read_group(BitReader &reader, uint32_t *values,
+		       const uint32_t *base, int32_t count, int32_t bits)
+{
+	if (!base) {
+		for (int32_t i = 0; i < count; i++) {
+			values[i] = reader.read(bits);
+		}
+		return;
+	}
+
+	if (!reader.read_bool()) {
+		std::copy(base, base + count, values);
+		return;
+	}
+
+	uint32_t mask = (1u << bits) - 1;
+	for (int32_t i = 0; i < count; i++) {
+		if (reader.read_bool()) {
+			values[i] = reader.read(bits);
+		} else {
+			uint32_t zigzag = reader.read(DELTA_BITS);
+			int32_t delta = static_cast<int32_t>(zigzag >> 1) ^
+					-static_cast<int32_t>(zigzag & 1);
+			values[i] = (base[i] + delta) & mask;
+		}
+	}
+}
+
+SnapshotCodec::SnapshotCodec(const Settings &settings)
+	: settings(settings)
+{
+	for (int32_t bits : { settings.position_bits, settings.rotation_bits,
+			      settings.velocity_bits, settings.angular_bits }) {
+		if (bits < DELTA_BITS || bits > MAX_BITS) {
+			std::cerr << "Error: Snapshot values take "
+				  << DELTA_BITS << " to " << MAX_BITS
+				  << " bits, not " << bits << "\r\n";
+			throw std::runtime_error("Invalid snapshot bits");
+		}
+	}
+	if (!(settings.position_max > settings.position_min) ||
+	    !(settings.max_velocity > 0) ||
+	    !(settings.max_angular_velocity > 0)) {
+		std::cerr << "Error: Snapshot ranges must not be empty\r\n";
+		throw std::runtime_error("Invalid snapshot ranges");
+	}
+}
+
+SnapshotCodec::Quantized SnapshotCodec::quantize(const Move &move) const
+{
+	const float *state = move.values;
+	Quantized quantized;
+	quantized.tick = move.tick;
+	for (int32_t i = 0; i < 3; i++) {
+		quantized.position[i] = quantize_value(
+			state[i], settings.position_min, settings.position_max,
+			settings.position_bits);
+		quantized.velocity[i] = quantize_value(
+			state[7 + i], -settings.max_velocity,
+			settings.max_velocity, settings.velocity_bits);
+		quantized.angular[i] = quantize_value(
+			state[10 + i], -settings.max_angular_velocity,
+			settings.max_angular_velocity, settings.angular_bits);
+	}
+
+	float rotation[4];
+	float length = 0.0f;
+	for (int32_t i = 0; i < 4; i++) {
+		rotation[i] = state[3 + i];
+		length += rotation[i] * rotation[i];
+	}
+	length = length > 0.0f ? std::sqrt(length) : 1.0f;
+
+	int32_t largest = 0;
+	for (int32_t i = 1; i < 4; i++) {
+		if (std::fabs(rotation[i]) > std::fabs(rotation[largest]))
+			largest = i;
+	}
+	// q and -q are the same rotation, keep the largest positive
+	float sign = rotation[largest] < 0.0f ? -1.0f : 1.0f;
+	quantized.largest = largest;
+	for (int32_t i = 0, j = 0; i < 4; i++) {
+		if (i == largest)
+			continue;
+		quantized.rotation[j++] = quantize_value(
+			sign * rotation[i] / length, -ROTATION_BOUND,
+			ROTATION_BOUND, settings.rotation_bits);
+	}
+	return quantized;
+}
+
+void SnapshotCodec::dequantize(const Quantized &quantized, Move &move) const
+{
+	move.action = Move::SYNC;
+	move.count = Move::MAX_VALUES;
+	move.tick = quantized.tick;
+	float *state = move.values;
+	for (int32_t i = 0; i < 3; i++) {
+		state[i] = dequantize_value(quantized.position[i],
+					    settings.position_min,
+					    settings.position_max,
+					    settings.position_bits);
+		state[7 + i] = dequantize_value(quantized.velocity[i],
+						-settings.max_velocity,
+						settings.max_velocity,
+						settings.velocity_bits);
+		state[10 + i] = dequantize_value(
+			quantized.angular[i], -settings.max_angular_velocity,
+			settings.max_angular_velocity, settings.angular_bits);
+	}
+
+	float sum = 0.0f;
+	for (int32_t i = 0, j = 0; i < 4; i++) {
+		if (i == static_cast<int32_t>(quantized.largest))
+			continue;
+		float value = dequantize_value(quantized.rotation[j++],
+					       -ROTATION_BOUND, ROTATION_BOUND,
+					       settings.rotation_bits);
+		state[3 + i] = value;
+		sum += value * value;
+	}
+	state[3 + quantized.largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+}
+
+const SnapshotCodec::Quantized *SnapshotCodec::find(uint16_t sequence) const
+{
+	const Entry &entry = history[sequence % HISTORY];
+	return entry.valid && entry.sequence == sequence ? &entry.state :
+							   nullptr;
+}
+
+void SnapshotCodec::store(uint16_t sequence, const Quantized &quantized)
+{
+	Entry &entry = history[sequence % HISTORY];
+	entry.state = quantized;
+	entry.sequence = sequence;
+	entry.valid = true;
+}
+
+size_t SnapshotCodec::encode(const Move &move, uint8_t *buffer,
+			     size_t capacity)
+{
+	if (move.action != Move::SYNC || move.count < Move::MAX_VALUES)
+		return 0;
+
+	uint16_t sequence = next_sequence++;
+	Quantized quantized = quantize(move);
+
+	const Quantized *base = nullptr;
+	uint16_t offset = 0;
+	if (baseline >= 0) {
+		offset = sequence - static_cast<uint16_t>(baseline);
+		if (offset > 0 && offset < HISTORY)
+			base = find(baseline);
+	}
+
+	BitWriter writer(buffer, std::min(capacity, MAX_SIZE));
+	writer.write(sequence, SEQUENCE_BITS);
+	writer.write_bool(base);
+	if (base)
+		writer.write(offset, OFFSET_BITS);
+
+	// Snapshots are rarely far enough apart for the whole tick
+	uint32_t tick_delta = base ? quantized.tick - base->tick : 0;
+	bool tick_short = base && tick_delta < (1u << TICK_DELTA_BITS);
+	if (base)
+		writer.write_bool(tick_short);
+	if (tick_short)
+		writer.write(tick_delta, TICK_DELTA_BITS);
+	else
+		writer.write(quantized.tick, TICK_BITS);
+
+	write_group(writer, quantized.position, base ? base->position : nullptr,
+		    3, settings.position_bits);
+
+	// Against a baseline with another largest component the other three
+	// are different components, nothing to take a delta of
+	const Quantized *rotation_base =
+		base && base->largest == quantized.largest ? base : nullptr;
+	if (base)
+		writer.write_bool(rotation_base);
+	if (!rotation_base)
+		writer.write(quantized.largest, LARGEST_BITS);
+	write_group(writer, quantized.rotation,
+		    rotation_base ? rotation_base->rotation : nullptr, 3,
+		    settings.rotation_bits);
+
+	write_group(writer, quantized.velocity, base ? base->velocity : nullptr,
+		    3, settings.velocity_bits);
+	write_group(writer, quantized.angular, base ? base->angular : nullptr,
+		    3, settings.angular_bits);
+
+	store(sequence, quantized);
+	return writer.is_overflowed() ? 0 : writer.get_size();
+}
+
+void SnapshotCodec::acknowledge(uint16_t sequence)
+{
+	if (!find(sequence))
+		return;
+	// Newer than the current baseline, as far as 16 bits wrap around
+	if (baseline < 0 ||
+	    static_cast<int16_t>(sequence - static_cast<uint16_t>(baseline)) >
+		    0) {
+		baseline = sequence;
+	}
+}
+
+bool SnapshotCodec::decode(const uint8_t *buffer, size_t size, Move &move,
+			   uint16_t &sequence)
+{
+	BitReader reader(buffer, size);
+	sequence = reader.read(SEQUENCE_BITS);
+
+	const Quantized *base = nullptr;
+	uint16_t offset = 0;
+	if (reader.read_bool()) {
+		offset = reader.read(OFFSET_BITS);
+		base = find(static_cast<uint16_t>(sequence - offset));
+		if (!base || !offset)
+			return false;
+	}
+
+	Quantized quantized;
+	if (base && reader.read_bool()) {
+		quantized.tick = base->tick + reader.read(TICK_DELTA_BITS);
+	} else {
+		quantized.tick = reader.read(TICK_BITS);
+	}
+	read_group(reader, quantized.position, base ? base->position : nullptr,
+		   3, settings.position_bits);
+
+	const Quantized *rotation_base =
+		base && reader.read_bool() ? base : nullptr;
+	quantized.largest = rotation_base ? rotation_base->largest :
+					    reader.read(LARGEST_BITS);
+	read_group(reader, quantized.rotation,
+		   rotation_base ? rotation_base->rotation : nullptr, 3,
+		   settings.rotation_bits);
+
+	read_group(reader, quantized.velocity, base ? base->velocity : nullptr,
+		   3, settings.velocity_bits);
+	read_group(reader, quantized.angular, base ? base->angular : nullptr, 3,
+		   settings.angular_bits);
+
+	if (reader.is_overflowed())
+		return false;
+
+	store(sequence, quantized);
+	dequantize(quantized, move);
+	return true;
+}
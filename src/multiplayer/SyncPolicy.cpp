@@ -0,0 +1,64 @@
+#include <multiplayer/SyncPolicy.h>
+
+#include <algorithm>
+#include <cmath>
+
+SyncPolicy::SyncPolicy(const Settings &settings)
+	: settings(settings)
+{
+}
+
+SyncPolicy::Trigger SyncPolicy::update(float delta,
+				       const InterpolationBuffer::State &state)
+{
+	ticks++;
+
+	Trigger trigger = Trigger::NONE;
+	if (!has_sent || ticks >= settings.interval) {
+		trigger = Trigger::INTERVAL;
+		counters.interval++;
+	} else {
+		// What the receiver shows once it gets no state this tick
+		float time = std::min(ticks * delta,
+				      settings.max_extrapolation);
+		InterpolationBuffer::State predicted =
+			InterpolationBuffer::extrapolate(sent, time);
+
+		float cos_half = std::fabs(
+			predicted.orientation.dot(state.orientation));
+		float angle = 2 * std::acos(std::min(cos_half, 1.0f));
+
+		if ((predicted.position - state.position).length() >
+		    settings.position_threshold) {
+			trigger = Trigger::POSITION;
+			counters.position++;
+		} else if (angle > settings.orientation_threshold) {
+			trigger = Trigger::ORIENTATION;
+			counters.orientation++;
+		}
+	}
+
+	if (trigger == Trigger::NONE) {
+		counters.skipped++;
+	} else {
+		has_sent = true;
+		sent = state;
+		ticks = 0;
+	}
+	return trigger;
+}
+
+void SyncPolicy::count_action() noexcept
+{
+	counters.action++;
+}
+
+const SyncPolicy::Counters &SyncPolicy::get_counters() const noexcept
+{
+	return counters;
+}
+
+void SyncPolicy::reset_counters() noexcept
+{
+	counters = {};
+}
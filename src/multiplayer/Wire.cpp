@@ -0,0 +1,163 @@
+#include <multiplayer/Wire.h>
+
+#include <cstring>
+
+static void write_u32(uint8_t *buffer, uint32_t value)
+{
+	for (int32_t i = 0; i < 4; i++) {
+		buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+}
+
+static uint32_t read_u32(const uint8_t *buffer)
+{
+	uint32_t value = 0;
+	for (int32_t i = 0; i < 4; i++) {
+		value |= static_cast<uint32_t>(buffer[i]) << (8 * i);
+	}
+	return value;
+}
+
+static void write_float(uint8_t *buffer, float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	write_u32(buffer, bits);
+}
+
+static float read_float(const uint8_t *buffer)
+{
+	uint32_t bits = read_u32(buffer);
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+size_t Wire::write_header(MessageType type, size_t payload_size,
+			  uint8_t *buffer)
+{
+	size_t length = 1 + payload_size;
+	buffer[0] = static_cast<uint8_t>(length);
+	buffer[1] = static_cast<uint8_t>(length >> 8);
+	buffer[2] = static_cast<uint8_t>(type);
+	return LENGTH_SIZE + length;
+}
+
+Wire::MessageType Wire::get_type(const uint8_t *message) noexcept
+{
+	return static_cast<MessageType>(message[LENGTH_SIZE]);
+}
+
+size_t Wire::encode(const Move &move, uint8_t *buffer)
+{
+	uint8_t *payload = buffer + HEADER_SIZE;
+	size_t payload_size = 0;
+	MessageType type;
+
+	switch (move.action) {
+	case 0:
+	case 1:
+	case 2:
+	case 3:
+	case 4:
+	case 5:
+	case 7:
+		type = MessageType::ACTION;
+		payload[0] = static_cast<uint8_t>(move.action);
+		write_float(payload + 1, move.count ? move.values[0] : 0.0f);
+		payload_size = 1 + sizeof(float);
+		break;
+	case 6:
+		type = MessageType::SHOT;
+		break;
+	case Move::SYNC:
+		if (move.count < Move::MAX_VALUES)
+			return 0;
+		type = MessageType::STATE;
+		write_u32(payload, move.tick);
+		for (int32_t i = 0; i < Move::MAX_VALUES; i++) {
+			write_float(payload + (i + 1) * sizeof(float),
+				    move.values[i]);
+		}
+		payload_size = MAX_PAYLOAD_SIZE;
+		break;
+	default:
+		return 0;
+	}
+
+	return write_header(type, payload_size, buffer);
+}
+
+bool Wire::decode(const uint8_t *message, size_t size, Move &move)
+{
+	if (size < HEADER_SIZE)
+		return false;
+
+	const uint8_t *payload = message + HEADER_SIZE;
+	size_t payload_size = size - HEADER_SIZE;
+
+	switch (get_type(message)) {
+	case MessageType::ACTION:
+		if (payload_size != 1 + sizeof(float) || payload[0] > 7 ||
+		    payload[0] == 6) {
+			return false;
+		}
+		move.action = payload[0];
+		move.count = 1;
+		move.values[0] = read_float(payload + 1);
+		return true;
+	case MessageType::STATE:
+		if (payload_size != MAX_PAYLOAD_SIZE)
+			return false;
+		move.action = Move::SYNC;
+		move.count = Move::MAX_VALUES;
+		move.tick = read_u32(payload);
+		for (int32_t i = 0; i < Move::MAX_VALUES; i++) {
+			move.values[i] =
+				read_float(payload + (i + 1) * sizeof(float));
+		}
+		return true;
+	case MessageType::SHOT:
+		if (payload_size)
+			return false;
+		move.action = 6;
+		move.count = 0;
+		return true;
+	default:
+		return false;
+	}
+}
+
+size_t Wire::encode_ack(uint16_t sequence, uint8_t *buffer)
+{
+	buffer[HEADER_SIZE] = static_cast<uint8_t>(sequence);
+	buffer[HEADER_SIZE + 1] = static_cast<uint8_t>(sequence >> 8);
+	return write_header(MessageType::ACK, 2, buffer);
+}
+
+bool Wire::decode_ack(const uint8_t *message, size_t size,
+		      uint16_t &sequence)
+{
+	if (size != HEADER_SIZE + 2 || get_type(message) != MessageType::ACK)
+		return false;
+	sequence = message[HEADER_SIZE] | (message[HEADER_SIZE + 1] << 8);
+	return true;
+}
+
+size_t Wire::encode_transport(bool datagrams, uint8_t *buffer)
+{
+	buffer[HEADER_SIZE] = datagrams;
+	return write_header(MessageType::TRANSPORT, 1, buffer);
+}
+
+bool Wire::decode_transport(const uint8_t *message, size_t size,
+			    bool &datagrams)
+{
+	if (size != HEADER_SIZE + 1 ||
+	    get_type(message) != MessageType::TRANSPORT ||
+	    message[HEADER_SIZE] > 1) {
+		return false;
+	}
+	datagrams = message[HEADER_SIZE];
+	return true;
+}
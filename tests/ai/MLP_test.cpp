@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <ai/MLP.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// 11 -> 13 -> 3, widths chosen so neither is a multiple of 8
+class MLPTest : public ::testing::Test {
+    protected:
+	std::vector<float> w0, b0, w1, b1;
+	MLP mlp;
+
+	void SetUp() override
+	{
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+		w0.resize(13 * 11);
+		b0.resize(13);
+		w1.resize(3 * 13);
+		b1.resize(3);
+		for (std::vector<float> *values : { &w0, &b0, &w1, &b1 }) {
+			for (float &value : *values) {
+				value = dist(rng);
+			}
+		}
+		mlp.add_layer(11, 13, MLP::Activation::TANH, w0.data(),
+			      b0.data());
+		mlp.add_layer(13, 3, MLP::Activation::NONE, w1.data(),
+			      b1.data());
+	}
+
+	std::vector<float> reference(const float *input)
+	{
+		std::vector<float> hidden(13), output(3);
+		for (int32_t o = 0; o < 13; o++) {
+			float sum = b0[o];
+			for (int32_t i = 0; i < 11; i++) {
+				sum += w0[o * 11 + i] * input[i];
+			}
+			hidden[o] = std::tanh(sum);
+		}
+		for (int32_t o = 0; o < 3; o++) {
+			float sum = b1[o];
+			for (int32_t i = 0; i < 13; i++) {
+				sum += w1[o * 13 + i] * hidden[i];
+			}
+			output[o] = sum;
+		}
+		return output;
+	}
+};
+
+TEST_F(MLPTest, TestSizes)
+{
+	EXPECT_EQ(mlp.get_input_size(), 11);
+	EXPECT_EQ(mlp.get_output_size(), 3);
+}
+
+TEST_F(MLPTest, TestForwardMatchesReference)
+{
+	float input[11];
+	for (int32_t i = 0; i < 11; i++) {
+		input[i] = 0.1f * i - 0.5f;
+	}
+
+	float output[3];
+	mlp.forward(input, output);
+	std::vector<float> expected = reference(input);
+	for (int32_t o = 0; o < 3; o++) {
+		EXPECT_NEAR(output[o], expected[o], 1e-5f);
+	}
+}
+
+TEST_F(MLPTest, TestForwardBatchMatchesForward)
+{
+	const int32_t count = 5;
+	std::vector<float> inputs(count * 11), outputs(count * 3);
+	for (size_t i = 0; i < inputs.size(); i++) {
+		inputs[i] = std::sin(0.37f * i);
+	}
+
+	mlp.forward_batch(inputs.data(), count, outputs.data());
+	for (int32_t r = 0; r < count; r++) {
+		float expected[3];
+		mlp.forward(inputs.data() + r * 11, expected);
+		for (int32_t o = 0; o < 3; o++) {
+			EXPECT_FLOAT_EQ(outputs[r * 3 + o], expected[o]);
+		}
+	}
+}
+
+TEST_F(MLPTest, TestArgmaxAndSample)
+{
+	float input[11] = { 1.0f, -1.0f, 0.5f };
+	std::vector<float> expected = reference(input);
+	int32_t best = 0;
+	for (int32_t o = 1; o < 3; o++) {
+		if (expected[o] > expected[best])
+			best = o;
+	}
+	EXPECT_EQ(mlp.argmax(input), best);
+
+	EXPECT_EQ(MLP::argmax_logits(expected.data(), 3), best);
+
+	std::mt19937 rng(1);
+	for (int32_t i = 0; i < 100; i++) {
+		int32_t action = mlp.sample(input, rng);
+		EXPECT_GE(action, 0);
+		EXPECT_LT(action, 3);
+	}
+}
+
+TEST_F(MLPTest, TestMismatchedLayerThrows)
+{
+	EXPECT_THROW(mlp.add_layer(4, 2, MLP::Activation::NONE, w1.data(),
+				   b1.data()),
+		     std::runtime_error);
+}
+
+TEST_F(MLPTest, TestLoad)
+{
+	const char *path = "MLP_test.mlp";
+	{
+		std::ofstream file(path, std::ios::binary);
+		auto put = [&file](const void *data, size_t size) {
+			file.write(static_cast<const char *>(data), size);
+		};
+		uint32_t header[3] = { MLP::MAGIC, MLP::VERSION, 2 };
+		uint32_t layer0[3] = { 11, 13, 1 };
+		uint32_t layer1[3] = { 13, 3, 0 };
+		put(header, sizeof(header));
+		put(layer0, sizeof(layer0));
+		put(w0.data(), w0.size() * sizeof(float));
+		put(b0.data(), b0.size() * sizeof(float));
+		put(layer1, sizeof(layer1));
+		put(w1.data(), w1.size() * sizeof(float));
+		put(b1.data(), b1.size() * sizeof(float));
+	}
+
+	MLP loaded = MLP::load(path);
+	std::remove(path);
+
+	float input[11] = { 0.3f, 0.2f, 0.1f };
+	float expected[3], output[3];
+	mlp.forward(input, expected);
+	loaded.forward(input, output);
+	for (int32_t o = 0; o < 3; o++) {
+		EXPECT_FLOAT_EQ(output[o], expected[o]);
+	}
+}
+
+TEST_F(MLPTest, TestLoadMissingFileThrows)
+{
+	EXPECT_THROW(MLP::load("does_not_exist.mlp"), std::runtime_error);
+}
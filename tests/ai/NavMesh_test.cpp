@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <ai/NavMesh.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+// A 20 x 20 floor at z 0, optionally split by a wall at x 10 that leaves a
+// gap for y above 15
+class NavMeshTest : public ::testing::Test {
+    protected:
+	std::vector<float> positions;
+	std::vector<int32_t> indices;
+	NavMesh::Settings settings;
+
+	void add_quad(const Vector3f &a, const Vector3f &b, const Vector3f &c,
+		      const Vector3f &d)
+	{
+		int32_t first = positions.size() / 3;
+		for (const Vector3f *corner : { &a, &b, &c, &d }) {
+			positions.push_back(corner->getX());
+			positions.push_back(corner->getY());
+			positions.push_back(corner->getZ());
+		}
+		for (int32_t index : { 0, 1, 2, 0, 2, 3 }) {
+			indices.push_back(first + index);
+		}
+	}
+
+	void add_floor(float x0, float x1)
+	{
+		add_quad({ x0, 0, 0 }, { x1, 0, 0 }, { x1, 20, 0 },
+			 { x0, 20, 0 });
+	}
+
+	void add_wall()
+	{
+		add_quad({ 10, 0, 0 }, { 10, 15, 0 }, { 10, 15, 3 },
+			 { 10, 0, 3 });
+	}
+
+	// Whether every point along the path can be stood on
+	bool walkable(const NavMesh &mesh, const std::vector<Vector3f> &path)
+	{
+		for (size_t i = 0; i + 1 < path.size(); i++) {
+			for (int32_t step = 0; step <= 50; step++) {
+				Vector3f point =
+					path[i].lerp(path[i + 1], step / 50.0f);
+				if (!mesh.is_walkable(point.getX(),
+						      point.getY()))
+					return false;
+			}
+		}
+		return true;
+	}
+};
+
+TEST_F(NavMeshTest, TestErodesEdges)
+{
+	add_floor(0, 20);
+	NavMesh mesh = NavMesh::build(positions, indices, settings);
+
+	EXPECT_GT(mesh.get_polygon_count(), 0);
+	EXPECT_TRUE(mesh.is_walkable(10, 10));
+	EXPECT_FALSE(mesh.is_walkable(0.1f, 10));
+	EXPECT_FALSE(mesh.is_walkable(10, 19.9f));
+	EXPECT_FALSE(mesh.is_walkable(30, 10));
+}
+
+TEST_F(NavMeshTest, TestOpenFloorPathIsStraight)
+{
+	add_floor(0, 20);
+	NavMesh mesh = NavMesh::build(positions, indices, settings);
+
+	std::vector<Vector3f> path;
+	ASSERT_TRUE(mesh.find_path({ 5, 5, 0 }, { 15, 12, 0 }, path));
+	ASSERT_EQ(path.size(), 2u);
+	EXPECT_TRUE(path.front().is_close({ 5, 5, 0 }, 1e-4f));
+	EXPECT_TRUE(path.back().is_close({ 15, 12, 0 }, 1e-4f));
+}
+
+TEST_F(NavMeshTest, TestPathGoesAroundWall)
+{
+	add_floor(0, 20);
+	add_wall();
+	NavMesh mesh = NavMesh::build(positions, indices, settings);
+	EXPECT_FALSE(mesh.is_walkable(10, 5));
+
+	std::vector<Vector3f> path;
+	ASSERT_TRUE(mesh.find_path({ 5, 5, 0 }, { 15, 5, 0 }, path));
+	EXPECT_GT(path.size(), 2u);
+	EXPECT_TRUE(walkable(mesh, path));
+
+	// Around the end of the wall, so over the gap, and not much farther
+	float length = 0.0f;
+	float highest = 0.0f;
+	for (size_t i = 0; i + 1 < path.size(); i++) {
+		length += (path[i + 1] - path[i]).length();
+		highest = std::max(highest, path[i + 1].getY());
+	}
+	EXPECT_GT(highest, 15.0f);
+	EXPECT_LT(length, 2.0f * std::hypot(5.0f, 11.0f) + 1.0f);
+}
+
+TEST_F(NavMeshTest, TestDisconnectedFloorsHaveNoPath)
+{
+	add_floor(0, 8);
+	add_floor(12, 20);
+	NavMesh mesh = NavMesh::build(positions, indices, settings);
+
+	std::vector<Vector3f> path;
+	EXPECT_FALSE(mesh.find_path({ 4, 10, 0 }, { 16, 10, 0 }, path));
+	EXPECT_TRUE(path.empty());
+	// Cached the second time
+	EXPECT_FALSE(mesh.find_path({ 4, 10, 0 }, { 16, 10, 0 }, path));
+	EXPECT_TRUE(mesh.find_path({ 2, 3, 0 }, { 6, 17, 0 }, path));
+}
+
+TEST_F(NavMeshTest, TestSaveAndLoad)
+{
+	add_floor(0, 20);
+	add_wall();
+	NavMesh mesh = NavMesh::build(positions, indices, settings);
+
+	const char *path = "NavMesh_test.nav";
+	mesh.save(path);
+	NavMesh loaded = NavMesh::load(path);
+	std::remove(path);
+
+	EXPECT_EQ(loaded.get_polygon_count(), mesh.get_polygon_count());
+	EXPECT_EQ(loaded.get_source_hash(), mesh.get_source_hash());
+
+	std::vector<Vector3f> expected, actual;
+	ASSERT_TRUE(mesh.find_path({ 5, 5, 0 }, { 15, 5, 0 }, expected));
+	ASSERT_TRUE(loaded.find_path({ 5, 5, 0 }, { 15, 5, 0 }, actual));
+	ASSERT_EQ(actual.size(), expected.size());
+	for (size_t i = 0; i < actual.size(); i++) {
+		EXPECT_TRUE(actual[i].is_close(expected[i], 1e-5f));
+	}
+}
+
+TEST_F(NavMeshTest, TestBakeRebuildsOnChange)
+{
+	add_floor(0, 20);
+	const char *path = "NavMesh_bake_test.nav";
+	std::remove(path);
+
+	NavMesh first = NavMesh::bake(positions, indices, settings, path);
+	NavMesh again = NavMesh::bake(positions, indices, settings, path);
+	EXPECT_EQ(again.get_source_hash(), first.get_source_hash());
+	EXPECT_EQ(again.get_polygon_count(), first.get_polygon_count());
+
+	add_wall();
+	NavMesh changed = NavMesh::bake(positions, indices, settings, path);
+	std::remove(path);
+	EXPECT_NE(changed.get_source_hash(), first.get_source_hash());
+	EXPECT_FALSE(changed.is_walkable(10, 5));
+}
+
+TEST_F(NavMeshTest, TestLoadMissingFileThrows)
+{
+	EXPECT_THROW(NavMesh::load("does_not_exist.nav"), std::runtime_error);
+}
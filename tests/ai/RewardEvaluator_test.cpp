@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <ai/RewardEvaluator.h>
+
+#include <stdexcept>
+
+// Without a config file every [Reward] key takes its default
+class RewardEvaluatorTest : public ::testing::Test {
+    protected:
+	RewardEvaluator rewards;
+	ObservationBuilder::Observation observation = {};
+
+	void SetUp() override
+	{
+		observation.agent_hp = 100.0f;
+		observation.target_hp = 50.0f;
+		observation.distance_error = -2.0f;
+		observation.yaw_error = 0.5f;
+	}
+};
+
+TEST_F(RewardEvaluatorTest, TestRange)
+{
+	rewards.set_mode(RewardEvaluator::Mode::RANGE);
+	RewardEvaluator::Result result = rewards.evaluate(observation, 0);
+	EXPECT_FLOAT_EQ(result.reward, -2.0f);
+	EXPECT_FALSE(result.terminated);
+	EXPECT_FALSE(result.truncated);
+}
+
+TEST_F(RewardEvaluatorTest, TestFace)
+{
+	rewards.set_mode(RewardEvaluator::Mode::FACE);
+	observation.yaw_error = -0.75f;
+	EXPECT_FLOAT_EQ(rewards.evaluate(observation, 0).reward, -0.75f);
+}
+
+TEST_F(RewardEvaluatorTest, TestShoot)
+{
+	rewards.set_mode(RewardEvaluator::Mode::SHOOT);
+	EXPECT_FLOAT_EQ(rewards.evaluate(observation, 0).reward, -2.5f);
+	EXPECT_FLOAT_EQ(rewards.evaluate(observation, 4).reward, 5.0f);
+	observation.shot_hit = true;
+	EXPECT_FLOAT_EQ(rewards.evaluate(observation, 0).reward, 10.0f);
+}
+
+TEST_F(RewardEvaluatorTest, TestFinal)
+{
+	rewards.set_mode(RewardEvaluator::Mode::FINAL);
+	EXPECT_FLOAT_EQ(rewards.evaluate(observation, 4).reward, 3.0f);
+}
+
+TEST_F(RewardEvaluatorTest, TestTermination)
+{
+	observation.target_hp = 0.0f;
+	RewardEvaluator::Result result = rewards.evaluate(observation, 0);
+	EXPECT_TRUE(result.terminated);
+	EXPECT_FLOAT_EQ(result.reward, 100.0f);
+
+	observation.agent_hp = 0.0f;
+	EXPECT_FLOAT_EQ(rewards.evaluate(observation, 0).reward, -100.0f);
+}
+
+TEST_F(RewardEvaluatorTest, TestParseMode)
+{
+	EXPECT_EQ(RewardEvaluator::parse_mode("face"),
+		  RewardEvaluator::Mode::FACE);
+	EXPECT_THROW(RewardEvaluator::parse_mode("dance"), std::runtime_error);
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <core/Environment.h>
+
+#include <cstdint>
+#include <vector>
+
+// Runs from the source tree, for config.conf and the assets
+static const char *ARGS[] = { "Environment_test", "--Agent.enemies=2",
+			      "--Agent.action_repeat=4",
+			      "--Sensor.rays=0", "--Engine.worlds=1",
+			      "--Engine.seed=1" };
+
+static std::vector<float> observe(const Environment &env)
+{
+	std::vector<float> out(env.get_agent_count() * env.get_step_size());
+	env.observe(out.data());
+	return out;
+}
+
+// Observation of agent, after the reward and episode flags
+static std::vector<float> agent_observation(const Environment &env,
+					    const std::vector<float> &steps,
+					    size_t agent)
+{
+	auto begin = steps.begin() + agent * env.get_step_size();
+	return { begin + 3, begin + env.get_step_size() };
+}
+
+TEST(EnvironmentTest, TestResetKeepsActionsOfTheSameBatch)
+{
+	Environment env("config.conf", sizeof(ARGS) / sizeof(*ARGS), ARGS);
+	ASSERT_EQ(env.get_agent_count(), 2);
+
+	env.reset();
+	std::vector<float> idle = agent_observation(env, observe(env), 0);
+
+	int32_t both[] = { 3, 3 };
+	env.reset();
+	env.step(both, 2);
+	std::vector<float> moved = agent_observation(env, observe(env), 0);
+	ASSERT_NE(moved, idle);
+
+	// The reset of agent 1 comes after agent 0's action in the batch and
+	// restores their shared world, agent 0 still has to move
+	int32_t mixed[] = { 3, Environment::RESET };
+	env.reset();
+	env.step(mixed, 2);
+	std::vector<float> after = agent_observation(env, observe(env), 0);
+	ASSERT_EQ(after.size(), moved.size());
+	for (size_t i = 0; i < after.size(); i++) {
+		EXPECT_NEAR(after[i], moved[i], 1e-5f) << "feature " << i;
+	}
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <core/JobSystem.h>
+
+#include <atomic>
+#include <cstdint>
+
+class JobSystemTest : public ::testing::Test {
+    protected:
+	JobSystem &jobs = JobSystem::get_instance();
+
+	void SetUp() override
+	{
+		jobs.init(3);
+	}
+
+	void TearDown() override
+	{
+		jobs.shutdown();
+	}
+};
+
+TEST_F(JobSystemTest, TestWaitRunsAllJobs)
+{
+	std::atomic<int32_t> sum = 0;
+	JobSystem::Counter counter;
+	for (int32_t i = 1; i <= 100; i++) {
+		jobs.run([&sum, i] { sum += i; }, &counter);
+	}
+	jobs.wait(counter);
+	EXPECT_TRUE(counter.done());
+	EXPECT_EQ(sum, 5050);
+}
+
+TEST_F(JobSystemTest, TestNestedJobs)
+{
+	std::atomic<int32_t> count = 0;
+	JobSystem::Counter counter;
+	for (int32_t i = 0; i < 16; i++) {
+		jobs.run(
+			[this, &count] {
+				JobSystem::Counter inner;
+				for (int32_t j = 0; j < 8; j++) {
+					jobs.run([&count] { count++; }, &inner);
+				}
+				jobs.wait(inner);
+				count++;
+			},
+			&counter);
+	}
+	jobs.wait(counter);
+	EXPECT_EQ(count, 16 * 9);
+}
+
+TEST_F(JobSystemTest, TestInlineWithoutWorkers)
+{
+	jobs.shutdown();
+	EXPECT_EQ(jobs.get_worker_count(), 0);
+
+	int32_t value = 0;
+	JobSystem::Counter counter;
+	jobs.run([&value] { value = 42; }, &counter);
+	EXPECT_TRUE(counter.done());
+	EXPECT_EQ(value, 42);
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <core/WorldSnapshot.h>
+
+#include <core/Config.h>
+#include <core/JobSystem.h>
+#include <core/RLProtocol.h>
+#include <core/SharedGlobals.h>
+#include <core/World.h>
+
+#include <components/Entity.h>
+
+#include <game/TestGame.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#define TICK (1.0f / 60)
+
+TEST(WorldSnapshotTest, TestReadsBackInOrder)
+{
+	WorldSnapshot snapshot;
+	snapshot.write(uint8_t(7));
+	snapshot.write(1.5f);
+	snapshot.write(true);
+	snapshot.write(int32_t(-3));
+
+	WorldSnapshot::Reader reader(snapshot);
+	EXPECT_EQ(reader.read<uint8_t>(), 7);
+	EXPECT_FLOAT_EQ(reader.read<float>(), 1.5f);
+	EXPECT_TRUE(reader.read<bool>());
+	EXPECT_EQ(reader.read<int32_t>(), -3);
+	EXPECT_TRUE(reader.done());
+}
+
+TEST(WorldSnapshotTest, TestRandomEngineResumes)
+{
+	std::mt19937 rng(42);
+	rng.discard(10);
+
+	WorldSnapshot snapshot;
+	snapshot.write(rng);
+	uint32_t expected = rng();
+
+	std::mt19937 restored;
+	WorldSnapshot::Reader reader(snapshot);
+	reader.read(restored);
+	EXPECT_EQ(restored(), expected);
+}
+
+TEST(WorldSnapshotTest, TestClearKeepsNothing)
+{
+	WorldSnapshot snapshot;
+	snapshot.write(1.0);
+	EXPECT_EQ(snapshot.size(), sizeof(double));
+	snapshot.clear();
+	EXPECT_TRUE(snapshot.empty());
+}
+
+TEST(WorldSnapshotTest, TestReadPastEndThrows)
+{
+	WorldSnapshot snapshot;
+	snapshot.write(uint8_t(1));
+
+	WorldSnapshot::Reader reader(snapshot);
+	EXPECT_THROW(reader.read<int32_t>(), std::runtime_error);
+}
+
+// Worlds of the game the engine runs, headless, built from the source tree
+// for config.conf and the assets
+class WorldRestoreTest : public ::testing::Test {
+    protected:
+	static void SetUpTestSuite()
+	{
+		Config &config = Config::get_instance();
+		config.load("config.conf");
+		config.set("Engine", "headless", "1");
+		config.set("Agent", "enemies", "1");
+		config.set("Agent", "action_repeat", "1");
+		config.set("Sensor", "rays", "0");
+		SharedGlobals::get_instance().headless = true;
+		JobSystem::get_instance().init(2);
+	}
+
+	static void TearDownTestSuite()
+	{
+		JobSystem::get_instance().shutdown();
+	}
+
+	// Every rigid body's pose and velocities, then every entity's hp,
+	// jump cooldown and ground contact
+	static std::vector<float> capture(World &world)
+	{
+		std::vector<float> state;
+		for (const btRigidBody *body : world.rigid_bodies) {
+			const btTransform &transform =
+				body->getWorldTransform();
+			btQuaternion rotation = transform.getRotation();
+			for (int32_t i = 0; i < 3; i++) {
+				state.push_back(transform.getOrigin()[i]);
+				state.push_back(body->getLinearVelocity()[i]);
+				state.push_back(body->getAngularVelocity()[i]);
+			}
+			for (int32_t i = 0; i < 4; i++) {
+				state.push_back(rotation[i]);
+			}
+		}
+		for (const Entity *entity : world.entities) {
+			state.push_back(entity->get_hp());
+			state.push_back(entity->get_jump_cd());
+			state.push_back(entity->on_ground);
+		}
+		return state;
+	}
+
+	// ticks ticks of every agent moving, turning, jumping and shooting by
+	// a fixed script, agent i skew * i actions ahead in it
+	static void play(TestGame &game, int32_t first_tick, int32_t ticks,
+			 int32_t skew = 0)
+	{
+		static const int32_t SCRIPT[] = { 0, 0, 5, 6, 4,
+						  3, 3, 7, 4, 1 };
+		RLProtocol::Command command;
+		command.type = RLProtocol::Command::Type::ACTION;
+		for (int32_t tick = first_tick; tick < first_tick + ticks;
+		     tick++) {
+			for (size_t i = 0; i < game.get_agent_count(); i++) {
+				command.action = SCRIPT[(tick + skew * i) %
+							std::size(SCRIPT)];
+				game.submit(i, command);
+			}
+			game.tick(TICK);
+		}
+	}
+};
+
+TEST_F(WorldRestoreTest, TestReplayIsExact)
+{
+	TestGame game(true);
+	game.create_worlds(1, 7);
+	World &world = game.get_world(0);
+
+	// Mid fall and mid action, not as built
+	play(game, 0, 30);
+	WorldSnapshot snapshot;
+	world.save(snapshot);
+
+	play(game, 30, 120);
+	std::vector<float> first = capture(world);
+
+	world.restore(snapshot);
+	play(game, 30, 120);
+	EXPECT_EQ(capture(world), first);
+}
+
+TEST_F(WorldRestoreTest, TestBranchesFromOneSnapshotMatch)
+{
+	TestGame game(true);
+	game.create_worlds(2, 7);
+
+	// The worlds run apart first
+	play(game, 0, 30, 3);
+	WorldSnapshot snapshot;
+	game.get_world(0).save(snapshot);
+	play(game, 30, 30, 3);
+	ASSERT_NE(capture(game.get_world(0)), capture(game.get_world(1)));
+
+	game.restore_worlds(snapshot);
+	EXPECT_EQ(capture(game.get_world(0)), capture(game.get_world(1)));
+
+	play(game, 60, 120);
+	EXPECT_EQ(capture(game.get_world(0)), capture(game.get_world(1)));
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <misc/SPSCQueue.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+struct Item {
+	int32_t id;
+	float value;
+};
+
+TEST(SPSCQueueTest, TestFifoOrder)
+{
+	SPSCQueue<Item, 8> queue;
+	Item item;
+	EXPECT_TRUE(queue.empty());
+	EXPECT_FALSE(queue.try_pop(item));
+
+	for (int32_t i = 0; i < 5; i++) {
+		EXPECT_TRUE(queue.try_push({ i, i * 0.5f }));
+	}
+	EXPECT_EQ(queue.size(), 5);
+
+	for (int32_t i = 0; i < 5; i++) {
+		ASSERT_TRUE(queue.try_pop(item));
+		EXPECT_EQ(item.id, i);
+		EXPECT_FLOAT_EQ(item.value, i * 0.5f);
+	}
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST(SPSCQueueTest, TestFullQueueRejectsPush)
+{
+	SPSCQueue<int32_t, 4> queue;
+	for (int32_t i = 0; i < 4; i++) {
+		EXPECT_TRUE(queue.try_push(i));
+	}
+	EXPECT_FALSE(queue.try_push(4));
+
+	int32_t item;
+	ASSERT_TRUE(queue.try_pop(item));
+	EXPECT_EQ(item, 0);
+	EXPECT_TRUE(queue.try_push(4));
+
+	// Wraps around the ring
+	for (int32_t i = 1; i <= 4; i++) {
+		ASSERT_TRUE(queue.try_pop(item));
+		EXPECT_EQ(item, i);
+	}
+	EXPECT_FALSE(queue.try_pop(item));
+}
+
+TEST(SPSCQueueTest, TestWaitTimesOut)
+{
+	SPSCQueue<int32_t, 4> queue;
+	int32_t item;
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_FALSE(queue.wait_pop(item, std::chrono::milliseconds(20)));
+	EXPECT_GE(std::chrono::steady_clock::now() - start,
+		  std::chrono::milliseconds(1));
+}
+
+TEST(SPSCQueueTest, TestProducerWakesConsumer)
+{
+	SPSCQueue<int32_t, 4> queue;
+	std::thread producer([&queue] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		queue.try_push(7);
+	});
+
+	int32_t item = 0;
+	auto start = std::chrono::steady_clock::now();
+	bool popped = queue.wait_pop(item, std::chrono::seconds(10));
+	auto waited = std::chrono::steady_clock::now() - start;
+	producer.join();
+
+	EXPECT_TRUE(popped);
+	EXPECT_EQ(item, 7);
+	EXPECT_LT(waited, std::chrono::seconds(5));
+}
+
+TEST(SPSCQueueTest, TestConcurrentTransfer)
+{
+	constexpr int32_t count = 200000;
+	auto queue = std::make_unique<SPSCQueue<Item, 64> >();
+
+	std::thread producer([&queue] {
+		for (int32_t i = 0; i < count; i++) {
+			while (!queue->try_push({ i, static_cast<float>(i) })) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int32_t expected = 0;
+	bool ordered = true;
+	Item item;
+	while (expected < count) {
+		if (!queue->wait_pop(item, std::chrono::milliseconds(100)))
+			continue;
+		ordered &= item.id == expected &&
+			   item.value == static_cast<float>(expected);
+		expected++;
+	}
+	producer.join();
+
+	EXPECT_TRUE(ordered);
+	EXPECT_TRUE(queue->empty());
+}
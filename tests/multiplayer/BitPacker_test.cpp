@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <multiplayer/BitPacker.h>
+
+#include <cstdint>
+
+TEST(BitPackerTest, TestRoundTrip)
+{
+	uint8_t buffer[16];
+	BitWriter writer(buffer, sizeof(buffer));
+	writer.write(5, 3);
+	writer.write_bool(true);
+	writer.write(0xabcd, 16);
+	writer.write(0xdeadbeef, 32);
+	writer.write(1, 7);
+	EXPECT_FALSE(writer.is_overflowed());
+	EXPECT_EQ(writer.get_size(), 8); // 59 bits
+
+	BitReader reader(buffer, writer.get_size());
+	EXPECT_EQ(reader.read(3), 5);
+	EXPECT_TRUE(reader.read_bool());
+	EXPECT_EQ(reader.read(16), 0xabcd);
+	EXPECT_EQ(reader.read(32), 0xdeadbeef);
+	EXPECT_EQ(reader.read(7), 1);
+	EXPECT_FALSE(reader.is_overflowed());
+}
+
+TEST(BitPackerTest, TestValuesAreMasked)
+{
+	uint8_t buffer[4];
+	BitWriter writer(buffer, sizeof(buffer));
+	writer.write(0xff, 4);
+	writer.write(0, 4);
+
+	BitReader reader(buffer, writer.get_size());
+	EXPECT_EQ(reader.read(4), 0xf);
+	EXPECT_EQ(reader.read(4), 0);
+}
+
+TEST(BitPackerTest, TestOverflow)
+{
+	uint8_t buffer[2];
+	BitWriter writer(buffer, sizeof(buffer));
+	writer.write(0x3ff, 10);
+	writer.write(0x7f, 7);
+	EXPECT_TRUE(writer.is_overflowed());
+	EXPECT_EQ(writer.get_size(), 2);
+
+	BitReader reader(buffer, 2);
+	EXPECT_EQ(reader.read(10), 0x3ff);
+	EXPECT_EQ(reader.read(7), 0);
+	EXPECT_TRUE(reader.is_overflowed());
+}
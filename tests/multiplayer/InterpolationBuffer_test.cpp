@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <multiplayer/InterpolationBuffer.h>
+
+#include <cmath>
+
+#define TICK (1.0f / 60)
+
+static InterpolationBuffer::State at_x(float x, float velocity = 0)
+{
+	InterpolationBuffer::State state;
+	state.position = { x, 0, 0 };
+	state.velocity = { velocity, 0, 0 };
+	return state;
+}
+
+static float update_x(InterpolationBuffer &buffer, float delta = TICK)
+{
+	InterpolationBuffer::State state;
+	EXPECT_TRUE(buffer.update(delta, state));
+	return state.position.getX();
+}
+
+TEST(InterpolationBufferTest, TestEmpty)
+{
+	InterpolationBuffer buffer({});
+	InterpolationBuffer::State state;
+	EXPECT_FALSE(buffer.update(TICK, state));
+	EXPECT_EQ(buffer.size(), 0);
+}
+
+TEST(InterpolationBufferTest, TestDelay)
+{
+	InterpolationBuffer::Settings settings;
+	settings.delay = 0.1f;
+	InterpolationBuffer buffer(settings);
+
+	// Sent every 0.1 seconds from 10 on the sender's clock, each arriving
+	// at once
+	buffer.push(10.0, at_x(0));
+	EXPECT_NEAR(update_x(buffer, 0.1f), 0, 1e-3f);
+	buffer.push(10.1, at_x(1));
+	// Shown at 10.05, halfway from the first state to the second
+	EXPECT_NEAR(update_x(buffer, 0.05f), 0.5f, 1e-3f);
+	EXPECT_NEAR(update_x(buffer, 0.05f), 1, 1e-3f);
+	buffer.push(10.2, at_x(2));
+	EXPECT_NEAR(update_x(buffer, 0.05f), 1.5f, 1e-3f);
+}
+
+TEST(InterpolationBufferTest, TestInterpolateOrientation)
+{
+	InterpolationBuffer::Settings settings;
+	settings.delay = 0.2f;
+	InterpolationBuffer buffer(settings);
+	InterpolationBuffer::State a = at_x(0), b = at_x(0);
+	a.orientation = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 0);
+	b.orientation = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 1);
+
+	InterpolationBuffer::State state;
+	buffer.push(0.0, a);
+	ASSERT_TRUE(buffer.update(0.2f, state));
+	buffer.push(0.2, b);
+	ASSERT_TRUE(buffer.update(0.1f, state));
+	Quaternion half = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 0.5f);
+	EXPECT_NEAR(std::fabs(state.orientation.dot(half)), 1.0f, 1e-4f);
+}
+
+TEST(InterpolationBufferTest, TestExtrapolate)
+{
+	InterpolationBuffer::Settings settings;
+	settings.delay = 0;
+	settings.max_extrapolation = 0.25f;
+	InterpolationBuffer buffer(settings);
+
+	buffer.push(0.0, at_x(0, 2));
+	EXPECT_NEAR(update_x(buffer, 0.1f), 0.2f, 1e-4f);
+	// Holds still once max_extrapolation has passed
+	EXPECT_NEAR(update_x(buffer, 0.5f), 0.5f, 1e-4f);
+	EXPECT_NEAR(update_x(buffer, 0.5f), 0.5f, 1e-4f);
+}
+
+TEST(InterpolationBufferTest, TestExtrapolateRotation)
+{
+	InterpolationBuffer::Settings settings;
+	settings.delay = 0;
+	InterpolationBuffer buffer(settings);
+
+	InterpolationBuffer::State spinning = at_x(0);
+	spinning.angular_velocity = { 0, 2, 0 };
+	buffer.push(0.0, spinning);
+
+	InterpolationBuffer::State state;
+	ASSERT_TRUE(buffer.update(0.1f, state));
+	Quaternion turned = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 0.2f);
+	EXPECT_NEAR(std::fabs(state.orientation.dot(turned)), 1.0f, 1e-4f);
+}
+
+TEST(InterpolationBufferTest, TestStale)
+{
+	InterpolationBuffer buffer({});
+	buffer.push(1.0, at_x(0));
+	buffer.push(1.1, at_x(1));
+	buffer.push(1.05, at_x(5));
+	buffer.push(1.1, at_x(5));
+	EXPECT_EQ(buffer.size(), 2);
+}
+
+TEST(InterpolationBufferTest, TestSmoothCorrection)
+{
+	InterpolationBuffer::Settings settings;
+	settings.delay = 0;
+	settings.max_extrapolation = 1;
+	settings.correction_time = 0.1f;
+	InterpolationBuffer buffer(settings);
+
+	// Extrapolated to 0.5 but the entity stopped at 0
+	buffer.push(0.0, at_x(0, 1));
+	float shown = 0;
+	for (int32_t i = 0; i < 30; i++)
+		shown = update_x(buffer);
+	EXPECT_NEAR(shown, 0.5f, 1e-3f);
+	buffer.push(0.5, at_x(0));
+
+	// Eases in instead of jumping, never overshooting
+	float previous = shown;
+	for (int32_t i = 0; i < 6; i++) {
+		float x = update_x(buffer);
+		EXPECT_LT(x, previous);
+		EXPECT_GT(x, 0);
+		previous = x;
+	}
+	EXPECT_GT(0.5f - update_x(buffer), 0.25f);
+	for (int32_t i = 0; i < 60; i++)
+		shown = update_x(buffer);
+	EXPECT_NEAR(shown, 0, 1e-3f);
+}
+
+TEST(InterpolationBufferTest, TestSnap)
+{
+	InterpolationBuffer::Settings settings;
+	settings.delay = 0;
+	settings.max_extrapolation = 1;
+	settings.snap_distance = 3;
+	InterpolationBuffer buffer(settings);
+
+	buffer.push(0.0, at_x(0, 1));
+	update_x(buffer, 0.5f);
+	// Respawned far away
+	buffer.push(0.5, at_x(20));
+	EXPECT_NEAR(update_x(buffer, 0.0f), 20, 1e-4f);
+}
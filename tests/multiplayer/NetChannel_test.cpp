@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <multiplayer/NetChannel.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+struct Packet {
+	std::vector<uint8_t> bytes;
+};
+
+static std::vector<uint8_t> make_action(uint8_t action)
+{
+	Move move = { action, 1, { 0.5f } };
+	std::vector<uint8_t> message(Wire::MAX_MESSAGE_SIZE);
+	message.resize(Wire::encode(move, message.data()));
+	return message;
+}
+
+static Packet write(NetChannel &channel,
+		    const std::vector<uint8_t> &unreliable = {})
+{
+	Packet packet;
+	packet.bytes.resize(NetChannel::MAX_PACKET_SIZE);
+	packet.bytes.resize(channel.write_packet(
+		unreliable.data(), unreliable.size(), packet.bytes.data()));
+	return packet;
+}
+
+// Actions of the moves delivered from packet, -1 when it was dropped
+static std::vector<int32_t> read(NetChannel &channel, const Packet &packet)
+{
+	std::vector<int32_t> actions;
+	bool accepted = channel.read_packet(
+		packet.bytes.data(), packet.bytes.size(),
+		[&](const uint8_t *message, size_t size) {
+			Move move;
+			ASSERT_TRUE(Wire::decode(message, size, move));
+			actions.push_back(move.action);
+		});
+	if (!accepted)
+		actions.push_back(-1);
+	return actions;
+}
+
+TEST(NetChannelTest, TestStalePacketsAreDropped)
+{
+	NetChannel a, b;
+	Packet first = write(a, make_action(1));
+	Packet second = write(a, make_action(2));
+
+	EXPECT_EQ(read(b, second), std::vector<int32_t>{ 2 });
+	EXPECT_EQ(read(b, first), std::vector<int32_t>{ -1 });
+	EXPECT_EQ(read(b, second), std::vector<int32_t>{ -1 });
+}
+
+TEST(NetChannelTest, TestReliableRepeatedUntilAcknowledged)
+{
+	NetChannel a, b;
+	std::vector<uint8_t> shot = make_action(6);
+	shot.resize(Wire::write_header(Wire::MessageType::SHOT, 0,
+				       shot.data()));
+	ASSERT_TRUE(a.send_reliable(shot.data(), shot.size()));
+
+	// Lost, then repeated
+	write(a);
+	Packet repeat = write(a);
+	EXPECT_TRUE(a.has_unacknowledged());
+	EXPECT_EQ(read(b, repeat), std::vector<int32_t>{ 6 });
+
+	// Delivered once, even when the next one repeats it again
+	Packet again = write(a, make_action(3));
+	EXPECT_EQ(read(b, again), std::vector<int32_t>{ 3 });
+
+	// b's next packet acknowledges it
+	read(a, write(b));
+	EXPECT_FALSE(a.has_unacknowledged());
+	EXPECT_EQ(write(a).bytes.size(), NetChannel::HEADER_SIZE);
+}
+
+TEST(NetChannelTest, TestReliableQueueIsBounded)
+{
+	NetChannel channel;
+	std::vector<uint8_t> message = make_action(1);
+	for (int32_t i = 0; i < NetChannel::MAX_RELIABLE; i++) {
+		EXPECT_TRUE(channel.send_reliable(message.data(),
+						  message.size()));
+	}
+	EXPECT_FALSE(channel.send_reliable(message.data(), message.size()));
+}
+
+TEST(NetChannelTest, TestMalformedPacket)
+{
+	NetChannel a, b;
+	Packet packet = write(a, make_action(1));
+	packet.bytes.pop_back();
+	EXPECT_EQ(read(b, packet), std::vector<int32_t>{ -1 });
+
+	Packet header = { { 1, 0, 0 } };
+	EXPECT_EQ(read(b, header), std::vector<int32_t>{ -1 });
+}
+
+// Both ways over a link losing a third of the packets and reordering some
+TEST(NetChannelTest, TestLossyLink)
+{
+	NetChannel a, b;
+	std::mt19937 rng(7);
+	std::bernoulli_distribution lost(0.3), late(0.1);
+	std::vector<std::pair<int32_t, Packet> > delayed; // With its tick
+
+	std::vector<int32_t> delivered;
+	int32_t sent = 0, newest = -1;
+	for (int32_t tick = 0; tick < 2000; tick++) {
+		// An event every few ticks, as actions 0 to 7 in turn
+		std::vector<uint8_t> event = make_action(sent % 8);
+		if (tick % 5 == 0 &&
+		    a.send_reliable(event.data(), event.size())) {
+			sent++;
+		}
+
+		Packet packet = write(a, make_action(tick % 2 ? 9 : 8));
+		auto receive = [&](int32_t sent_tick, const Packet &packet) {
+			std::vector<int32_t> actions = read(b, packet);
+			// Older than what b has seen, dropped whole
+			if (sent_tick < newest) {
+				EXPECT_EQ(actions, std::vector<int32_t>{ -1 });
+				return;
+			}
+			for (int32_t action : actions) {
+				ASSERT_GE(action, 0);
+				if (action < 8)
+					delivered.push_back(action);
+			}
+			newest = sent_tick;
+		};
+		if (late(rng)) {
+			delayed.push_back({ tick, packet });
+		} else if (!lost(rng)) {
+			receive(tick, packet);
+		}
+		if (!delayed.empty() && tick % 7 == 0) {
+			receive(delayed.front().first, delayed.front().second);
+			delayed.erase(delayed.begin());
+		}
+
+		Packet reply = write(b);
+		if (!lost(rng))
+			read(a, reply);
+	}
+
+	ASSERT_GE(newest, 0);
+	ASSERT_GT(sent, 300);
+	// Every event in order, none twice, the last few possibly in flight
+	EXPECT_GE(delivered.size(), sent - 2);
+	for (size_t i = 0; i < delivered.size(); i++) {
+		EXPECT_EQ(delivered[i], static_cast<int32_t>(i % 8));
+	}
+}
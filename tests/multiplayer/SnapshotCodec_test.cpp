@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <multiplayer/SnapshotCodec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+// Walking along x while turning, 60 ticks a second
+static Move make_state(int32_t tick)
+{
+	float t = tick / 60.0f;
+	float angle = 0.5f * t;
+	float values[Move::MAX_VALUES] = {
+		-40.0f + 8.5f * t, 3.0f, 1.25f,
+		0.0f, 0.0f, std::sin(angle / 2), std::cos(angle / 2),
+		8.5f, 0.0f, -0.1f,
+		0.0f, 0.0f, 0.5f
+	};
+	Move move;
+	move.action = Move::SYNC;
+	move.count = Move::MAX_VALUES;
+	move.tick = tick;
+	std::copy(values, values + Move::MAX_VALUES, move.values);
+	return move;
+}
+
+static void expect_near_state(const Move &expected, const Move &actual)
+{
+	EXPECT_EQ(actual.action, Move::SYNC);
+	EXPECT_EQ(actual.count, Move::MAX_VALUES);
+	EXPECT_EQ(actual.tick, expected.tick);
+	for (int32_t i = 0; i < 3; i++) {
+		EXPECT_NEAR(actual.values[i], expected.values[i], 2e-3f);
+		EXPECT_NEAR(actual.values[7 + i], expected.values[7 + i],
+			    1e-2f);
+		EXPECT_NEAR(actual.values[10 + i], expected.values[10 + i],
+			    1e-2f);
+	}
+	// Same rotation, q or -q
+	float dot = 0.0f;
+	for (int32_t i = 3; i < 7; i++) {
+		dot += expected.values[i] * actual.values[i];
+	}
+	EXPECT_NEAR(std::fabs(dot), 1.0f, 1e-5f);
+}
+
+TEST(SnapshotCodecTest, TestFullSnapshotRoundTrip)
+{
+	SnapshotCodec encoder({}), decoder({});
+	Move state = make_state(30), decoded;
+	// Largest component negative, sent as the same rotation
+	state.values[6] = -state.values[6];
+	state.values[5] = -state.values[5];
+
+	uint8_t buffer[SnapshotCodec::MAX_SIZE];
+	size_t size = encoder.encode(state, buffer, sizeof(buffer));
+	ASSERT_GT(size, 0);
+	EXPECT_LE(size, 29);
+
+	uint16_t sequence = 1;
+	ASSERT_TRUE(decoder.decode(buffer, size, decoded, sequence));
+	EXPECT_EQ(sequence, 0);
+	expect_near_state(state, decoded);
+}
+
+TEST(SnapshotCodecTest, TestOnlyFullStates)
+{
+	SnapshotCodec encoder({});
+	uint8_t buffer[SnapshotCodec::MAX_SIZE];
+	Move shot = { 6, 0, {} };
+	EXPECT_EQ(encoder.encode(shot, buffer, sizeof(buffer)), 0);
+
+	Move partial = make_state(0);
+	partial.count = 3;
+	EXPECT_EQ(encoder.encode(partial, buffer, sizeof(buffer)), 0);
+}
+
+TEST(SnapshotCodecTest, TestDeltaAgainstAcknowledged)
+{
+	SnapshotCodec encoder({}), decoder({});
+	Move decoded;
+	uint8_t buffer[SnapshotCodec::MAX_SIZE];
+	uint16_t sequence;
+	size_t total = 0;
+
+	for (int32_t tick = 0; tick < 600; tick++) {
+		Move state = make_state(tick);
+		size_t size = encoder.encode(state, buffer, sizeof(buffer));
+		ASSERT_GT(size, 0);
+		ASSERT_TRUE(decoder.decode(buffer, size, decoded, sequence));
+		expect_near_state(state, decoded);
+		total += size;
+		// Acks arrive a few ticks late
+		if (tick >= 4)
+			encoder.acknowledge(sequence - 4);
+	}
+
+	// Against 56 bytes of raw tick and floats
+	EXPECT_LT(total / 600.0, 56.0 / 4);
+}
+
+TEST(SnapshotCodecTest, TestStillEntityIsTiny)
+{
+	SnapshotCodec encoder({}), decoder({});
+	Move state = make_state(0), decoded;
+	uint8_t buffer[SnapshotCodec::MAX_SIZE];
+	uint16_t sequence;
+
+	size_t size = encoder.encode(state, buffer, sizeof(buffer));
+	ASSERT_TRUE(decoder.decode(buffer, size, decoded, sequence));
+	encoder.acknowledge(sequence);
+
+	state.tick++;
+	size = encoder.encode(state, buffer, sizeof(buffer));
+	EXPECT_EQ(size, 5);
+	ASSERT_TRUE(decoder.decode(buffer, size, decoded, sequence));
+	expect_near_state(state, decoded);
+
+	// Ticks skipped, as between rate limited syncs
+	state.tick += 16;
+	size = encoder.encode(state, buffer, sizeof(buffer));
+	EXPECT_EQ(size, 5);
+	ASSERT_TRUE(decoder.decode(buffer, size, decoded, sequence));
+	expect_near_state(state, decoded);
+
+	// Too far after the baseline, the tick is sent in full
+	state.tick += 5000;
+	size = encoder.encode(state, buffer, sizeof(buffer));
+	EXPECT_EQ(size, 8);
+	ASSERT_TRUE(decoder.decode(buffer, size, decoded, sequence));
+	expect_near_state(state, decoded);
+}
+
+TEST(SnapshotCodecTest, TestUnknownBaselineIsRejected)
+{
+	SnapshotCodec encoder({}), decoder({});
+	Move decoded;
+	uint8_t buffer[SnapshotCodec::MAX_SIZE];
+	uint16_t sequence;
+
+	// The receiver never gets the acknowledged snapshot
+	encoder.encode(make_state(0), buffer, sizeof(buffer));
+	encoder.acknowledge(0);
+	size_t size = encoder.encode(make_state(1), buffer, sizeof(buffer));
+	EXPECT_FALSE(decoder.decode(buffer, size, decoded, sequence));
+
+	// Truncated
+	EXPECT_FALSE(decoder.decode(buffer, 2, decoded, sequence));
+}
+
+TEST(SnapshotCodecTest, TestSequenceWrapsAround)
+{
+	SnapshotCodec encoder({}), decoder({});
+	Move state, decoded;
+	uint8_t buffer[SnapshotCodec::MAX_SIZE];
+	uint16_t sequence;
+
+	for (int32_t tick = 0; tick < 70000; tick++) {
+		state = make_state(tick % 600);
+		state.tick = tick;
+		size_t size = encoder.encode(state, buffer, sizeof(buffer));
+		ASSERT_TRUE(decoder.decode(buffer, size, decoded, sequence));
+		encoder.acknowledge(sequence);
+	}
+	expect_near_state(state, decoded);
+}
+
+TEST(SnapshotCodecTest, TestInvalidSettings)
+{
+	SnapshotCodec::Settings settings;
+	settings.position_bits = 20;
+	EXPECT_THROW(SnapshotCodec codec(settings), std::runtime_error);
+}
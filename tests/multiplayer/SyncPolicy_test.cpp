@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <multiplayer/SyncPolicy.h>
+
+#define TICK (1.0f / 60)
+
+using Trigger = SyncPolicy::Trigger;
+
+static InterpolationBuffer::State moving(float x, float velocity)
+{
+	InterpolationBuffer::State state;
+	state.position = { x, 0, 0 };
+	state.velocity = { velocity, 0, 0 };
+	return state;
+}
+
+TEST(SyncPolicyTest, TestInterval)
+{
+	SyncPolicy::Settings settings;
+	settings.interval = 16;
+	SyncPolicy policy(settings);
+
+	// Standing still, only the interval sends
+	InterpolationBuffer::State still;
+	for (int32_t tick = 0; tick < 64; tick++) {
+		Trigger expected =
+			tick % 16 ? Trigger::NONE : Trigger::INTERVAL;
+		EXPECT_EQ(policy.update(TICK, still), expected);
+	}
+	EXPECT_EQ(policy.get_counters().interval, 4);
+	EXPECT_EQ(policy.get_counters().skipped, 60);
+}
+
+TEST(SyncPolicyTest, TestPredictedMotionIsSkipped)
+{
+	SyncPolicy policy({});
+
+	// Constant velocity is exactly what the receiver extrapolates
+	float x = 0;
+	EXPECT_EQ(policy.update(TICK, moving(x, 5)), Trigger::INTERVAL);
+	for (int32_t tick = 1; tick < 15; tick++) {
+		x += 5 * TICK;
+		EXPECT_EQ(policy.update(TICK, moving(x, 5)), Trigger::NONE);
+	}
+}
+
+TEST(SyncPolicyTest, TestPosition)
+{
+	SyncPolicy::Settings settings;
+	settings.position_threshold = 0.1f;
+	SyncPolicy policy(settings);
+
+	// Sent standing, then walks off
+	EXPECT_EQ(policy.update(TICK, moving(0, 0)), Trigger::INTERVAL);
+	EXPECT_EQ(policy.update(TICK, moving(0.05f, 3)), Trigger::NONE);
+	EXPECT_EQ(policy.update(TICK, moving(0.15f, 3)), Trigger::POSITION);
+	// Predicted from the new state on
+	EXPECT_EQ(policy.update(TICK, moving(0.2f, 3)), Trigger::NONE);
+	EXPECT_EQ(policy.get_counters().position, 1);
+}
+
+TEST(SyncPolicyTest, TestOrientation)
+{
+	SyncPolicy::Settings settings;
+	settings.orientation_threshold = 0.05f;
+	SyncPolicy policy(settings);
+
+	InterpolationBuffer::State state;
+	EXPECT_EQ(policy.update(TICK, state), Trigger::INTERVAL);
+	state.orientation = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 0.03f);
+	EXPECT_EQ(policy.update(TICK, state), Trigger::NONE);
+	state.orientation = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 0.1f);
+	EXPECT_EQ(policy.update(TICK, state), Trigger::ORIENTATION);
+
+	// A spin that is sent along is predicted
+	state.angular_velocity = { 0, 6, 0 };
+	EXPECT_EQ(policy.update(TICK, state), Trigger::NONE);
+	state.orientation = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 0.2f);
+	EXPECT_EQ(policy.update(TICK, state), Trigger::ORIENTATION);
+	state.orientation = Quaternion::Rotation_Quaternion({ 0, 1, 0 }, 0.3f);
+	EXPECT_EQ(policy.update(TICK, state), Trigger::NONE);
+}
+
+TEST(SyncPolicyTest, TestExtrapolationCap)
+{
+	SyncPolicy::Settings settings;
+	settings.interval = 1000;
+	settings.max_extrapolation = 0.25f;
+	SyncPolicy policy(settings);
+
+	// The receiver stops extrapolating after 0.25 seconds, so steady
+	// motion is sent again around then
+	float x = 0;
+	EXPECT_EQ(policy.update(TICK, moving(x, 2)), Trigger::INTERVAL);
+	int32_t tick = 1;
+	for (;; tick++) {
+		x += 2 * TICK;
+		if (policy.update(TICK, moving(x, 2)) != Trigger::NONE)
+			break;
+	}
+	// 0.25 seconds, then 0.1 units off
+	EXPECT_NEAR(tick, 18, 1);
+}
+
+TEST(SyncPolicyTest, TestCounters)
+{
+	SyncPolicy policy({});
+	policy.update(TICK, {});
+	policy.update(TICK, {});
+	policy.count_action();
+
+	SyncPolicy::Counters counters = policy.get_counters();
+	EXPECT_EQ(counters.interval, 1);
+	EXPECT_EQ(counters.skipped, 1);
+	EXPECT_EQ(counters.action, 1);
+
+	policy.reset_counters();
+	counters = policy.get_counters();
+	EXPECT_EQ(counters.interval + counters.position +
+			  counters.orientation + counters.action +
+			  counters.skipped,
+		  0);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <multiplayer/Wire.h>
+
+#include <cstdint>
+#include <vector>
+
+static Move make_state()
+{
+	Move move;
+	move.action = Move::SYNC;
+	move.count = Move::MAX_VALUES;
+	move.tick = 0x01020304;
+	for (int32_t i = 0; i < Move::MAX_VALUES; i++) {
+		move.values[i] = 0.1f * i - 0.333333f;
+	}
+	return move;
+}
+
+TEST(WireTest, TestStateRoundTripIsExact)
+{
+	Move move = make_state();
+	uint8_t buffer[Wire::MAX_MESSAGE_SIZE];
+	size_t size = Wire::encode(move, buffer);
+	EXPECT_EQ(size, Wire::MAX_MESSAGE_SIZE);
+	EXPECT_EQ(buffer[0] | (buffer[1] << 8), size - Wire::LENGTH_SIZE);
+	EXPECT_EQ(buffer[2], static_cast<uint8_t>(Wire::MessageType::STATE));
+
+	Move decoded;
+	ASSERT_TRUE(Wire::decode(buffer, size, decoded));
+	EXPECT_EQ(decoded.action, Move::SYNC);
+	EXPECT_EQ(decoded.count, Move::MAX_VALUES);
+	EXPECT_EQ(decoded.tick, move.tick);
+	for (int32_t i = 0; i < Move::MAX_VALUES; i++) {
+		EXPECT_EQ(decoded.values[i], move.values[i]);
+	}
+}
+
+TEST(WireTest, TestActionAndShot)
+{
+	uint8_t buffer[Wire::MAX_MESSAGE_SIZE];
+	Move decoded;
+
+	Move jump = { 7, 1, { 0.25f } };
+	size_t size = Wire::encode(jump, buffer);
+	EXPECT_EQ(size, Wire::HEADER_SIZE + 5);
+	ASSERT_TRUE(Wire::decode(buffer, size, decoded));
+	EXPECT_EQ(decoded.action, 7);
+	EXPECT_EQ(decoded.values[0], 0.25f);
+
+	Move shot = { 6, 1, { 0.016f } };
+	size = Wire::encode(shot, buffer);
+	EXPECT_EQ(size, Wire::HEADER_SIZE);
+	ASSERT_TRUE(Wire::decode(buffer, size, decoded));
+	EXPECT_EQ(decoded.action, 6);
+}
+
+TEST(WireTest, TestMovesWithoutMessage)
+{
+	uint8_t buffer[Wire::MAX_MESSAGE_SIZE];
+	EXPECT_EQ(Wire::encode(Move(), buffer), 0);
+	EXPECT_EQ(Wire::encode({ 8, 1, { 1.0f } }, buffer), 0);
+
+	Move partial_state = make_state();
+	partial_state.count = 3;
+	EXPECT_EQ(Wire::encode(partial_state, buffer), 0);
+}
+
+TEST(WireTest, TestReaderSplitsStream)
+{
+	std::vector<uint8_t> stream;
+	uint8_t buffer[Wire::MAX_MESSAGE_SIZE];
+	Move moves[] = { make_state(), { 6, 0, {} }, { 1, 1, { 0.5f } } };
+	for (const Move &move : moves) {
+		size_t size = Wire::encode(move, buffer);
+		stream.insert(stream.end(), buffer, buffer + size);
+	}
+	// A type from a newer client, skipped by its length
+	stream.insert(stream.end(), { 3, 0, 99, 1, 2 });
+	stream.insert(stream.begin() + Wire::MAX_MESSAGE_SIZE,
+		      { 3, 0, 99, 1, 2 });
+
+	// Fed one byte at a time, as the worst a socket can cut it up
+	std::vector<Move> received;
+	Wire::Reader reader;
+	for (uint8_t byte : stream) {
+		ASSERT_TRUE(reader.feed(
+			&byte, 1, [&](const uint8_t *message, size_t size) {
+				Move move;
+				if (Wire::decode(message, size, move))
+					received.push_back(move);
+			}));
+	}
+
+	ASSERT_EQ(received.size(), 3);
+	EXPECT_EQ(received[0].action, Move::SYNC);
+	EXPECT_EQ(received[0].values[12], moves[0].values[12]);
+	EXPECT_EQ(received[1].action, 6);
+	EXPECT_EQ(received[2].action, 1);
+	EXPECT_EQ(received[2].values[0], 0.5f);
+}
+
+TEST(WireTest, TestReaderRejectsOversizedMessage)
+{
+	uint8_t stream[] = { 0xff, 0x00, 2 };
+	Wire::Reader reader;
+	int32_t count = 0;
+	EXPECT_FALSE(reader.feed(stream, sizeof(stream),
+				 [&](const uint8_t *, size_t) { count++; }));
+	EXPECT_EQ(count, 0);
+}
+
+TEST(WireTest, TestAck)
+{
+	uint8_t buffer[Wire::MAX_MESSAGE_SIZE];
+	size_t size = Wire::encode_ack(0xbeef, buffer);
+	EXPECT_EQ(size, Wire::HEADER_SIZE + 2);
+	EXPECT_EQ(Wire::get_type(buffer), Wire::MessageType::ACK);
+
+	uint16_t sequence = 0;
+	ASSERT_TRUE(Wire::decode_ack(buffer, size, sequence));
+	EXPECT_EQ(sequence, 0xbeef);
+
+	Move move;
+	EXPECT_FALSE(Wire::decode(buffer, size, move));
+}
+
+TEST(WireTest, TestTransport)
+{
+	uint8_t buffer[Wire::MAX_MESSAGE_SIZE];
+	for (bool datagrams : { false, true }) {
+		size_t size = Wire::encode_transport(datagrams, buffer);
+		EXPECT_EQ(size, Wire::HEADER_SIZE + 1);
+		EXPECT_EQ(Wire::get_type(buffer),
+			  Wire::MessageType::TRANSPORT);
+
+		bool decoded = !datagrams;
+		ASSERT_TRUE(Wire::decode_transport(buffer, size, decoded));
+		EXPECT_EQ(decoded, datagrams);
+	}
+
+	// Neither a move nor an answer the relay could have meant
+	Move move;
+	EXPECT_FALSE(Wire::decode(buffer, Wire::HEADER_SIZE + 1, move));
+	buffer[Wire::HEADER_SIZE] = 2;
+	bool decoded;
+	EXPECT_FALSE(Wire::decode_transport(buffer, Wire::HEADER_SIZE + 1,
+					    decoded));
+}